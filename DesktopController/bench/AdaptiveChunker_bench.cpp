@@ -0,0 +1,90 @@
+#include "Benchmark.h"
+#include "AdaptiveChunker.h"
+
+#include <cmath>
+
+using namespace std;
+using namespace DcUtil;
+
+namespace
+{
+    // Moving n icons costs 500 us + 5 us * n + 20 ns * n^2, so the cost per icon is lowest at
+    // n = sqrt(500 us / 20 ns) = 158 and a chunk of 1024 takes about 26 ms.
+    ShellCallLatency nonlinearMoveCost()
+    {
+        ShellCallLatency cost;
+        cost.fixed = chrono::microseconds(500);
+        cost.perItem = chrono::microseconds(5);
+        cost.perItemSquared = chrono::nanoseconds(20);
+        return cost;
+    }
+
+    // Modelled cost of moving n icons, as simulated by MemoryShellBackend.
+    chrono::steady_clock::duration modelledCost(const ShellCallLatency& cost, size_t n)
+    {
+        const long long items = static_cast<long long>(n);
+        return cost.fixed + cost.perItem * items + cost.perItemSquared * (items * items);
+    }
+}
+
+// Chunk sizes chosen by AdaptiveChunker on the modelled cost alone, without doing any work, showing how
+// quickly it settles near the cheapest size.
+BENCHMARK(chunkSizeConvergence)
+{
+    const ShellCallLatency cost = nonlinearMoveCost();
+    ChunkingOptions options;
+    AdaptiveChunker chunker(options);
+
+    fmt::print("{:>6} {:>12} {:>14}\n", "chunk", "size", "cost per icon");
+    for (int chunk = 1; chunk <= 16; ++chunk)
+    {
+        size_t size = chunker.chunkSize();
+        auto elapsed = modelledCost(cost, size);
+        fmt::print("{:>6} {:>12} {:>14}\n", chunk, size, formatDuration(chrono::duration_cast<chrono::nanoseconds>(elapsed) / size));
+        chunker.record(size, elapsed);
+    }
+}
+
+// Moving 5000 icons with repositionIconsChunked() on a simulated desktop where the cost of a batch grows with
+// the square of its size, adaptively and with fixed chunk sizes.
+BENCHMARK(chunkedRepositionNonlinearCost)
+{
+    const size_t icons = 5000;
+    auto backend = makeDesktop(icons);
+    backend->setLatency(ShellCall::SelectAndPositionItems, nonlinearMoveCost());
+    DesktopController dc(backend);
+
+    auto all = dc.allIcons();
+    vector<DesktopIcon*> pointers;
+    vector<Vec2<int>> points;
+    for (size_t i = 0; i < all.size(); ++i)
+    {
+        pointers.push_back(all[i].get());
+        points.push_back(Vec2<int>(static_cast<int>(i % 100) * 10, static_cast<int>(i / 100) * 10));
+    }
+
+    fmt::print("{} icons\n", icons);
+    fmt::print("{:>10} {:>8} {:>12} {:>14}\n", "chunking", "chunks", "total", "longest stall");
+
+    auto report = [](const string& name, const ChunkedRepositionReport& result) {
+        fmt::print("{:>10} {:>8} {:>12} {:>14}\n",
+            name,
+            result.chunks.size(),
+            formatDuration(chrono::duration_cast<chrono::nanoseconds>(result.total)),
+            formatDuration(chrono::duration_cast<chrono::nanoseconds>(result.longestStall)));
+    };
+
+    // Each adaptive run after the first starts from the size the previous one settled on.
+    for (int run = 0; run < 3; ++run)
+        report("adaptive", dc.repositionIconsChunked(pointers, points));
+
+    // Fixed sizes are run last since they'd change the size the adaptive runs start from.
+    for (size_t size : { 8, 32, 128, 512, 1024 })
+    {
+        ChunkingOptions fixed;
+        fixed.initialChunkSize = size;
+        fixed.minChunkSize = size;
+        fixed.maxChunkSize = size;
+        report(to_string(size), dc.repositionIconsChunked(pointers, points, fixed));
+    }
+}
@@ -0,0 +1,200 @@
+#include "Benchmark.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <atomic>
+#include <new>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace DcUtil;
+
+namespace
+{
+    atomic<uint64_t> heapAllocations(0);
+
+    struct RegisteredBenchmark
+    {
+        const char* name;
+        BenchmarkFunction function;
+    };
+
+    // Constructed on first use since registrations are static objects in other translation units.
+    vector<RegisteredBenchmark>& registeredBenchmarks()
+    {
+        static vector<RegisteredBenchmark> benchmarks;
+        return benchmarks;
+    }
+}
+
+void* operator new(size_t size)
+{
+    ++heapAllocations;
+    if (void* p = malloc(size ? size : 1))
+        return p;
+    throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+uint64_t heapAllocationCount()
+{
+    return heapAllocations;
+}
+
+BenchmarkRegistration::BenchmarkRegistration(const char* name, BenchmarkFunction function)
+{
+    registeredBenchmarks().push_back({ name, function });
+}
+
+wstring iconName(size_t index)
+{
+    return L"Icon " + to_wstring(index + 1) + L".txt";
+}
+
+shared_ptr<MemoryShellBackend> makeDesktop(size_t icons)
+{
+    auto backend = make_shared<MemoryShellBackend>();
+
+    Vec2<int> spacing;
+    backend->spacing(spacing);
+    const int rows = max(1, backend->desktopResolution().y / spacing.y);
+
+    for (size_t i = 0; i < icons; ++i)
+    {
+        int column = static_cast<int>(i / rows);
+        int row = static_cast<int>(i % rows);
+        backend->addItem(iconName(i), Vec2<int>(column * spacing.x, row * spacing.y));
+    }
+
+    return backend;
+}
+
+void setTypicalLatency(MemoryShellBackend& backend)
+{
+    using chrono::nanoseconds;
+
+    ShellCallLatency items;
+    items.fixed = nanoseconds(20000);
+    backend.setLatency(ShellCall::Items, items);
+
+    ShellCallLatency next;
+    next.fixed = nanoseconds(2000);
+    next.perItem = nanoseconds(100);
+    backend.setLatency(ShellCall::Next, next);
+
+    ShellCallLatency position;
+    position.fixed = nanoseconds(1000);
+    backend.setLatency(ShellCall::GetItemPosition, position);
+
+    ShellCallLatency name;
+    name.fixed = nanoseconds(2000);
+    backend.setLatency(ShellCall::GetDisplayNameOf, name);
+
+    ShellCallLatency move;
+    move.fixed = nanoseconds(50000);
+    move.perItem = nanoseconds(5000);
+    backend.setLatency(ShellCall::SelectAndPositionItems, move);
+}
+
+chrono::nanoseconds timePerCall(const function<void()>& f, chrono::milliseconds minTime)
+{
+    size_t calls = 0;
+    auto start = chrono::steady_clock::now();
+    auto elapsed = chrono::steady_clock::duration::zero();
+
+    do
+    {
+        f();
+        ++calls;
+        elapsed = chrono::steady_clock::now() - start;
+    } while (elapsed < minTime);
+
+    return chrono::duration_cast<chrono::nanoseconds>(elapsed) / calls;
+}
+
+wstring tempFilePath(const wstring& name)
+{
+#ifdef _WIN32
+    wchar_t tempPath[MAX_PATH + 1];
+    if (GetTempPathW(MAX_PATH + 1, tempPath) == 0)
+        throw runtime_error("GetTempPathW failed");
+    return wstring(tempPath) + name;
+#else
+    // Widened byte by byte, so TMPDIR is assumed to be ASCII.
+    const char* tempDir = getenv("TMPDIR");
+    const string tempPath = string(tempDir && *tempDir ? tempDir : "/tmp") + "/";
+    return wstring(tempPath.begin(), tempPath.end()) + name;
+#endif
+}
+
+void removeFile(const wstring& path)
+{
+#ifdef _WIN32
+    DeleteFileW(path.c_str());
+#else
+    unlink(wstringToUtf8(path).c_str());
+#endif
+}
+
+string formatDuration(chrono::nanoseconds duration)
+{
+    double ns = static_cast<double>(duration.count());
+    if (ns < 1e3)
+        return fmt::format("{:.0f} ns", ns);
+    if (ns < 1e6)
+        return fmt::format("{:.1f} us", ns / 1e3);
+    if (ns < 1e9)
+        return fmt::format("{:.2f} ms", ns / 1e6);
+    return fmt::format("{:.2f} s", ns / 1e9);
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        size_t run = 0;
+        for (auto& benchmark : registeredBenchmarks())
+        {
+            bool selected = (argc < 2);
+            for (int i = 1; i < argc && !selected; ++i)
+                selected = (strcmp(argv[i], benchmark.name) == 0);
+
+            if (!selected)
+                continue;
+
+            fmt::print("{}\n", benchmark.name);
+            benchmark.function();
+            fmt::print("\n");
+            ++run;
+        }
+
+        if (run == 0)
+        {
+            fmt::print("No benchmark matches. Available benchmarks:\n");
+            for (auto& benchmark : registeredBenchmarks())
+                fmt::print("\t{}\n", benchmark.name);
+            return 1;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        fmt::print("{}\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "DesktopController.h"
+#include "MemoryShellBackend.h"
+
+#include <fmt/core.h>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <functional>
+
+// Benchmarks of DesktopController and its helpers, run against a MemoryShellBackend so they don't
+// need Explorer and give repeatable results. Each benchmark sits in a file named after the code it
+// measures and registers itself with BENCHMARK(name). Run Benchmarks (Benchmarks.exe on Windows) to 
+// run all of them, or pass the names of the ones to run.
+
+using BenchmarkFunction = void(*)();
+
+// Adds a benchmark to the list run by main().
+struct BenchmarkRegistration
+{
+    BenchmarkRegistration(const char* name, BenchmarkFunction function);
+};
+
+#define BENCHMARK(name) \
+    static void name(); \
+    static BenchmarkRegistration name##Registration(#name, name); \
+    static void name()
+
+// Returns a simulated desktop with the given number of icons named "Icon 1.txt", "Icon 2.txt" and so on,
+// laid out in columns from the top left as Explorer does. The icons' IDs in the backend are 1 to icons,
+// in the same order. No latency is set.
+std::shared_ptr<MemoryShellBackend> makeDesktop(size_t icons);
+
+// Gives every type of call on backend a latency in proportion to a real desktop's, scaled down so the
+// benchmarks finish quickly: moving icons is the most expensive by far, then enumeration and names.
+void setTypicalLatency(MemoryShellBackend& backend);
+
+// Display name of the nth icon made by makeDesktop(), counting from 0.
+std::wstring iconName(size_t index);
+
+// Calls f repeatedly for at least minTime (and at least once) and returns the mean time per call.
+std::chrono::nanoseconds timePerCall(
+    const std::function<void()>& f,
+    std::chrono::milliseconds minTime = std::chrono::milliseconds(200));
+
+// Number of times operator new has been called by this process. Benchmark.cpp replaces the global
+// operator new and delete to count them.
+uint64_t heapAllocationCount();
+
+// Full path of a file called name in the temporary directory.
+std::wstring tempFilePath(const std::wstring& name);
+
+// Deletes a file, ignoring errors.
+void removeFile(const std::wstring& path);
+
+// Formats a duration with a unit suited to its size, e.g. "12.3 us".
+std::string formatDuration(std::chrono::nanoseconds duration);
@@ -0,0 +1,313 @@
+#include "Benchmark.h"
+
+using namespace std;
+using namespace DcUtil;
+
+// Time taken to enumerate every icon with enumerateIconsBatched() at increasing batch sizes, and the
+// number of IEnumIDList::Next calls it makes. Next has a fixed cost per call plus a small cost per item.
+BENCHMARK(enumerateIconsBatchSize)
+{
+    const size_t icons = 500;
+    auto backend = makeDesktop(icons);
+    setTypicalLatency(*backend);
+    DesktopController dc(backend);
+
+    fmt::print("{} icons\n", icons);
+    fmt::print("{:>10} {:>12} {:>12}\n", "batch size", "Next calls", "time");
+
+    for (unsigned int batchSize = 1; batchSize <= 256; batchSize *= 2)
+    {
+        size_t enumerated = 0;
+        backend->resetCallCounts();
+        auto time = timePerCall([&]() {
+            dc.enumerateIconsBatched(batchSize, [&](const vector<const DesktopIcon*>& batch) {
+                enumerated += batch.size();
+            });
+        });
+
+        if (enumerated % icons != 0)
+            throw runtime_error("enumerateIconsBatched returned the wrong number of icons");
+
+        uint64_t callsPerRun = backend->callCount(ShellCall::Next) * icons / enumerated;
+        fmt::print("{:>10} {:>12} {:>12}\n", batchSize, callsPerRun, formatDuration(time));
+    }
+}
+
+// Latency of iconByName() for an icon in the middle of the desktop, a name which isn't on the desktop and
+// the first lookup after the name index is discarded, which builds it.
+BENCHMARK(iconByNameLookup)
+{
+    fmt::print("{:>8} {:>12} {:>12} {:>12}\n", "icons", "build", "hit", "miss");
+
+    for (size_t icons : { 10, 1000, 100000 })
+    {
+        auto backend = makeDesktop(icons);
+        setTypicalLatency(*backend);
+        DesktopController dc(backend);
+
+        const wstring present = iconName(icons / 2);
+        const wstring absent = L"Not on the desktop.txt";
+
+        auto start = chrono::steady_clock::now();
+        if (!dc.iconByName(present))
+            throw runtime_error("iconByName didn't find an icon on the desktop");
+        auto build = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+
+        auto hit = timePerCall([&]() { dc.iconByName(present); });
+
+        // The first miss rebuilds the index, later ones are answered from the index.
+        dc.iconByName(absent);
+        auto miss = timePerCall([&]() { dc.iconByName(absent); });
+
+        fmt::print("{:>8} {:>12} {:>12} {:>12}\n",
+            icons, formatDuration(build), formatDuration(hit), formatDuration(miss));
+    }
+}
+
+// Reading every icon's position: a loop over DesktopIcon::position() into a new vector, against
+// positionsOf() with reused output vectors, for DesktopIcons and for a snapshot. Run without latency to
+// show the library's own overhead, then with GetItemPosition's typical latency.
+BENCHMARK(positionReadback)
+{
+    const size_t icons = 1000;
+
+    for (bool latency : { false, true })
+    {
+        auto backend = makeDesktop(icons);
+        if (latency)
+            setTypicalLatency(*backend);
+        DesktopController dc(backend);
+
+        auto all = dc.allIcons();
+        vector<DesktopIcon*> pointers;
+        for (auto& icon : all)
+            pointers.push_back(icon.get());
+        DesktopSnapshot snapshot = dc.snapshot();
+
+        vector<Vec2<int>> positions;
+        vector<ShellStatus> status;
+
+        auto perIcon = timePerCall([&]() {
+            vector<Vec2<int>> out;
+            for (auto icon : pointers)
+                out.push_back(icon->position());
+        });
+        auto bulk = timePerCall([&]() { dc.positionsOf(pointers, positions, status); });
+        auto fromSnapshot = timePerCall([&]() { dc.positionsOf(snapshot, positions, status); });
+
+        fmt::print("{} icons, {}\n", icons, latency ? "typical latency" : "no latency");
+        fmt::print("{:>22} {:>12}\n", "position() loop", formatDuration(perIcon));
+        fmt::print("{:>22} {:>12}\n", "positionsOf(icons)", formatDuration(bulk));
+        fmt::print("{:>22} {:>12}\n", "positionsOf(snapshot)", formatDuration(fromSnapshot));
+    }
+}
+
+// Building every icon with allIcons() (one heap allocated DesktopIcon each) and allIconsValue() (DesktopIcons
+// stored contiguously), then iterating over the collection reading each icon's item ID size.
+BENCHMARK(allIconsValueVersusPointers)
+{
+    const size_t icons = 1000;
+    auto backend = makeDesktop(icons);
+    DesktopController dc(backend);
+
+    vector<unique_ptr<DesktopIcon>> pointers = dc.allIcons();
+    vector<DesktopIcon> values = dc.allIconsValue();
+
+    size_t total = 0;
+    auto buildPointers = timePerCall([&]() { dc.allIcons(); });
+    auto buildValues = timePerCall([&]() { dc.allIconsValue(); });
+    auto iteratePointers = timePerCall([&]() {
+        for (auto& icon : pointers)
+            total += icon->getItemID().size();
+    });
+    auto iterateValues = timePerCall([&]() {
+        for (auto& icon : values)
+            total += icon.getItemID().size();
+    });
+
+    fmt::print("{} icons\n", icons);
+    fmt::print("{:>16} {:>12} {:>12}\n", "", "build", "iterate");
+    fmt::print("{:>16} {:>12} {:>12}\n", "allIcons", formatDuration(buildPointers), formatDuration(iteratePointers));
+    fmt::print("{:>16} {:>12} {:>12}\n", "allIconsValue", formatDuration(buildValues), formatDuration(iterateValues));
+
+    if (total == 0)
+        throw runtime_error("Icons have no item IDs");
+}
+
+// Queries for a handful of icons on a 10k icon desktop: filtering in the callback of enumerateIcons(),
+// against enumerateIconsWhere() with an extension filter, selected icons only, and a callback which
+// stops at the first match.
+BENCHMARK(enumerateIconsWhereQueries)
+{
+    const size_t icons = 10000;
+    const size_t matches = 10;
+    auto backend = makeDesktop(icons);
+    setTypicalLatency(*backend);
+
+    // Turn a few icons spread evenly across the desktop in to selected shortcuts.
+    for (size_t i = 0; i < matches; ++i)
+    {
+        uint32_t id = static_cast<uint32_t>(1 + (2 * i + 1) * icons / (2 * matches));
+        backend->renameItem(id, L"Shortcut " + to_wstring(i) + L".lnk");
+        backend->selectItem(id, true);
+    }
+
+    DesktopController dc(backend);
+
+    size_t found = 0;
+    auto callbackFilter = timePerCall([&]() {
+        found = 0;
+        dc.enumerateIcons([&](const DesktopIcon* icon) {
+            const wstring name = icon->displayName();
+            if (name.size() >= 4 && name.compare(name.size() - 4, 4, L".lnk") == 0)
+                ++found;
+        });
+    });
+    if (found != matches)
+        throw runtime_error("enumerateIcons found the wrong number of shortcuts");
+
+    EnumerationOptions byExtension;
+    byExtension.extension = L".lnk";
+    auto extensionFilter = timePerCall([&]() {
+        found = dc.enumerateIconsWhere(byExtension, [](const DesktopIcon*) { return true; });
+    });
+    if (found != matches)
+        throw runtime_error("enumerateIconsWhere found the wrong number of shortcuts");
+
+    EnumerationOptions selected;
+    selected.selectedOnly = true;
+    auto selectedOnly = timePerCall([&]() {
+        found = dc.enumerateIconsWhere(selected, [](const DesktopIcon*) { return true; });
+    });
+    if (found != matches)
+        throw runtime_error("enumerateIconsWhere found the wrong number of selected icons");
+
+    auto firstMatch = timePerCall([&]() {
+        dc.enumerateIconsWhere(byExtension, [](const DesktopIcon*) { return false; });
+    });
+
+    fmt::print("{} icons, {} shortcuts\n", icons, matches);
+    fmt::print("{:>30} {:>12}\n", "enumerateIcons, name check", formatDuration(callbackFilter));
+    fmt::print("{:>30} {:>12}\n", "extension filter", formatDuration(extensionFilter));
+    fmt::print("{:>30} {:>12}\n", "selected only", formatDuration(selectedOnly));
+    fmt::print("{:>30} {:>12}\n", "extension filter, first only", formatDuration(firstMatch));
+}
+
+// Finding 300 icons by name on a 2000 icon desktop with one iconsByNames() call, against an iconByName()
+// call per name starting from a discarded name index, and against a full enumeration per name as
+// iconByName() did before it had an index.
+BENCHMARK(iconsByNamesVersusIconByName)
+{
+    const size_t icons = 2000;
+    const size_t wanted = 300;
+    auto backend = makeDesktop(icons);
+    setTypicalLatency(*backend);
+    DesktopController dc(backend);
+
+    vector<wstring> names;
+    for (size_t i = 0; i < wanted; ++i)
+        names.push_back(iconName(i * icons / wanted));
+
+    auto batch = timePerCall([&]() {
+        auto found = dc.iconsByNames(names);
+        if (!found.back())
+            throw runtime_error("iconsByNames didn't find an icon on the desktop");
+    });
+
+    auto indexed = timePerCall([&]() {
+        dc.invalidateNameIndex();
+        for (auto& name : names)
+            dc.iconByName(name);
+    });
+
+    auto scans = timePerCall([&]() {
+        for (auto& name : names)
+        {
+            bool found = false;
+            dc.enumerateIconsWhere(EnumerationOptions(), [&](const DesktopIcon* icon) {
+                found = (icon->displayName() == name);
+                return !found;
+            });
+        }
+    }, chrono::milliseconds(0));
+
+    fmt::print("{} icons, {} names\n", icons, wanted);
+    fmt::print("{:>26} {:>12}\n", "iconsByNames", formatDuration(batch));
+    fmt::print("{:>26} {:>12}\n", "iconByName, indexed", formatDuration(indexed));
+    fmt::print("{:>26} {:>12}\n", "enumeration per name", formatDuration(scans));
+}
+
+// Frames of 1000 icons on a simulated desktop with typical latency, through repositionIcons() and through
+// applyLayout(). In a mostly in place frame 10 icons move, as the head of a snake or a dragged group would;
+// in an all move frame every icon moves. Reports SelectAndPositionItems calls, icons skipped and time,
+// each per frame.
+BENCHMARK(applyLayoutSkippedIcons)
+{
+    const size_t icons = 1000;
+    const size_t frames = 20;
+    const size_t movingInPlace = 10;
+
+    auto backend = makeDesktop(icons);
+    setTypicalLatency(*backend);
+    DesktopController dc(backend);
+
+    auto all = dc.allIcons();
+    vector<DesktopIcon*> pointers;
+    vector<Vec2<int>> points;
+    for (auto& icon : all)
+    {
+        pointers.push_back(icon.get());
+        points.push_back(icon->position());
+    }
+
+    // Moves the first moving icons of the layout one pixel right.
+    auto step = [&](size_t moving)
+    {
+        for (size_t i = 0; i < moving; ++i)
+            points[i] += Vec2<int>(1, 0);
+    };
+
+    fmt::print("{} icons\n", icons);
+    fmt::print("{:>16} {:>15} {:>14} {:>16} {:>14}\n", "", "frame", "calls/frame", "skipped/frame", "time/frame");
+
+    for (size_t moving : { movingInPlace, icons })
+    {
+        const char* frame = (moving == icons ? "all move" : "mostly in place");
+
+        // repositionIcons() submits every icon each frame.
+        backend->resetCallCounts();
+        auto start = chrono::steady_clock::now();
+        for (size_t n = 0; n < frames; ++n)
+        {
+            step(moving);
+            dc.repositionIcons(pointers, points);
+        }
+        auto direct = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+        fmt::print("{:>16} {:>15} {:>14.1f} {:>16} {:>14}\n",
+            "repositionIcons",
+            frame,
+            static_cast<double>(backend->callCount(ShellCall::SelectAndPositionItems)) / frames,
+            0,
+            formatDuration(direct / frames));
+
+        // The first frame applies every icon, so it's excluded.
+        dc.forgetAppliedLayout();
+        dc.applyLayout(pointers, points);
+
+        size_t skipped = 0;
+        backend->resetCallCounts();
+        start = chrono::steady_clock::now();
+        for (size_t n = 0; n < frames; ++n)
+        {
+            step(moving);
+            skipped += dc.applyLayout(pointers, points);
+        }
+        auto applied = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+        fmt::print("{:>16} {:>15} {:>14.1f} {:>16.1f} {:>14}\n",
+            "applyLayout",
+            frame,
+            static_cast<double>(backend->callCount(ShellCall::SelectAndPositionItems)) / frames,
+            static_cast<double>(skipped) / frames,
+            formatDuration(applied / frames));
+    }
+}
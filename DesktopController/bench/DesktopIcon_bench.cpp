@@ -0,0 +1,65 @@
+#include "Benchmark.h"
+
+using namespace std;
+using namespace DcUtil;
+
+// Reading the display name of each of 1000 icons with displayName(), which asks the backend and builds a
+// new string every call, against cachedDisplayName(), which asks once and then returns the cached string.
+// The cached names are read again after a rename notification bumps the name generation, which makes every
+// icon fetch its name again on its next call. Typical latency, so the Shell call dominates the time.
+BENCHMARK(displayNameAllocations)
+{
+    const size_t icons = 1000;
+    const size_t rounds = 10;
+
+    auto backend = makeDesktop(icons + 1);
+    setTypicalLatency(*backend);
+    DesktopController dc(backend);
+    dc.subscribeChanges([](const DesktopChange&) {});
+
+    // The last icon is only used to send a rename notification.
+    auto all = dc.allIcons();
+    all.pop_back();
+
+    fmt::print("{} icons\n", icons);
+    fmt::print("{:>34} {:>14} {:>16} {:>14}\n", "", "time per call", "allocs per call", "Shell calls");
+
+    auto measure = [&](const string& label, size_t passes, const function<void(const DesktopIcon&)>& read)
+    {
+        backend->resetCallCounts();
+        const uint64_t allocationsBefore = heapAllocationCount();
+        auto start = chrono::steady_clock::now();
+        for (size_t pass = 0; pass < passes; ++pass)
+        {
+            for (auto& icon : all)
+                read(*icon);
+        }
+        auto elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+        const uint64_t allocations = heapAllocationCount() - allocationsBefore;
+
+        const size_t calls = passes * all.size();
+        fmt::print("{:>34} {:>14} {:>16.2f} {:>14}\n",
+            label,
+            formatDuration(elapsed / calls),
+            static_cast<double>(allocations) / calls,
+            backend->callCount(ShellCall::GetDisplayNameOf));
+    };
+
+    size_t totalLength = 0;
+    auto uncached = [&](const DesktopIcon& icon) { totalLength += icon.displayName().size(); };
+    auto cached = [&](const DesktopIcon& icon) { totalLength += icon.cachedDisplayName().size(); };
+
+    measure(fmt::format("displayName() x{}", rounds), rounds, uncached);
+    measure("cachedDisplayName(), first call", 1, cached);
+    measure(fmt::format("cachedDisplayName() x{}", rounds), rounds, cached);
+
+    backend->renameItem(static_cast<uint32_t>(icons + 1), L"Renamed.txt");
+    if (dc.processChanges() != 1)
+        throw runtime_error("The rename notification wasn't processed");
+
+    measure("cachedDisplayName(), after rename", 1, cached);
+    measure(fmt::format("cachedDisplayName() x{}", rounds), rounds, cached);
+
+    if (totalLength == 0)
+        throw runtime_error("Display names were empty");
+}
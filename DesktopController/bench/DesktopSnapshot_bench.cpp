@@ -0,0 +1,148 @@
+#include "Benchmark.h"
+#include "DesktopSnapshot.h"
+
+#include <algorithm>
+
+using namespace std;
+using namespace DcUtil;
+
+namespace
+{
+    // Work done on each pass over the icons: find the rightmost icon and count the names with an extension.
+    struct ScanResult
+    {
+        int rightmost = 0;
+        size_t withExtension = 0;
+    };
+
+    void scanIcon(ScanResult& result, const wstring& name, const Vec2<int>& position)
+    {
+        result.rightmost = max(result.rightmost, position.x);
+        if (name.find(L'.') != wstring::npos)
+            ++result.withExtension;
+    }
+}
+
+// Scans every icon's name and position several times, once with a DesktopSnapshot and once with allIcons()
+// and the per-icon accessors, which call in to the Shell on each pass.
+BENCHMARK(snapshotVersusIconAccessors)
+{
+    const size_t icons = 500;
+    auto backend = makeDesktop(icons);
+    setTypicalLatency(*backend);
+    DesktopController dc(backend);
+
+    fmt::print("{} icons\n", icons);
+    fmt::print("{:>6} {:>14} {:>14}\n", "scans", "snapshot", "allIcons");
+
+    for (int scans : { 1, 4, 16 })
+    {
+        auto snapshotTime = timePerCall([&]() {
+            DesktopSnapshot snapshot = dc.snapshot();
+            for (int s = 0; s < scans; ++s)
+            {
+                ScanResult result;
+                for (size_t i = 0; i < snapshot.size(); ++i)
+                    scanIcon(result, snapshot.name(i), snapshot.position(i));
+            }
+        });
+
+        auto accessorTime = timePerCall([&]() {
+            auto all = dc.allIcons();
+            for (int s = 0; s < scans; ++s)
+            {
+                ScanResult result;
+                for (auto& icon : all)
+                    scanIcon(result, icon->displayName(), icon->position());
+            }
+        });
+
+        fmt::print("{:>6} {:>14} {:>14}\n", scans, formatDuration(snapshotTime), formatDuration(accessorTime));
+    }
+}
+
+// Heap allocations and time taken to capture every icon with allIcons(), which keeps one item ID and one
+// DesktopIcon allocation per icon, and with snapshot(), which copies the item IDs in to one buffer. Since
+// a snapshot also holds names and positions, allIcons() is measured with and without reading them in to
+// vectors. The Shell allocates each item ID it returns either way, so that count is the same for all three.
+BENCHMARK(snapshotItemIdArena)
+{
+    const size_t icons = 1000;
+    auto backend = makeDesktop(icons);
+    DesktopController dc(backend);
+
+    auto allIcons = [&]() {
+        auto all = dc.allIcons();
+    };
+
+    auto allIconsWithNames = [&]() {
+        auto all = dc.allIcons();
+        vector<wstring> names;
+        vector<Vec2<int>> positions;
+        names.reserve(all.size());
+        positions.reserve(all.size());
+        for (auto& icon : all)
+        {
+            names.push_back(icon->displayName());
+            positions.push_back(icon->position());
+        }
+    };
+
+    auto snapshot = [&]() {
+        DesktopSnapshot snap = dc.snapshot();
+    };
+
+    fmt::print("{} icons\n", icons);
+    fmt::print("{:>26} {:>18} {:>12}\n", "", "heap allocations", "time");
+
+    auto report = [](const char* name, const function<void()>& f) {
+        uint64_t before = heapAllocationCount();
+        f();
+        uint64_t allocations = heapAllocationCount() - before;
+        fmt::print("{:>26} {:>18} {:>12}\n", name, allocations, formatDuration(timePerCall(f)));
+    };
+
+    report("allIcons", allIcons);
+    report("allIcons, names, positions", allIconsWithNames);
+    report("snapshot", snapshot);
+}
+
+// Comparing two snapshots of a 100k icon desktop between which 1% of the icons were moved, 1% renamed,
+// 1% edited, 1% removed and 1% added. Renaming changes an icon's key and name, so renamed icons are reported
+// as removed and added. Edited icons are matched by name since only their key changed, and aren't reported.
+BENCHMARK(diffSnapshots100k)
+{
+    const size_t icons = 100000;
+    const size_t changed = icons / 100;
+    auto backend = makeDesktop(icons);
+    DesktopController dc(backend);
+
+    DesktopSnapshot before = dc.snapshot();
+
+    // Icon IDs are 1 to icons, each kind of change is applied to every fifth one.
+    for (uint32_t i = 0; i < changed; ++i)
+    {
+        uint32_t id = 1 + i * 5;
+        backend->moveItem(id, backend->positionOf(id) + Vec2<int>(10, 10));
+        backend->renameItem(id + 1, L"Renamed " + to_wstring(i) + L".txt");
+        backend->touchItem(id + 2);
+        backend->removeItem(id + 3);
+        backend->addItem(L"Added " + to_wstring(i) + L".txt", Vec2<int>(1910, static_cast<int>(i)));
+    }
+
+    DesktopSnapshot after = dc.snapshot();
+
+    size_t counts[4] = {};
+    for (auto& change : diffSnapshots(before, after))
+        ++counts[static_cast<size_t>(change.type)];
+
+    auto time = timePerCall([&]() { diffSnapshots(before, after); });
+
+    fmt::print("{} icons\n", icons);
+    fmt::print("moved {}, renamed {}, removed {}, added {}\n",
+        counts[static_cast<size_t>(SnapshotChangeType::Moved)],
+        counts[static_cast<size_t>(SnapshotChangeType::Renamed)],
+        counts[static_cast<size_t>(SnapshotChangeType::Removed)],
+        counts[static_cast<size_t>(SnapshotChangeType::Added)]);
+    fmt::print("diffSnapshots {}\n", formatDuration(time));
+}
@@ -0,0 +1,72 @@
+#include "Benchmark.h"
+#include "IconAnimator.h"
+
+using namespace std;
+using namespace DcUtil;
+
+namespace
+{
+    // Frames per second and per-frame cost of an animation, from its statistics.
+    void printStats(size_t icons, const AnimationStats& stats)
+    {
+        double seconds = chrono::duration<double>(stats.elapsed).count();
+        auto meanCost = chrono::duration_cast<chrono::nanoseconds>(stats.totalFrameCost) / max<size_t>(1, stats.frames);
+        fmt::print("{:>8} {:>8} {:>8.1f} {:>14} {:>14}\n",
+            icons,
+            stats.frames,
+            stats.frames / seconds,
+            formatDuration(meanCost),
+            formatDuration(chrono::duration_cast<chrono::nanoseconds>(stats.maxFrameCost)));
+    }
+}
+
+// Frame pacing of a one second animation on a simulated clock, where applying a frame costs 2 ms plus
+// 50 us per icon, as a batch of SelectAndPositionItems calls does. The frame rate should fall from the
+// 60 fps limit as the cost rises, and never drop below the 10 fps limit.
+BENCHMARK(animationFramePacing)
+{
+    fmt::print("{:>8} {:>8} {:>8} {:>14} {:>14}\n", "icons", "frames", "fps", "mean cost", "max cost");
+
+    for (size_t icons : { 1, 10, 100, 1000 })
+    {
+        IconAnimator::Clock::time_point simulatedTime;
+        const auto frameCost = chrono::microseconds(2000) + chrono::microseconds(50) * static_cast<int>(icons);
+
+        IconAnimator animator(
+            [&](const vector<Vec2<int>>&) { simulatedTime += frameCost; },
+            [&]() { return simulatedTime; },
+            [&](IconAnimator::Clock::duration d) { simulatedTime += d; });
+
+        vector<Vec2<int>> start(icons, Vec2<int>(0, 0));
+        vector<Vec2<int>> end(icons, Vec2<int>(1000, 500));
+        printStats(icons, animator.animate(start, end, chrono::seconds(1)));
+    }
+}
+
+// The same animation in real time through DesktopController::applyLayout() on a simulated desktop with
+// typical latency, so the measured frame cost includes the controller's own work.
+BENCHMARK(animationApplyLayout)
+{
+    fmt::print("{:>8} {:>8} {:>8} {:>14} {:>14}\n", "icons", "frames", "fps", "mean cost", "max cost");
+
+    for (size_t icons : { 10, 100 })
+    {
+        auto backend = makeDesktop(icons);
+        setTypicalLatency(*backend);
+        DesktopController dc(backend);
+
+        auto all = dc.allIcons();
+        vector<DesktopIcon*> pointers;
+        vector<Vec2<int>> start;
+        vector<Vec2<int>> end;
+        for (auto& icon : all)
+        {
+            pointers.push_back(icon.get());
+            start.push_back(icon->position());
+            end.push_back(Vec2<int>(1000, 500));
+        }
+
+        IconAnimator animator(dc, pointers);
+        printStats(icons, animator.animate(start, end, chrono::milliseconds(500)));
+    }
+}
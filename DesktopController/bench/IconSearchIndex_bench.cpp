@@ -0,0 +1,102 @@
+#include "Benchmark.h"
+#include "IconSearchIndex.h"
+
+using namespace std;
+using namespace DcUtil;
+
+// Bringing a search index up to date after 1% of the icons on the desktop changed (a third moved, a third
+// renamed and a third edited, which changes their key), by applying diffSnapshots() with update() and by
+// rebuilding it with assign().
+BENCHMARK(searchIndexUpdateVersusRebuild)
+{
+    fmt::print("{:>8} {:>14} {:>14} {:>14}\n", "icons", "diff", "diff + update", "assign");
+
+    for (size_t icons : { 1000, 10000, 100000 })
+    {
+        auto backend = makeDesktop(icons);
+        DesktopController dc(backend);
+        DesktopSnapshot first = dc.snapshot();
+
+        // Icon IDs are 1 to icons.
+        const size_t changed = icons / 100;
+        for (uint32_t i = 0; i < changed; ++i)
+        {
+            uint32_t id = static_cast<uint32_t>(1 + i * (icons / changed));
+            if (i % 3 == 0)
+                backend->moveItem(id, backend->positionOf(id) + Vec2<int>(10, 10));
+            else if (i % 3 == 1)
+                backend->renameItem(id, L"Renamed " + to_wstring(i) + L".txt");
+            else
+                backend->touchItem(id);
+        }
+
+        DesktopSnapshot second = dc.snapshot();
+
+        IconSearchIndex index;
+        index.assign(first);
+
+        auto diff = timePerCall([&]() { diffSnapshots(first, second); });
+
+        // Alternates between the two snapshots so the index always reflects the before snapshot.
+        auto update = timePerCall([&]() {
+            index.update(first, second, diffSnapshots(first, second));
+            index.update(second, first, diffSnapshots(second, first));
+        }) / 2;
+
+        auto rebuild = timePerCall([&]() { index.assign(second); });
+
+        fmt::print("{:>8} {:>14} {:>14} {:>14}\n",
+            icons, formatDuration(diff), formatDuration(update), formatDuration(rebuild));
+    }
+}
+
+// Latency of each kind of query over an index of 100k names, for a selective query and for one which most
+// names match, keeping the best 10 results as a search box would. Allocations are those made by one query,
+// including normalizing it and building the results.
+BENCHMARK(searchIndexQueryLatency)
+{
+    const size_t icons = 100000;
+    const size_t maxResults = 10;
+
+    auto backend = makeDesktop(icons);
+    DesktopController dc(backend);
+    IconSearchIndex index;
+    index.assign(dc.snapshot());
+
+    struct Query
+    {
+        const char* kind;
+        wstring text;
+        function<vector<IconSearchResult>(const wstring&)> run;
+    };
+
+    auto prefix = [&](const wstring& q) { return index.prefix(q, maxResults); };
+    auto glob = [&](const wstring& q) { return index.glob(q, maxResults); };
+    auto fuzzy = [&](const wstring& q) { return index.fuzzy(q, maxResults); };
+
+    const Query queries[] = {
+        { "prefix", L"Icon 1234", prefix },
+        { "prefix", L"icon", prefix },
+        { "glob", L"*123?.TXT", glob },
+        { "glob", L"icon *", glob },
+        { "fuzzy", L"i1234t", fuzzy },
+        { "fuzzy", L"icn", fuzzy },
+    };
+
+    fmt::print("{} icons, best {} results\n", icons, maxResults);
+    fmt::print("{:>8} {:>12} {:>8} {:>14} {:>16}\n", "kind", "query", "results", "time per query", "allocs per query");
+
+    for (const Query& query : queries)
+    {
+        const size_t results = query.run(query.text).size();
+
+        const uint64_t allocationsBefore = heapAllocationCount();
+        query.run(query.text);
+        const uint64_t allocations = heapAllocationCount() - allocationsBefore;
+
+        auto time = timePerCall([&]() { query.run(query.text); });
+
+        fmt::print("{:>8} {:>12} {:>8} {:>14} {:>16}\n",
+            query.kind, wstringToUtf8(query.text), results, formatDuration(time), allocations);
+    }
+}
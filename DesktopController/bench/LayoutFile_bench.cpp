@@ -0,0 +1,39 @@
+#include "Benchmark.h"
+#include "LayoutFile.h"
+
+using namespace std;
+using namespace DcUtil;
+
+// Saving a 10k icon layout, opening it (mapping and validating the file) and restoring it on a simulated
+// desktop, without latency and with typical latency. restoreLayout() enumerates the desktop once and moves
+// every icon in one batch.
+BENCHMARK(layoutFileSaveLoadApply)
+{
+    const size_t icons = 10000;
+    auto backend = makeDesktop(icons);
+    DesktopController dc(backend);
+
+    const wstring path = tempFilePath(L"DesktopControllerBenchmark.layout");
+
+    DesktopSnapshot snapshot = dc.snapshot();
+    auto save = timePerCall([&]() { writeLayoutFile(path, snapshot); });
+    auto load = timePerCall([&]() { LayoutFileView view(path); });
+
+    chrono::nanoseconds apply;
+    chrono::nanoseconds applyWithLatency;
+    {
+        LayoutFileView layout(path);
+        apply = timePerCall([&]() { dc.restoreLayout(layout); });
+
+        setTypicalLatency(*backend);
+        applyWithLatency = timePerCall([&]() { dc.restoreLayout(layout); });
+    }
+
+    removeFile(path);
+
+    fmt::print("{} entries\n", icons);
+    fmt::print("{:>30} {:>12}\n", "writeLayoutFile", formatDuration(save));
+    fmt::print("{:>30} {:>12}\n", "LayoutFileView", formatDuration(load));
+    fmt::print("{:>30} {:>12}\n", "restoreLayout, no latency", formatDuration(apply));
+    fmt::print("{:>30} {:>12}\n", "restoreLayout, typical latency", formatDuration(applyWithLatency));
+}
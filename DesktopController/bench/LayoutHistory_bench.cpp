@@ -0,0 +1,115 @@
+#include "Benchmark.h"
+#include "LayoutHistory.h"
+
+using namespace std;
+using namespace DcUtil;
+
+namespace
+{
+    // A step in which count icons, starting from the nth, each move 10 pixels right.
+    vector<LayoutDelta> makeStep(size_t n, size_t count)
+    {
+        vector<LayoutDelta> step;
+        step.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const int x = static_cast<int>(n % 100) * 10;
+            const int y = static_cast<int>(i) * 100;
+            step.push_back({ n * count + i, Vec2<int>(x, y), Vec2<int>(x + 10, y) });
+        }
+        return step;
+    }
+}
+
+// Recording 10k ten-icon steps directly in to a LayoutHistory, with room for a tenth of them and for all of
+// them. Memory is reported once every step has been recorded, and is bounded by the capacity. Allocations
+// include building each step's vector, which record() then keeps without copying.
+BENCHMARK(layoutHistoryRecord)
+{
+    const size_t steps = 10000;
+    const size_t iconsPerStep = 10;
+    const size_t capacities[] = { 1000, 10000 };
+
+    fmt::print("{} steps of {} icons\n", steps, iconsPerStep);
+    fmt::print("{:>9} {:>14} {:>16} {:>10}\n", "capacity", "time per step", "allocs per step", "memory");
+    for (size_t capacity : capacities)
+    {
+        LayoutHistory history(capacity);
+
+        const uint64_t allocationsBefore = heapAllocationCount();
+        auto start = chrono::steady_clock::now();
+        for (size_t n = 0; n < steps; ++n)
+            history.record(makeStep(n, iconsPerStep));
+        auto elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+        const uint64_t allocations = heapAllocationCount() - allocationsBefore;
+
+        fmt::print("{:>9} {:>14} {:>16.1f} {:>7} KB\n",
+            capacity,
+            formatDuration(elapsed / steps),
+            static_cast<double>(allocations) / steps,
+            history.memoryUsage() / 1024);
+    }
+}
+
+// Moving ten icons at a time with repositionIcons() on a 1000 icon simulated desktop with typical latency,
+// 10k times, with history disabled and then recording every call in a 10k step history. Then undoing and
+// redoing the most recent 1000 steps. Each undo or redo enumerates the desktop until the step's icons are
+// found and moves them in one batch.
+BENCHMARK(layoutHistoryUndoRedo)
+{
+    const size_t icons = 1000;
+    const size_t steps = 10000;
+    const size_t iconsPerStep = 10;
+    const size_t replays = 1000;
+
+    auto backend = makeDesktop(icons);
+    setTypicalLatency(*backend);
+    DesktopController dc(backend);
+
+    auto all = dc.allIcons();
+    vector<DesktopIcon*> moving(iconsPerStep);
+    vector<Vec2<int>> points(iconsPerStep);
+
+    // Each call moves the next ten icons, so every call changes their positions and is recorded.
+    auto moveIcons = [&](size_t n)
+    {
+        const size_t first = (n * iconsPerStep) % icons;
+        for (size_t i = 0; i < iconsPerStep; ++i)
+        {
+            moving[i] = all[first + i].get();
+            points[i] = Vec2<int>(static_cast<int>(n % 200) * 5, static_cast<int>(i) * 100);
+        }
+        dc.repositionIcons(moving, points);
+    };
+
+    auto timeSteps = [&]()
+    {
+        auto start = chrono::steady_clock::now();
+        for (size_t n = 0; n < steps; ++n)
+            moveIcons(n);
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start) / steps;
+    };
+
+    auto withoutHistory = timeSteps();
+
+    dc.enableLayoutHistory(steps);
+    auto withHistory = timeSteps();
+    const size_t memory = dc.layoutHistory()->memoryUsage();
+
+    auto start = chrono::steady_clock::now();
+    for (size_t n = 0; n < replays; ++n)
+        dc.undoLayout();
+    auto undo = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start) / replays;
+
+    start = chrono::steady_clock::now();
+    for (size_t n = 0; n < replays; ++n)
+        dc.redoLayout();
+    auto redo = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start) / replays;
+
+    fmt::print("{} icons, {} steps of {} icons, typical latency\n", icons, steps, iconsPerStep);
+    fmt::print("{:>32} {:>12}\n", "repositionIcons, no history", formatDuration(withoutHistory));
+    fmt::print("{:>32} {:>12}\n", "repositionIcons, recorded", formatDuration(withHistory));
+    fmt::print("{:>32} {:>9} KB\n", "history memory", memory / 1024);
+    fmt::print("{:>32} {:>12}\n", "undoLayout", formatDuration(undo));
+    fmt::print("{:>32} {:>12}\n", "redoLayout", formatDuration(redo));
+}
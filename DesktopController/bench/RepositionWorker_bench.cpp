@@ -0,0 +1,211 @@
+#include "Benchmark.h"
+#include "RepositionWorker.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <algorithm>
+
+using namespace std;
+using namespace DcUtil;
+
+namespace
+{
+    using Clock = chrono::steady_clock;
+
+    // Waits for futures on its own thread, in the order they're added, and records how long each took
+    // from submission to completion. The worker applies batches in order, so waiting in order doesn't
+    // delay any timestamp.
+    class CompletionRecorder
+    {
+    public:
+        CompletionRecorder()
+            : done(false)
+            , waiter([this] { run(); })
+        {
+        }
+
+        ~CompletionRecorder()
+        {
+            finish();
+        }
+
+        void add(future<void> future, Clock::time_point submitted)
+        {
+            lock_guard<mutex> lock(guard);
+            queue.push_back(make_pair(std::move(future), submitted));
+            added.notify_one();
+        }
+
+        // Blocks until every future added so far has completed.
+        void finish()
+        {
+            {
+                lock_guard<mutex> lock(guard);
+                done = true;
+                added.notify_one();
+            }
+            if (waiter.joinable())
+                waiter.join();
+        }
+
+        const vector<Clock::duration>& latencies() const { return recorded; }
+
+    private:
+        void run()
+        {
+            for (;;)
+            {
+                unique_lock<mutex> lock(guard);
+                added.wait(lock, [this] { return done || !queue.empty(); });
+                if (queue.empty())
+                    return;
+
+                auto next = std::move(queue.front());
+                queue.pop_front();
+                lock.unlock();
+
+                next.first.get();
+                recorded.push_back(Clock::now() - next.second);
+            }
+        }
+
+        mutex guard;
+        condition_variable added;
+        deque<pair<future<void>, Clock::time_point>> queue;
+        vector<Clock::duration> recorded;
+        bool done;
+        thread waiter;
+    };
+
+    struct RunResult
+    {
+        uint64_t calls;
+        chrono::nanoseconds meanLatency;
+        chrono::nanoseconds maxLatency;
+        chrono::nanoseconds total;
+    };
+
+    RunResult summarise(const vector<Clock::duration>& latencies, uint64_t calls, Clock::duration total)
+    {
+        Clock::duration sum = Clock::duration::zero();
+        Clock::duration longest = Clock::duration::zero();
+        for (auto latency : latencies)
+        {
+            sum += latency;
+            longest = max(longest, latency);
+        }
+
+        RunResult result;
+        result.calls = calls;
+        result.meanLatency = chrono::duration_cast<chrono::nanoseconds>(sum / max<size_t>(1, latencies.size()));
+        result.maxLatency = chrono::duration_cast<chrono::nanoseconds>(longest);
+        result.total = chrono::duration_cast<chrono::nanoseconds>(total);
+        return result;
+    }
+
+    // The points of the nth update: every icon steps one pixel to the right.
+    void updatePoints(size_t n, vector<Vec2<int>>& points)
+    {
+        for (size_t i = 0; i < points.size(); ++i)
+            points[i] = Vec2<int>(static_cast<int>(n), static_cast<int>(i) * 100);
+    }
+}
+
+// Moving 50 icons 60 times, as a drag or an animation driven by input events would, either by calling
+// repositionIcons() directly for each update or by queueing each update on a RepositionWorker, on a
+// simulated desktop with typical latency. Updates are submitted back to back (a burst) or one every 4 ms.
+// Latency is the time from submitting an update until it has been applied: the length of the call when
+// calling directly, or until the update's future is ready with the worker. The worker coalesces updates
+// which arrive within a tick, so it makes fewer SelectAndPositionItems calls at the cost of latency.
+BENCHMARK(repositionWorkerLatency)
+{
+    const size_t icons = 50;
+    const size_t updates = 60;
+    const chrono::milliseconds pacings[] = { chrono::milliseconds(0), chrono::milliseconds(4) };
+    const double tickRates[] = { 25.0, 100.0 };
+
+    auto backend = makeDesktop(icons);
+    setTypicalLatency(*backend);
+
+    vector<DesktopIcon*> moving;
+    vector<Vec2<int>> points(icons);
+    DesktopController dc(backend);
+    auto all = dc.allIcons();
+    for (auto& icon : all)
+        moving.push_back(icon.get());
+
+    auto print = [&](const string& mode, chrono::milliseconds pacing, const RunResult& result)
+    {
+        fmt::print("{:>16} {:>8} {:>7} {:>13.1f} {:>13} {:>13} {:>10}\n",
+            mode,
+            pacing.count() == 0 ? string("burst") : fmt::format("{} ms", pacing.count()),
+            result.calls,
+            static_cast<double>(updates) / max<uint64_t>(1, result.calls),
+            formatDuration(result.meanLatency),
+            formatDuration(result.maxLatency),
+            formatDuration(result.total));
+    };
+
+    fmt::print("{} icons, {} updates, typical latency\n", icons, updates);
+    fmt::print("{:>16} {:>8} {:>7} {:>13} {:>13} {:>13} {:>10}\n",
+        "", "pacing", "calls", "updates/call", "mean latency", "max latency", "total");
+
+    for (auto pacing : pacings)
+    {
+        vector<Clock::duration> latencies;
+        backend->resetCallCounts();
+
+        auto start = Clock::now();
+        auto nextSubmit = start;
+        for (size_t n = 0; n < updates; ++n)
+        {
+            this_thread::sleep_until(nextSubmit);
+            nextSubmit += pacing;
+
+            updatePoints(n, points);
+            auto submitted = Clock::now();
+            dc.repositionIcons(moving, points);
+            latencies.push_back(Clock::now() - submitted);
+        }
+        auto total = Clock::now() - start;
+
+        print("direct", pacing, summarise(latencies, backend->callCount(ShellCall::SelectAndPositionItems), total));
+    }
+
+    for (double ticksPerSecond : tickRates)
+    {
+        for (auto pacing : pacings)
+        {
+            // The worker shares the backend, which isn't thread safe, so this thread doesn't call it
+            // again until the worker has been destroyed.
+            backend->resetCallCounts();
+            Clock::duration total;
+            vector<Clock::duration> latencies;
+            {
+                RepositionWorker worker([&] { return backend; }, ticksPerSecond);
+                CompletionRecorder recorder;
+
+                auto start = Clock::now();
+                auto nextSubmit = start;
+                for (size_t n = 0; n < updates; ++n)
+                {
+                    this_thread::sleep_until(nextSubmit);
+                    nextSubmit += pacing;
+
+                    updatePoints(n, points);
+                    auto submitted = Clock::now();
+                    recorder.add(worker.repositionIcons(moving, points), submitted);
+                }
+
+                recorder.finish();
+                total = Clock::now() - start;
+                latencies = recorder.latencies();
+            }
+
+            print(fmt::format("worker {:.0f}/s", ticksPerSecond), pacing,
+                summarise(latencies, backend->callCount(ShellCall::SelectAndPositionItems), total));
+        }
+    }
+}
@@ -0,0 +1,123 @@
+#include "Benchmark.h"
+#include "SlotAssignment.h"
+
+#include <random>
+
+using namespace std;
+using namespace DcUtil;
+
+namespace
+{
+    // Upper left coordinates of the first count cells of a grid filled in columns of 40, as Explorer
+    // fills a 1080p desktop with 75x100 spacing and nothing hidden by the taskbar.
+    vector<Vec2<int>> gridSlots(size_t count)
+    {
+        vector<Vec2<int>> slots;
+        slots.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+            slots.push_back(Vec2<int>(static_cast<int>(i / 40) * 75, static_cast<int>(i % 40) * 100));
+        return slots;
+    }
+
+    // Positions scattered uniformly over a desktop, 1920x1080 unless given. The seed is fixed so runs are comparable.
+    vector<Vec2<int>> scatteredPositions(size_t count, unsigned seed, int width = 1920, int height = 1080)
+    {
+        mt19937 random(seed);
+        uniform_int_distribution<int> x(0, width - 1);
+        uniform_int_distribution<int> y(0, height - 1);
+
+        vector<Vec2<int>> positions;
+        positions.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+            positions.push_back(Vec2<int>(x(random), y(random)));
+        return positions;
+    }
+}
+
+// assignSlots() with a few hundred scattered icons and many more slots, as when tidying a sparse desktop
+// in to a fine grid. Only the icons bid, so the time grows with icons * slots rather than slots^2.
+BENCHMARK(assignSlotsSpareSlots)
+{
+    const size_t iconCounts[] = { 100, 200, 300 };
+    const size_t slotCounts[] = { 2000, 6000 };
+
+    fmt::print("{:>6} {:>6} {:>12} {:>14}\n", "icons", "slots", "time", "total distance");
+    for (size_t slotCount : slotCounts)
+    {
+        const vector<Vec2<int>> slots = gridSlots(slotCount);
+        for (size_t iconCount : iconCounts)
+        {
+            const vector<Vec2<int>> positions = scatteredPositions(iconCount, 1);
+
+            SlotAssignment result;
+            auto time = timePerCall([&] { result = assignSlots(positions, slots); });
+            fmt::print("{:>6} {:>6} {:>12} {:>14}\n", iconCount, slotCount, formatDuration(time), result.totalDistance);
+        }
+    }
+}
+
+// assignSlots() with one slot per icon on a grid, where every third icon has been nudged off its cell.
+// Icons at their cell keep it, so only the nudged ones move.
+BENCHMARK(assignSlotsDisplacedGrid)
+{
+    const size_t counts[] = { 500, 1000, 2000, 3000 };
+
+    fmt::print("{:>6} {:>12} {:>8}\n", "icons", "time", "moved");
+    for (size_t count : counts)
+    {
+        const vector<Vec2<int>> slots = gridSlots(count);
+        vector<Vec2<int>> positions = slots;
+        for (size_t i = 0; i < count; i += 3)
+            positions[i] = Vec2<int>(positions[i].x + 20, positions[i].y + 30);
+
+        SlotAssignment result;
+        auto time = timePerCall([&] { result = assignSlots(positions, slots); });
+        fmt::print("{:>6} {:>12} {:>8}\n", count, formatDuration(time), result.moved.size());
+    }
+}
+
+// assignSlots() with fewer slots than icons, where the slots bid and the icons furthest from every slot
+// are left unassigned.
+BENCHMARK(assignSlotsSurplusIcons)
+{
+    const size_t iconCounts[] = { 2000, 6000 };
+    const size_t slotCount = 300;
+    const vector<Vec2<int>> slots = gridSlots(slotCount);
+
+    fmt::print("{:>6} {:>6} {:>12} {:>10}\n", "icons", "slots", "time", "assigned");
+    for (size_t iconCount : iconCounts)
+    {
+        const vector<Vec2<int>> positions = scatteredPositions(iconCount, 2);
+
+        SlotAssignment result;
+        auto time = timePerCall([&] { result = assignSlots(positions, slots); });
+
+        size_t assigned = 0;
+        for (size_t slot : result.slotOf)
+        {
+            if (slot != SlotAssignment::unassigned)
+                ++assigned;
+        }
+        fmt::print("{:>6} {:>6} {:>12} {:>10}\n", iconCount, slotCount, formatDuration(time), assigned);
+    }
+}
+
+// assignSlots() with one slot per icon and every icon scattered at random over the area the grid covers,
+// as when tidying a large, messy desktop. Icons compete for slots across the whole grid, so many have to
+// look beyond their nearest slots. Each size is timed once.
+BENCHMARK(assignSlotsRandomScatter)
+{
+    const size_t counts[] = { 2000, 5000 };
+
+    fmt::print("{:>6} {:>12} {:>8} {:>14}\n", "icons", "time", "moved", "total distance");
+    for (size_t count : counts)
+    {
+        const vector<Vec2<int>> slots = gridSlots(count);
+        const int width = static_cast<int>((count + 39) / 40) * 75;
+        const vector<Vec2<int>> positions = scatteredPositions(count, 3, width, 4000);
+
+        SlotAssignment result;
+        auto time = timePerCall([&] { result = assignSlots(positions, slots); }, chrono::milliseconds(0));
+        fmt::print("{:>6} {:>12} {:>8} {:>14}\n", count, formatDuration(time), result.moved.size(), result.totalDistance);
+    }
+}
@@ -0,0 +1,39 @@
+#include "Benchmark.h"
+
+using namespace std;
+using namespace DcUtil;
+
+// Throughput of itemIdKey() for item IDs of several sizes. A file's item ID on the desktop is typically
+// 80 to 200 bytes, since it embeds the file's long and short names and some attributes.
+BENCHMARK(itemIdKeyThroughput)
+{
+    const size_t count = 10000;
+    fmt::print("{:>10} {:>14} {:>12}\n", "ID bytes", "keys/s", "MB/s");
+
+    for (size_t size : { 16, 64, 128, 256 })
+    {
+        // Each item ID is a single SHITEMID of size bytes followed by the 2 byte terminator, as the Shell's are.
+        vector<ItemId> itemids(count, ItemId(size + sizeof(uint16_t), 0));
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint16_t cb = static_cast<uint16_t>(size);
+            memcpy(itemids[i].data(), &cb, sizeof(cb));
+            for (size_t b = sizeof(cb); b < size; ++b)
+                itemids[i][b] = static_cast<uint8_t>(i * 31 + b);
+        }
+
+        uint64_t combined = 0;
+        auto time = timePerCall([&]() {
+            for (auto& itemid : itemids)
+                combined += itemIdKey(itemid);
+        });
+
+        double seconds = chrono::duration<double>(time).count();
+        double keysPerSecond = count / seconds;
+        fmt::print("{:>10} {:>14.3g} {:>12.0f}\n", size, keysPerSecond, keysPerSecond * size / 1e6);
+
+        // Uses the keys so the loop isn't optimised away.
+        if (combined == 0)
+            fmt::print("(keys summed to 0)\n");
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <chrono>
+
+/** @brief Options for DesktopController::repositionIconsChunked().
+ */
+struct ChunkingOptions
+{
+    /** Size of the first chunk. If 0, the chunk size the previous chunked reposition settled on is used. */
+    size_t initialChunkSize = 0;
+    size_t minChunkSize = 1;        /**< Smallest chunk submitted, however slow chunks are. Must be more than 0. */
+    size_t maxChunkSize = 1024;     /**< Largest chunk submitted. Must be at least minChunkSize. */
+
+    /** Longest a single chunk should block the Shell for. Chunks are shrunk when they exceed this. */
+    std::chrono::steady_clock::duration maxStall = std::chrono::milliseconds(50);
+};
+
+/** @brief Time taken to submit one chunk of a chunked reposition.
+ */
+struct ChunkTiming
+{
+    size_t first;                                   /**< Index of the first icon in the chunk. */
+    size_t count;                                   /**< Number of icons in the chunk. */
+    std::chrono::steady_clock::duration elapsed;    /**< Time taken to reposition the chunk. */
+};
+
+/** @brief Result of DesktopController::repositionIconsChunked().
+ */
+struct ChunkedRepositionReport
+{
+    std::vector<ChunkTiming> chunks;                        /**< One element per chunk, in submission order. */
+    std::chrono::steady_clock::duration total{};            /**< Sum of the time taken by every chunk. */
+    std::chrono::steady_clock::duration longestStall{};     /**< Time taken by the slowest chunk. */
+};
+
+/** @brief Chooses chunk sizes for splitting a large batch of work, from the measured cost of previous chunks.
+ *
+ *  Each call in to the Shell has a fixed overhead, so larger chunks are cheaper per item, until the
+ *  cost of a batch grows faster than its size. AdaptiveChunker hill-climbs towards the chunk size with
+ *  the lowest cost per item. It keeps growing (or shrinking) the chunk size by a factor until the cost
+ *  per item is worse than the best seen, then steps the other way from the best size by a smaller factor.
+ *
+ *  A chunk which takes longer than ChunkingOptions::maxStall shrinks the next chunk in proportion, and
+ *  growth is limited to the size predicted to fit within maxStall.
+ *
+ *  It doesn't do any work or measure time itself, so it can be driven by a simulated cost model.
+ */
+class AdaptiveChunker
+{
+public:
+    /** Size of the first chunk used by DesktopController::repositionIconsChunked() when nothing better is known.
+     */
+    static const size_t defaultChunkSize = 32;
+
+    /** Constructor.
+     *
+     *  @param options Limits on chunk sizes. If options.initialChunkSize is 0, initialChunkSize is used instead.
+     *  @param initialChunkSize Size of the first chunk when options doesn't set one.
+     */
+    explicit AdaptiveChunker(const ChunkingOptions& options, size_t initialChunkSize = defaultChunkSize);
+
+    /** Get the size the next chunk should be.
+     */
+    size_t chunkSize() const { return size; }
+
+    /** Record the time taken by a chunk and choose the size of the next one.
+     *
+     *  @param count Number of items in the chunk. If this is less than chunkSize() (e.g. the last chunk 
+     *               of a batch), it's only used to enforce maxStall.
+     *  @param elapsed Time taken to process the chunk.
+     */
+    void record(size_t count, std::chrono::steady_clock::duration elapsed);
+
+private:
+    // Steps from base in the current direction, limited to fits.
+    double nextSize(double base, double fits) const;
+
+    // Limits a size to the options' minimum and maximum chunk sizes.
+    double clampSize(double s) const;
+
+    ChunkingOptions options;
+    size_t size;
+    bool growing;
+    double step;
+    // The chunk size with the lowest cost per item measured so far.
+    bool haveBest;
+    size_t bestSize;
+    double bestCostPerItem;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+// Avoid std::min/std::max collision with min/max macros defined by Windows.h inclusion.
+#define NOMINMAX
+
+#include <Windows.h>
+#include <shlobj.h>
+#include <atlbase.h>
+
+#include <string>
+#include <memory>
+
+#include "ShellBackend.h"
+
+/** @brief A ShellBackend which accesses the desktop shown by Explorer through the Shell's COM interfaces. Windows only.
+ *
+ *  This is the backend used by DesktopController's default constructor. Item IDs are the bytes of the 
+ *  Shell's ITEMID_CHILD, including the terminator, and statuses are the HRESULTs the Shell returns.
+ */
+class ComShellBackend : public ShellBackend
+{
+public:
+    /** Constructor. Initialises COM on the calling thread and finds the desktop's IShellView, IFolderView and IShellFolder.
+     *  Note: If not already set, DPI awareness is set to PROCESS_SYSTEM_DPI_AWARE, so positions are in physical pixels.
+     */
+    ComShellBackend();
+
+    /** Destructor. Unsubscribes from changes, releases the Shell's interfaces and uninitialises COM. Must be 
+     *  called on the thread which constructed this object.
+     */
+    ~ComShellBackend() override;
+
+    ShellStatus items(ShellItemSet set, std::unique_ptr<ShellItemEnumerator>& enumOut) override;
+    ShellStatus displayName(DcUtil::ItemIdView itemid, ShellNameKind kind, std::wstring& nameOut) const override;
+    ShellStatus itemPosition(DcUtil::ItemIdView itemid, DcUtil::Vec2<int>& positionOut) const override;
+    ShellStatus positionItems(size_t count, const DcUtil::ItemIdView* itemids, const DcUtil::Vec2<int>* points) override;
+    ShellStatus spacing(DcUtil::Vec2<int>& spacingOut) const override;
+    ShellStatus folderFlags(FolderFlags& flagsOut) const override;
+    DcUtil::Vec2<int> desktopResolution() const override;
+    int monitorCount() const override;
+    int systemDpi() const override;
+    DcUtil::Vec2<int> cursorPosition() const override;
+    void refresh() override;
+    void subscribeChanges() override;
+    void unsubscribeChanges() override;
+    size_t pollChanges(const std::function<void(const ShellChange&)>& handler) override;
+
+    /** Copy constructor is disabled.
+     */
+    ComShellBackend(const ComShellBackend&) = delete;
+
+    /** Copy assignment operator is disabled.
+     */
+    void operator=(const ComShellBackend&) = delete;
+
+private:
+    void findDesktopShellView(CComPtr<IShellView>& pShellViewOut);
+    void findDesktopFolderView(CComPtr<IShellView> pShellView, REFIID riid, void** ppv);
+    void releaseInterfaces();
+
+    CComPtr<IShellView> shellview;
+    CComPtr<IFolderView> folderview;
+    CComPtr<IShellFolder> shellfolder;
+
+    // Shell change notifications are posted as changeNotifyMessage to a message-only window.
+    static const UINT changeNotifyMessage = WM_APP + 1;
+    HWND changeNotifyWindow;
+    ULONG changeNotifyId;
+};
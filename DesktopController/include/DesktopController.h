@@ -1,55 +1,81 @@
 #pragma once
 
-// Avoid std::min/std::max collision with min/max macros defined by Windows.h inclusion.
-#define NOMINMAX
-
-#include <Windows.h>
-#include <shlobj.h>
-#include <exdisp.h>
-#include <shlwapi.h>
-#include <atlbase.h>
-#include <atlalloc.h>
 #include <stdio.h>
-#include <objbase.h>
 
 #include <string>
 #include <functional>
 #include <stdexcept>
 #include <memory>
 #include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <map>
+#include <chrono>
 
 #include "Util.h"
+#include "ShellBackend.h"
 #include "DesktopIcon.h"
+#include "DesktopSnapshot.h"
+#include "ShellCallMetrics.h"
+#include "AdaptiveChunker.h"
+#include "LayoutFile.h"
+#include "SlotAssignment.h"
+#include "LayoutHistory.h"
+#include "LayoutProfileStore.h"
+
+/** @brief Options for DesktopController::enumerateIconsWhere().
+ */
+struct EnumerationOptions
+{
+    bool selectedOnly = false;  /**< Only enumerate icons which are selected on the desktop. */
+    std::wstring namePrefix;    /**< If not empty, only icons whose display name starts with this are enumerated (case-insensitive). */
+    std::wstring extension;     /**< If not empty, only icons with this file extension (e.g. ".txt") are enumerated (case-insensitive). */
+};
 
-// ViewMode always seems to be the same value (1 = FVM_ICON) regardless of the desktop settings.
-// This disables support for it, for now.
-#if 0
-#define ENABLE_VIEW_MODE
-#endif
+/** @brief Options for DesktopController::repositionIconsVerified().
+ */
+struct VerifyOptions
+{
+    unsigned int maxRetries = 2;    /**< Number of times mismatched icons are resubmitted after the first batch. */
+    int tolerance = 0;              /**< An icon counts as placed if each coordinate is within this many pixels of its target. */
+
+    /** Time to wait after each batch before reading positions back, to let Explorer settle. */
+    std::chrono::milliseconds settleDelay = std::chrono::milliseconds(0);
+};
+
+/** @brief An icon which DesktopController::repositionIconsVerified() couldn't place.
+ */
+struct PlacementFailure
+{
+    size_t index;               /**< Index of the icon in the vector passed to repositionIconsVerified(). */
+    DcUtil::Vec2<int> target;   /**< Position the icon should have moved to. */
+    DcUtil::Vec2<int> actual;   /**< Position the icon was found at, or (0, 0) if it couldn't be read. */
+    ShellStatus status;         /**< shellOk if the icon was found elsewhere, otherwise the error which prevented placing it. */
+};
 
-#ifdef ENABLE_VIEW_MODE
-enum class ViewMode
+/** @brief Result of DesktopController::repositionIconsVerified().
+ */
+struct VerifiedRepositionReport
 {
-    Small,
-    Medium,
-    Large,
-    Unknown
+    unsigned int batches = 0;               /**< Number of batches submitted, including the first. */
+    size_t placed = 0;                      /**< Number of icons confirmed at their target. */
+    std::vector<PlacementFailure> failures; /**< Icons still not at their target when the retries ran out, in index order. */
 };
-#endif
 
-/** @brief Flags returned by DesktopController::folderFlags().
+/** @brief A change to the contents of the desktop, delivered to DesktopController::subscribeChanges() callbacks.
  */
-struct FolderFlags
+struct DesktopChange
 {
-    bool autoArrange;  /**< True if the desktop has autoarrange enabled. */
-    bool snapToGrid;   /**< True if the desktop has align/snap to grid enabled. */
+    DesktopChangeType type;  /**< Kind of change. */
+    std::wstring name;       /**< Display name of the item. For Renamed, this is the old name. May be empty for Updated. */
+    std::wstring newName;    /**< New display name of the item if type is Renamed, otherwise empty. */
 };
 
 
 /** @brief A class used to access desktop icons.
  *
  *  A C++11 based implementation for various tasks associated with the windows desktop.
- *  Access to desktop icons is achieved via Windows Shell interfaces. 
+ *  Access to desktop icons is achieved via Windows Shell interfaces, through a ShellBackend. 
  * 
  *  Multiple monitors are not supported officially (needs testing).
  * 
@@ -58,10 +84,18 @@ struct FolderFlags
 class DesktopController
 {
 public:
-    /** Default constructor. 
+#ifdef _WIN32
+    /** Default constructor. Accesses the desktop shown by Explorer through a ComShellBackend. Windows only.
      *  Note: If not already set, DPI awareness is set to PROCESS_SYSTEM_DPI_AWARE on construction.
      */
     DesktopController();
+#endif
+
+    /** Constructor which accesses the desktop through the given backend, e.g. a MemoryShellBackend.
+     *
+     *  @param backend The backend every Shell call is made through. Must not be null.
+     */
+    explicit DesktopController(std::shared_ptr<ShellBackend> backend);
 
     /** Destructor.
      */
@@ -74,7 +108,40 @@ public:
      */
     void enumerateIcons(const std::function<void(const DesktopIcon*)>& callback);
 
+    /** Enumerate all desktop icons in batches. Up to batchSize item IDs are fetched from the shell 
+     *  per call, rather than one at a time, and the resulting DesktopIcon pointers are passed to the caller together.
+     *
+     *  @param batchSize Maximum number of icons fetched from the shell at once. Must be more than 0.
+     *  @param callback A caller provided callable target which takes a vector of DesktopIcon pointers as an argument.
+     *                  The DesktopIcon objects pointed to are destroyed when the callback returns.
+     */
+    void enumerateIconsBatched(
+        unsigned int batchSize, 
+        const std::function<void(const std::vector<const DesktopIcon*>&)>& callback);
+
+    /** Enumerate the desktop icons which match a set of options. 
+     *
+     *  Filters are applied before a DesktopIcon is constructed, and display names are only retrieved 
+     *  from the Shell when a name or extension filter is set, so narrow queries are cheap.
+     *
+     *  @param options Filters applied to the enumeration. See EnumerationOptions.
+     *  @param callback A caller provided callable target which takes a pointer to a DesktopIcon as an argument.
+     *                  The DesktopIcon object pointed to is destroyed when the callback returns. 
+     *                  Return false from the callback to stop the enumeration.
+     *  @return The number of icons passed to the callback.
+     */
+    size_t enumerateIconsWhere(
+        const EnumerationOptions& options, 
+        const std::function<bool(const DesktopIcon*)>& callback);
+
     /** Get a unique pointer to a DesktopIcon which matches the given name exactly.
+     *
+     *  Lookups are answered from an index of display names which is built on first use, so repeated
+     *  calls don't enumerate the desktop again. The index is rebuilt after refresh(), invalidateNameIndex(),
+     *  or when a lookup finds the indexed icon's item ID no longer refers to an icon (checked with a single
+     *  GetItemPosition call per hit). A name which isn't found is remembered, so looking
+     *  it up again returns null without enumerating the desktop until the index is rebuilt or a change
+     *  notification reports an icon with that name was added.
      *
      *  @param name A UTF-16 encoded Unicode string matching a desktop icon's display name.
      *  @return If the icon is found, a DesktopIcon is constructed and returned in a unique_ptr.
@@ -82,6 +149,17 @@ public:
      */
     std::unique_ptr<DesktopIcon> iconByName(const std::wstring& name);
 
+    /** Find several icons by name in a single enumeration of the desktop.
+     *
+     *  This is much cheaper than calling iconByName() repeatedly when the index it uses isn't already built,
+     *  and always reflects the current state of the desktop.
+     *
+     *  @param names UTF-16 encoded Unicode strings matching desktop icon display names exactly.
+     *  @return A vector with one element per requested name, in the same order as names. 
+     *          Elements are null where no icon has the requested name.
+     */
+    std::vector<std::unique_ptr<DesktopIcon>> iconsByNames(const std::vector<std::wstring>& names);
+
     /** Get a vector of unique pointers to all desktop icons present on the desktop.
      *
      *  @return A vector where each element is a unique_ptr containing a DesktopIcon. Elements
@@ -89,6 +167,71 @@ public:
      */
     std::vector<std::unique_ptr<DesktopIcon>> allIcons();
 
+    /** Get a vector of all desktop icons present on the desktop, stored by value.
+     *
+     *  This avoids allocating each DesktopIcon separately as allIcons() does.
+     *
+     *  @return A vector where each element is a DesktopIcon, in enumeration order.
+     */
+    std::vector<DesktopIcon> allIconsValue();
+
+    /** Capture the item ID, display name and position of every desktop icon in a single enumeration.
+     *
+     *  @return A DesktopSnapshot containing one entry per icon, in enumeration order.
+     */
+    DesktopSnapshot snapshot();
+
+    /** Reposition icons, skipping any whose target is the same as the position last applied to it by applyLayout().
+     *  Both parameters must have the same number of elements.
+     *
+     *  This suits animation, where most icons are often stationary between frames. Applied positions are 
+     *  remembered per icon (see DesktopIcon::key()). Call forgetAppliedLayout() if icons may have been moved
+     *  by other means (e.g. by repositionIcons() or by the user) so they aren't wrongly skipped.
+     *
+     *  Remembered positions are also forgotten by refresh(), and for icons which processChanges() reports 
+     *  removed, renamed or moved. At most 65536 are kept: beyond that, only the icons passed to the latest call are.
+     *
+     *  @param icons A vector of DesktopIcon pointers.
+     *  @param points DcUtil::Vec2 which contains the new coordinates for each respective DesktopIcon.
+     *  @return The number of icons skipped because their position hadn't changed.
+     */
+    size_t applyLayout(const std::vector<DesktopIcon*>& icons, const std::vector<DcUtil::Vec2<int>>& points);
+
+    /** Forget the positions remembered by applyLayout(), so the next call submits every icon.
+     */
+    void forgetAppliedLayout();
+
+    /** Read the positions of several icons in one pass. Failures are reported per icon rather than thrown.
+     *
+     *  The output vectors are resized to icons.size(). No allocation takes place if they already have
+     *  enough capacity, so the same vectors can be reused across calls.
+     *
+     *  @param icons A vector of DesktopIcon pointers.
+     *  @param positions Receives the upper left coordinates of each respective icon. 
+     *                   Elements whose status isn't a success are set to (0, 0).
+     *  @param status Receives the ShellStatus of reading each respective icon's position.
+     *  @return The number of icons whose position couldn't be read.
+     */
+    size_t positionsOf(
+        const std::vector<DesktopIcon*>& icons, 
+        std::vector<DcUtil::Vec2<int>>& positions, 
+        std::vector<ShellStatus>& status) const;
+
+    /** Re-read the positions of every icon in a snapshot without enumerating the desktop.
+     *  
+     *  @see positionsOf(const std::vector<DesktopIcon*>&, std::vector<DcUtil::Vec2<int>>&, std::vector<ShellStatus>&)
+     */
+    size_t positionsOf(
+        const DesktopSnapshot& snap, 
+        std::vector<DcUtil::Vec2<int>>& positions, 
+        std::vector<ShellStatus>& status) const;
+
+    /** Read the positions of all desktop icons, in enumeration order (the same order as allIcons()).
+     *
+     *  @see positionsOf(const std::vector<DesktopIcon*>&, std::vector<DcUtil::Vec2<int>>&, std::vector<ShellStatus>&)
+     */
+    size_t allIconPositions(std::vector<DcUtil::Vec2<int>>& positions, std::vector<ShellStatus>& status);
+
     /** Reposition one or more icons. Both parameters must have the same number of elements.
      *
      *  @param icons A vector of DesktopIcon pointers.
@@ -97,9 +240,145 @@ public:
      */
     void repositionIcons(const std::vector<DesktopIcon*>& icons, std::vector<DcUtil::Vec2<int>>& points);
 
-    /** Used internally: Returns the display name of a specified file object as a UTF-16 Unicode string.
+    /** Reposition one or more icons captured in a snapshot, without constructing DesktopIcon objects.
+     *  Both vector parameters must have the same number of elements.
+     *
+     *  @param snap A snapshot containing the icons to move.
+     *  @param indices Indices in to snap of the icons to move.
+     *  @param points DcUtil::Vec2 which contains the new coordinates for each respective index.
+     */
+    void repositionIcons(
+        const DesktopSnapshot& snap, 
+        const std::vector<size_t>& indices, 
+        std::vector<DcUtil::Vec2<int>>& points);
+
+    /** Tidy icons in to a set of slots (e.g. grid cells), moving them as little as possible.
+     *
+     *  The icons' positions are read in one pass, each icon is assigned a slot with assignSlots() so the total 
+     *  distance moved is minimal, and only icons which aren't already at their slot are moved, in a single batch.
+     *  Icons whose position can't be read (e.g. because they've been deleted) aren't given a slot.
+     *
+     *  @param icons A vector of DesktopIcon pointers.
+     *  @param slots The upper left coordinates of each slot. If there are fewer slots than icons, 
+     *               the icons left unassigned aren't moved.
+     *  @return The slot assigned to each icon, or SlotAssignment::unassigned for icons which weren't given
+     *          one (including those whose position can't be read), and the icons which were moved.
      */
-    static std::wstring shellFolderObjNameToStrW(IShellFolder* shellfolder, ITEMID_CHILD* pidl);
+    SlotAssignment tidyIcons(const std::vector<DesktopIcon*>& icons, const std::vector<DcUtil::Vec2<int>>& slots);
+
+    /** Apply a saved layout to the desktop. Icons are matched to entries by display name.
+     *
+     *  The desktop is enumerated once, comparing each icon's name against the layout by hash and then
+     *  in place in the mapped file, and every icon found is moved in a single batch. If the layout has 
+     *  several entries with the same name, only the first of them is applied.
+     *
+     *  @param layout An open layout file. See writeLayoutFile().
+     *  @return The number of icons moved.
+     */
+    size_t restoreLayout(const LayoutFileView& layout);
+
+    /** Reposition icons and confirm they ended up where they were sent. Both vector parameters must have the same number of elements.
+     *
+     *  After each batch, the positions of the submitted icons are read back in bulk and compared against their
+     *  targets. Only the icons which didn't land on their target are resubmitted, up to options.maxRetries times.
+     *  A batch which the Shell rejects counts as an attempt rather than throwing.
+     *
+     *  Icons can't be placed freely while auto arrange is on, and snap to grid moves them to the nearest grid cell, 
+     *  so check folderFlags() or set options.tolerance to avoid retrying moves which can't succeed.
+     *
+     *  @param icons A vector of DesktopIcon pointers.
+     *  @param points DcUtil::Vec2 which contains the new coordinates for each respective DesktopIcon.
+     *  @param options Retry budget, tolerance and settle delay. See VerifyOptions.
+     *  @return The number of batches submitted and the icons which couldn't be placed.
+     */
+    VerifiedRepositionReport repositionIconsVerified(
+        const std::vector<DesktopIcon*>& icons, 
+        const std::vector<DcUtil::Vec2<int>>& points,
+        const VerifyOptions& options = VerifyOptions());
+
+    /** Reposition a large number of icons in several smaller batches. Both vector parameters must have the same number of elements.
+     *
+     *  Explorer doesn't respond while a batch is being applied, so one very large batch freezes the desktop
+     *  for the whole call. Splitting it lets Explorer repaint between chunks. The chunk size adapts to the 
+     *  measured time taken by each chunk (see AdaptiveChunker), aiming for the lowest total time while keeping
+     *  each chunk under options.maxStall. The size it settles on is used as the starting size of the next call
+     *  with the same minChunkSize, maxChunkSize and maxStall.
+     *
+     *  @param icons A vector of DesktopIcon pointers.
+     *  @param points DcUtil::Vec2 which contains the new coordinates for each respective DesktopIcon.
+     *  @param options Limits on chunk sizes and stall time. See ChunkingOptions.
+     *  @return The time taken by each chunk.
+     */
+    ChunkedRepositionReport repositionIconsChunked(
+        const std::vector<DesktopIcon*>& icons, 
+        const std::vector<DcUtil::Vec2<int>>& points,
+        const ChunkingOptions& options = ChunkingOptions());
+
+    /** Reposition icons given their display names, without constructing DesktopIcon objects.
+     *
+     *  The desktop is enumerated once, stopping as soon as every name has been found, and all of the
+     *  icons found are moved in a single batch. If several icons share a name, the first in enumeration 
+     *  order is moved.
+     *
+     *  @param targets Maps UTF-16 encoded Unicode display names to the new upper left coordinates of the icon.
+     *  @param skipUnmoved If true, the position of each icon found is read first and icons which are already at
+     *                     their target aren't resubmitted. Reading a position is much cheaper than moving an icon.
+     *  @return The number of icons moved. Names which don't match an icon are ignored.
+     */
+    size_t repositionByName(const std::unordered_map<std::wstring, DcUtil::Vec2<int>>& targets, bool skipUnmoved = false);
+
+    /** Reposition icons given their identity keys (see DesktopIcon::key()), without constructing DesktopIcon objects.
+     *
+     *  As repositionByName(), but display names aren't retrieved from the Shell, so this is cheaper.
+     *
+     *  @param targets Maps identity keys to the new upper left coordinates of the icon.
+     *  @return The number of icons moved. Keys which don't match an icon are ignored.
+     */
+    size_t repositionByKey(const std::unordered_map<uint64_t, DcUtil::Vec2<int>>& targets);
+
+    /** Start recording the icon movements made through this controller, so they can be undone.
+     *
+     *  Each call to one of this controller's reposition functions (repositionIcons(), repositionIconsVerified(),
+     *  repositionIconsChunked(), repositionByName(), repositionByKey(), tidyIcons() and restoreLayout()) becomes
+     *  one step, however many chunks or retries it takes. The positions of the icons are read once, when the
+     *  call starts, and only icons which change position are recorded. Movements made by applyLayout() (and so 
+     *  by IconAnimator), by RepositionWorker, by DesktopIcon::reposition(), by other controllers or by the user
+     *  aren't recorded, so per-frame movement doesn't pay for reading positions.
+     *
+     *  If history is already enabled, it's cleared and its capacity changed.
+     *
+     *  @param maxSteps Maximum number of steps kept. The oldest steps are discarded first. Must be more than 0.
+     */
+    void enableLayoutHistory(size_t maxSteps);
+
+    /** Stop recording icon movements and discard the history.
+     */
+    void disableLayoutHistory();
+
+    /** Get the layout history, or nullptr if it isn't enabled.
+     */
+    const LayoutHistory* layoutHistory() const { return history.get(); }
+
+    /** Move the icons in the most recent step back to where they were, in a single batch. The undo isn't 
+     *  itself recorded as a step.
+     *
+     *  Icons are found by identity key (see DesktopIcon::key()), so icons which have since been renamed or 
+     *  deleted aren't moved. The step counts as undone even if none of its icons are found, so it doesn't
+     *  block the steps before it.
+     *
+     *  @return The number of icons in the step which were found and moved back. This is less than the size of
+     *          the step (see LayoutHistory::undoStep()) if some weren't found, and 0 if none were or there was 
+     *          nothing to undo.
+     */
+    size_t undoLayout();
+
+    /** Reapply the most recently undone step, in a single batch.
+     *
+     *  @return The number of icons in the step which were found and moved, or 0 if none were or there was
+     *          nothing to redo.
+     *  @see undoLayout()
+     */
+    size_t redoLayout();
 
     /** Get the resolution of the desktop in pixels.
      *
@@ -107,6 +386,12 @@ public:
      */
     DcUtil::Vec2<int> desktopResolution() const;
 
+    /** Get the current display configuration: desktop resolution, number of monitors and system DPI.
+     *
+     *  @return DisplayConfiguration describing the current display settings.
+     */
+    DisplayConfiguration displayConfiguration() const;
+
     /** Get the dimensions of desktop icons in pixels, including surrounding whitespace.
      *
      *  @return DcUtil::Vec2 containing the dimensions of desktop icons in pixels.
@@ -119,10 +404,6 @@ public:
      */
     DcUtil::Vec2<int> cursorPosition() const;
 
-#ifdef ENABLE_VIEW_MODE
-    ViewMode viewMode() const;
-#endif
-
     /** Get folder flags for the desktop.
      *
      *  @return FolderFlags instance.
@@ -130,9 +411,42 @@ public:
     FolderFlags folderFlags() const;
 
     /** Notify the system that the contents of the desktop folder has changed.
+     *  This also invalidates the name index used by iconByName() and forgets the positions remembered by applyLayout().
      */
     void refresh();
 
+    /** Discard the name index used by iconByName(). It's rebuilt on the next lookup.
+     */
+    void invalidateNameIndex();
+
+    /** Subscribe to changes to the contents of the desktop (icons added, removed, renamed or moved).
+     *
+     *  Changes are reported by the backend (see ShellBackend::subscribeChanges()). They're queued until
+     *  processChanges() is called, which passes them to callbacks. ComShellBackend queues Shell change 
+     *  notifications on the thread which first subscribes, so processChanges() must be called on that thread.
+     *  The name index used by iconByName() and the positions remembered by applyLayout() are patched as 
+     *  changes are processed.
+     *
+     *  @note The Shell doesn't send notifications when icons are moved, so ComShellBackend never reports
+     *        DesktopChangeType::Moved. Use positionsOf() to detect moves.
+     *  @param callback A caller provided callable target which takes a DesktopChange as an argument.
+     *  @return An ID which can be passed to unsubscribeChanges().
+     */
+    int subscribeChanges(const std::function<void(const DesktopChange&)>& callback);
+
+    /** Remove a callback added by subscribeChanges(). When the last one is removed, the backend stops
+     *  queueing changes and those not yet processed are discarded.
+     *
+     *  @param id The ID returned by subscribeChanges().
+     */
+    void unsubscribeChanges(int id);
+
+    /** Deliver queued desktop changes to subscribed callbacks. This doesn't block.
+     *
+     *  @return The number of changes delivered.
+     */
+    size_t processChanges();
+
     /** Copy constructor is disabled.
      */
     DesktopController(const DesktopController&) = delete;
@@ -142,28 +456,122 @@ public:
     void operator=(const DesktopController&) = delete;
 
 private:
-    // This is done programmatically here (not in the manifest) because manifests are typically
-    // only applied to .exe. There may well be ways to embded a manifest in the .lib or .dll but
-    // for now this works.
-    void SetHighDpiAwareness();
+    // RepositionWorker submits its coalesced batches with positionItems().
+    friend class RepositionWorker;
+
+    // Per-item calls in to the backend go through the functions below, so there's a single
+    // place where they're measured.
+
+    // Number of item IDs requested per IEnumIDList::Next call by the enumeration functions.
+    static const size_t defaultEnumBatchSize = 64;
+
+    // Fetches item IDs from the desktop view in batches of up to batchSize and passes each batch to the callback.
+    // set selects which items are enumerated. The callback may take ownership of any item ID in the batch 
+    // (e.g. by moving it in to a DesktopIcon). Enumeration stops early if the callback returns false.
+    void enumerateItemIDs(
+        ShellItemSet set,
+        size_t batchSize, 
+        const std::function<bool(DcUtil::ItemId* itemids, size_t count)>& callback);
+
+    // Moves count items, given their item IDs, in one SelectAndPositionItems call. Throws if it fails.
+    void positionItems(size_t count, const DcUtil::ItemIdView* itemids, const DcUtil::Vec2<int>* points);
+
+    // Non-throwing version of positionItems. Returns the status of SelectAndPositionItems.
+    ShellStatus tryPositionItems(size_t count, const DcUtil::ItemIdView* itemids, const DcUtil::Vec2<int>* points);
+
+    // Collects the movements made by one public reposition call in to a single history step. The positions of
+    // the icons the call will move are read once, on construction, and the step is recorded on destruction if
+    // accept() was called, i.e. if the Shell accepted at least one of the call's batches. Does nothing unless
+    // history is enabled, or while a step is being undone or redone.
+    class HistoryScope
+    {
+    public:
+        HistoryScope(DesktopController& dc, size_t count, const DcUtil::ItemIdView* itemids, const DcUtil::Vec2<int>* points);
+        ~HistoryScope();
+
+        void accept() { accepted = true; }
+
+    private:
+        DesktopController& dc;
+        std::vector<LayoutDelta> step;
+        bool accepted;
+    };
+
+    // Reads the position of an item in to out, returning the status of GetItemPosition.
+    ShellStatus readItemPosition(DcUtil::ItemIdView itemid, DcUtil::Vec2<int>& out) const;
+
+    // Returns the display name of an item. Throws if it can't be retrieved.
+    std::wstring displayNameOf(DcUtil::ItemIdView itemid) const;
+
+    // Non-throwing version of displayNameOf. kind selects the name passed to GetDisplayNameOf.
+    bool tryDisplayName(DcUtil::ItemIdView itemid, std::wstring& nameOut, ShellNameKind kind = ShellNameKind::Display) const;
+
+    // Enumerates the desktop once and moves the items match returns a target for, in one batch.
+    // match returns a pointer to the item's target position, or nullptr to leave it alone. Only the first
+    // item matched to each target is moved. Enumeration stops once targetCount targets have been matched, so
+    // it must be the number of distinct targets match can return.
+    // If skipUnmoved is true, matched items which are already at their target aren't submitted.
+    // Returns the number of items moved.
+    size_t positionMatchedItems(
+        size_t targetCount, 
+        bool skipUnmoved,
+        const std::function<const DcUtil::Vec2<int>*(const DcUtil::ItemId& itemid)>& match);
+
+    // Constructs a DesktopIcon which owns a copy of itemid.
+    std::unique_ptr<DesktopIcon> cloneIcon(DcUtil::ItemIdView itemid);
+
+    void buildNameIndex();
+
+    // Returns the item ID indexed under name, or nullptr. The index is (re)built as necessary.
+    const DcUtil::ItemId* findIndexedName(const std::wstring& name);
+
+    // Updates nameIndex and nameGeneration to reflect a change. itemid is the item ID the removed or renamed
+    // item had, if known. If the Shell couldn't name a removed or renamed item, change.name is set from the index.
+    void patchNameIndex(DesktopChange& change, DcUtil::ItemIdView itemid);
+
+    // Removes the index entry whose item ID is equal to itemid.
+    // Returns the name it was indexed under, or an empty string if there's no such entry.
+    std::wstring eraseIndexedItemID(DcUtil::ItemIdView itemid);
+
+    std::shared_ptr<ShellBackend> backend;
+
+    // Maps display names to item IDs for iconByName(). When names are duplicated,
+    // the first icon in enumeration order is indexed.
+    std::unordered_map<std::wstring, DcUtil::ItemId> nameIndex;
+    bool nameIndexValid;
+
+    // Names looked up since the index was built which aren't on the desktop. A miss only rebuilds the
+    // index the first time, so polling for a name which doesn't exist doesn't enumerate the desktop each time.
+    std::unordered_set<std::wstring> missingNames;
 
-    bool Win81OrNewer();
+    // Incremented whenever display names may have changed. DesktopIcon compares this
+    // against the value it cached its name at (see DesktopIcon::cachedDisplayName()).
+    unsigned long nameGeneration;
 
-    std::pair<DWORD, DWORD> getWindowsVersion();
+    // The position last applied to each icon by applyLayout(), keyed by DesktopIcon::key().
+    std::unordered_map<uint64_t, DcUtil::Vec2<int>> appliedLayout;
 
-    static std::string errorIdToMessage(DWORD id);
+    // Number of entries appliedLayout may hold before it's pruned to the icons of the latest applyLayout() call.
+    static const size_t maxAppliedLayoutSize = 65536;
 
-    FOLDERSETTINGS folderSettings() const;
+    // Removes the entries of appliedLayout which a change makes stale. itemid is as for patchNameIndex().
+    void pruneAppliedLayout(const DesktopChange& change, DcUtil::ItemIdView itemid);
 
-    void findDesktopShellView(CComPtr<IShellView>& pShellViewOut);
-    void findDesktopFolderView(CComPtr<IShellView> pShellView, REFIID riid, void** ppv);
+    // Moves the icons in a history step to either their before or after positions, without recording a new step.
+    // Returns the number of icons found.
+    size_t replayLayoutStep(const std::vector<LayoutDelta>& step, bool undo);
 
-    static void throwHRESULTException(const std::string& function, HRESULT result);
-    static void throwLastError(const std::string& function);
+    // Null unless enableLayoutHistory() has been called.
+    std::unique_ptr<LayoutHistory> history;
 
-    static void getLastErrorWithString(DWORD& dw, std::string& message);
+    // Set while undoing or redoing, so the replayed batch isn't recorded.
+    bool replayingHistory;
+
+    // The chunk size the last call to repositionIconsChunked() finished with, or 0 before the first call,
+    // and the options it was found with. It's only reused by calls with the same limits.
+    size_t chunkSizeHint;
+    ChunkingOptions chunkSizeHintOptions;
 
-    CComPtr<IShellView> shellview;
-    CComPtr<IFolderView> folderview;
-    CComPtr<IShellFolder> shellfolder;
+    std::map<int, std::function<void(const DesktopChange&)>> changeCallbacks;
+    int nextChangeCallbackId;
 };
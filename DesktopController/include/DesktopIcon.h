@@ -2,6 +2,10 @@
 
 #include "Util.h"
 
+#include <string>
+
+class ShellBackend;
+
 /** @brief A class which represents an icon on the desktop.
  *
  *  This encapsulates operations which can be performed on a desktop icon.
@@ -9,18 +13,25 @@
 class DesktopIcon
 {
 public:
-    /** The constructor for DesktopIcon which takes pointers to Shell interfaces.
+    /** The constructor for DesktopIcon which takes a pointer to the backend used to access the Shell.
      *  This is called internally by DesktopController. You should not (need to)
      *  construct a DesktopIcon externally. 
+     *
+     *  nameGeneration optionally points to a counter which is incremented whenever 
+     *  display names may have changed. It's used to invalidate cachedDisplayName().
      */
     DesktopIcon(
-        IShellFolder* shellfolder,
-        IFolderView* folderview,
-        CComHeapPtr<ITEMID_CHILD> pidl);
+        ShellBackend* backend,
+        DcUtil::ItemId itemid,
+        const unsigned long* nameGeneration = nullptr);
+
+    /** Move constructor. other is left without an item ID and must not be used other than to be destroyed or assigned to.
+     */
+    DesktopIcon(DesktopIcon&& other) noexcept;
 
-    /** Destructor.
+    /** Move assignment operator. other is left without an item ID and must not be used other than to be destroyed or assigned to.
      */
-    ~DesktopIcon();
+    DesktopIcon& operator=(DesktopIcon&& other) noexcept;
 
     /** Get the display name of this icon as a UTF-16 encoded Unicode string.
      * 
@@ -28,6 +39,20 @@ public:
      */
     std::wstring displayName() const;
 
+    /** Get the display name of this icon, retrieving it from the Shell on the first call only.
+     *
+     *  The cache is invalidated by DesktopController::refresh(), by rename notifications delivered
+     *  through DesktopController::processChanges(), or by calling invalidateDisplayName().
+     *
+     *  @return A reference to the cached display name. The reference remains valid for the 
+     *          lifetime of this icon but its contents are updated when the cache is invalidated.
+     */
+    const std::wstring& cachedDisplayName() const;
+
+    /** Discard the name cached by cachedDisplayName().
+     */
+    void invalidateDisplayName() const;
+
     /** Get the upper left cordinates of this icon.
      *
      *  @return DcUtil::Vec2 containing x and y cordinates.
@@ -43,9 +68,17 @@ public:
      */
     void reposition(const DcUtil::Vec2<int>& pt) const;
 
-    /** Used internally: Get the item ID used to identify this item in shell interfaces.
+    /** Get a 64-bit key which identifies this icon, computed from its item ID on construction.
+     *
+     *  Two DesktopIcon objects which refer to the same item have the same key, so keys can be 
+     *  used to index caches and layouts in hash maps. See DcUtil::itemIdKey() for details of
+     *  stability and collisions.
      */
-    ITEMID_CHILD* getItemID() const { return itemid; }
+    uint64_t key() const { return identityKey; }
+
+    /** Used internally: Get the item ID used to identify this item to the ShellBackend.
+     */
+    const DcUtil::ItemId& getItemID() const { return itemid; }
 
     /** Copy constructor is disabled.
      */
@@ -60,7 +93,12 @@ public:
     DesktopIcon() = delete;
 
 private:
-    IShellFolder* shellfolder;
-    IFolderView* folderview;
-    CComHeapPtr<ITEMID_CHILD> itemid;
+    ShellBackend* backend;
+    DcUtil::ItemId itemid;
+    uint64_t identityKey;
+
+    const unsigned long* nameGeneration;
+    mutable std::wstring cachedName;
+    mutable unsigned long cachedNameGeneration;
+    mutable bool nameCached;
 };
\ No newline at end of file
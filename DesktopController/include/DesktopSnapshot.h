@@ -0,0 +1,140 @@
+#pragma once
+
+#include "Util.h"
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+/** @brief A copy of the state of every desktop icon, captured in a single enumeration.
+ *
+ *  Icon data is stored as contiguous columns (names, positions and item IDs) where the
+ *  same index refers to the same icon in each column. Reading from a snapshot doesn't
+ *  call in to the Shell, so scanning, sorting and exporting the data is cheap compared
+ *  to calling DesktopIcon::displayName() or DesktopIcon::position() for each icon.
+ *
+ *  Item IDs are copied in to a single contiguous buffer owned by the snapshot, rather than
+ *  allocated individually, and are all freed together when the snapshot is destroyed.
+ *
+ *  A snapshot isn't updated when the desktop changes. Use DesktopController::snapshot()
+ *  to capture a new one.
+ */
+class DesktopSnapshot
+{
+public:
+    /** Default constructor. Constructs an empty snapshot.
+     */
+    DesktopSnapshot() = default;
+
+    /** Move constructor.
+     */
+    DesktopSnapshot(DesktopSnapshot&&) = default;
+
+    /** Move assignment operator.
+     */
+    DesktopSnapshot& operator=(DesktopSnapshot&&) = default;
+
+    /** Get the number of icons in the snapshot.
+     */
+    size_t size() const { return itemIdOffsets.size(); }
+
+    /** Returns true if the snapshot contains no icons.
+     */
+    bool empty() const { return itemIdOffsets.empty(); }
+
+    /** Get the display name of the icon at index i as a UTF-16 encoded Unicode string.
+     */
+    const std::wstring& name(size_t i) const { return nameColumn.at(i); }
+
+    /** Get the upper left coordinates of the icon at index i.
+     */
+    const DcUtil::Vec2<int>& position(size_t i) const { return positionColumn.at(i); }
+
+    /** Get the identity key of the icon at index i. See DesktopIcon::key().
+     */
+    uint64_t key(size_t i) const { return keyColumn.at(i); }
+
+    /** Get the display names of all icons, in enumeration order.
+     */
+    const std::vector<std::wstring>& names() const { return nameColumn; }
+
+    /** Get the positions of all icons, in enumeration order.
+     */
+    const std::vector<DcUtil::Vec2<int>>& positions() const { return positionColumn; }
+
+    /** Get the identity keys of all icons, in enumeration order.
+     */
+    const std::vector<uint64_t>& keys() const { return keyColumn; }
+
+    /** Used internally: Get the item ID of the icon at index i. 
+     *  The item ID points in to the snapshot's buffer and is valid for the lifetime of the snapshot.
+     */
+    DcUtil::ItemIdView itemID(size_t i) const;
+
+    /** Used internally: Reserve space for n icons in each column.
+     */
+    void reserve(size_t n);
+
+    /** Used internally: Append an icon to the snapshot. itemid is copied in to the snapshot's buffer.
+     */
+    void append(DcUtil::ItemIdView itemid, std::wstring name, const DcUtil::Vec2<int>& position);
+
+    /** Copy constructor is disabled.
+     */
+    DesktopSnapshot(const DesktopSnapshot&) = delete;
+
+    /** Copy assignment operator is disabled.
+     */
+    void operator=(const DesktopSnapshot&) = delete;
+
+private:
+    std::vector<std::wstring> nameColumn;
+    std::vector<DcUtil::Vec2<int>> positionColumn;
+    std::vector<uint64_t> keyColumn;
+
+    // Item IDs are stored back to back in itemIdArena. itemIdOffsets holds the start of each, and itemIdSizes its length.
+    std::vector<uint8_t> itemIdArena;
+    std::vector<size_t> itemIdOffsets;
+    std::vector<uint32_t> itemIdSizes;
+};
+
+/** @brief Kinds of difference reported by diffSnapshots().
+ */
+enum class SnapshotChangeType : uint8_t
+{
+    Added,      /**< The icon is only in the after snapshot. */
+    Removed,    /**< The icon is only in the before snapshot. */
+    Moved,      /**< The icon is in both snapshots with the same name but a different position. */
+    Renamed     /**< The icon's key is unchanged but its name changed. Its position may also have changed. */
+};
+
+/** @brief A single difference between two snapshots, as returned by diffSnapshots().
+ */
+struct SnapshotChange
+{
+    static const uint32_t npos = 0xFFFFFFFF;    /**< Index value used where an icon isn't in a snapshot. */
+
+    SnapshotChangeType type;    /**< Kind of difference. */
+    uint32_t beforeIndex;       /**< Index of the icon in the before snapshot, or npos if type is Added. */
+    uint32_t afterIndex;        /**< Index of the icon in the after snapshot, or npos if type is Removed. */
+};
+
+/** Compare two snapshots of the desktop and list the differences between them.
+ *
+ *  Icons are matched by identity key (see DesktopIcon::key()) in O(n) using hash tables. Only icons whose
+ *  key is in one snapshot but not the other are then matched by display name, in enumeration order when
+ *  several share a name, e.g. a file whose item ID changed because it was edited. Anything else unmatched
+ *  is reported as Removed or Added. Icons are never matched by position.
+ *
+ *  Renaming a file changes its item ID as well as its name, so it can't be told from removing one icon
+ *  and adding another, and is reported as Removed and Added. Use DesktopController::subscribeChanges() 
+ *  to be told of renames. Renamed is only reported for icons whose display name changed without their
+ *  item ID changing.
+ *
+ *  @param before The earlier snapshot.
+ *  @param after The later snapshot.
+ *  @return Records of icons matched by key, then of icons matched by name or removed, then Added records.
+ *          Within each group, records are in enumeration order.
+ *          Icons whose name and position are unchanged are not reported.
+ */
+std::vector<SnapshotChange> diffSnapshots(const DesktopSnapshot& before, const DesktopSnapshot& after);
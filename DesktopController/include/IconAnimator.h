@@ -0,0 +1,134 @@
+#pragma once
+
+#include "DesktopController.h"
+
+#include <vector>
+#include <functional>
+#include <chrono>
+
+/** @brief Easing curves used by IconAnimator.
+ */
+enum class Easing
+{
+    Linear,     /**< Constant speed. */
+    EaseIn,     /**< Starts slowly and accelerates (quadratic). */
+    EaseOut,    /**< Starts quickly and decelerates (quadratic). */
+    EaseInOut   /**< Accelerates then decelerates (cubic). */
+};
+
+/** Map linear animation progress to eased progress.
+ *
+ *  @param easing The easing curve.
+ *  @param t Progress of the animation in the range 0-1. Values outside the range are clamped.
+ *  @return Eased progress. 0 at t = 0 and 1 at t = 1.
+ */
+double applyEasing(Easing easing, double t);
+
+/** @brief Statistics returned by IconAnimator::animate().
+ */
+struct AnimationStats
+{
+    size_t frames = 0;                                      /**< Number of frames applied, including the last. */
+    std::chrono::steady_clock::duration elapsed{};          /**< Time from the first frame starting to the last frame being applied. */
+    std::chrono::steady_clock::duration totalFrameCost{};   /**< Time spent applying frames. */
+    std::chrono::steady_clock::duration maxFrameCost{};     /**< Longest time taken to apply a single frame. */
+};
+
+/** @brief Animates icons between two layouts.
+ *
+ *  Frames are generated from the elapsed time, so an animation always takes (at least) its duration no
+ *  matter how many frames are applied. Each frame is one batched reposition.
+ *
+ *  Repositioning is expensive and its cost depends on the number of icons and the state of Explorer,
+ *  so the frame rate adapts to it: the time taken to apply each frame is measured, and the interval 
+ *  to the next frame is a multiple of the recent average cost, within the frame rate limits. 
+ *  This leaves Explorer time to repaint between frames.
+ *
+ *  The clock, sleep function and frame sink can be replaced, so an animation can be run against a 
+ *  simulated clock and Shell.
+ */
+class IconAnimator
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /** Called to apply one frame. Takes the position of each icon, in the same order as the layouts.
+     */
+    using FrameFunction = std::function<void(const std::vector<DcUtil::Vec2<int>>& points)>;
+
+    /** Returns the current time.
+     */
+    using NowFunction = std::function<Clock::time_point()>;
+
+    /** Blocks for the given amount of time.
+     */
+    using SleepFunction = std::function<void(Clock::duration)>;
+
+    /** Constructor. Animates icons on the desktop.
+     *
+     *  Frames are applied with DesktopController::applyLayout(), so icons which don't move between
+     *  frames aren't resubmitted to the Shell.
+     *
+     *  @param controller The controller used to move the icons. Must outlive the IconAnimator.
+     *  @param icons The icons to animate. The DesktopIcon objects must outlive the IconAnimator.
+     */
+    IconAnimator(DesktopController& controller, const std::vector<DesktopIcon*>& icons);
+
+    /** Constructor. Passes frames to a caller provided function.
+     *
+     *  @param applyFrame Called with the positions of every icon once per frame.
+     *  @param now Returns the current time. Defaults to std::chrono::steady_clock::now.
+     *  @param sleep Blocks the calling thread. Defaults to std::this_thread::sleep_for.
+     */
+    explicit IconAnimator(FrameFunction applyFrame, NowFunction now = nullptr, SleepFunction sleep = nullptr);
+
+    /** Set the range the frame rate adapts within. The defaults are 10 and 60 frames per second.
+     *
+     *  @param minFramesPerSecond Lowest frame rate, used however expensive frames are. Must be more than 0.
+     *  @param maxFramesPerSecond Highest frame rate, used when frames are cheap. Must be at least minFramesPerSecond.
+     */
+    void setFrameRateLimits(double minFramesPerSecond, double maxFramesPerSecond);
+
+    /** Set how many times the average frame cost the interval between frames is. The default is 2,
+     *  which leaves Explorer roughly as much time to repaint as it spends repositioning.
+     *
+     *  @param ratio Must be at least 1.
+     */
+    void setFrameCostRatio(double ratio);
+
+    /** Animate between two layouts. Blocks until the animation has finished. 
+     *  The first frame is applied at start and the last frame at end.
+     *
+     *  @param start Position of each icon at the start of the animation.
+     *  @param end Position of each icon at the end of the animation. Must be the same size as start.
+     *  @param duration Length of the animation.
+     *  @param easing The easing curve applied to each icon's path.
+     *  @return Statistics about the frames applied.
+     */
+    AnimationStats animate(
+        const std::vector<DcUtil::Vec2<int>>& start,
+        const std::vector<DcUtil::Vec2<int>>& end,
+        Clock::duration duration,
+        Easing easing = Easing::EaseInOut);
+
+    /** Get the interval between frames the last animation finished with.
+     *  This is a good estimate of the interval the next animation will start with.
+     */
+    Clock::duration frameInterval() const;
+
+private:
+    // Clamps interval to the frame rate limits.
+    Clock::duration clampInterval(Clock::duration interval) const;
+
+    FrameFunction applyFrame;
+    NowFunction now;
+    SleepFunction sleep;
+
+    Clock::duration minInterval;
+    Clock::duration maxInterval;
+    double frameCostRatio;
+
+    // Exponential moving average of the time taken to apply a frame. Kept between animations.
+    double averageFrameCost;
+    bool haveFrameCost;
+};
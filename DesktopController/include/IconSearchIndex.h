@@ -0,0 +1,109 @@
+#pragma once
+
+#include "DesktopSnapshot.h"
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+
+/** @brief A single match returned by IconSearchIndex queries.
+ */
+struct IconSearchResult
+{
+    uint64_t key;       /**< Identity key of the icon. See DesktopIcon::key(). */
+    std::wstring name;  /**< Display name of the icon, as it was indexed. */
+    int score;          /**< Relevance of the match. Higher scores are better matches. */
+};
+
+/** @brief An index for searching desktop icons by partial name.
+ *
+ *  Names are stored normalized (accents stripped and case folded) so queries match regardless 
+ *  of case or diacritics, e.g. "resume" matches "Résumé.docx". Queries don't call in to the Shell.
+ *
+ *  The index is filled from a DesktopSnapshot and can be kept up to date incrementally, either by
+ *  applying the output of diffSnapshots() or by inserting and erasing individual icons.
+ */
+class IconSearchIndex
+{
+public:
+    /** Default constructor. Constructs an empty index.
+     */
+    IconSearchIndex() = default;
+
+    /** Replace the contents of the index with the icons in a snapshot.
+     */
+    void assign(const DesktopSnapshot& snap);
+
+    /** Update the index with the differences between two snapshots, as returned by diffSnapshots().
+     *  The index is expected to reflect before. Only changed icons are touched. Icons whose key changed 
+     *  but whose name didn't (e.g. a file which was edited) are re-keyed without normalizing their name again.
+     */
+    void update(const DesktopSnapshot& before, const DesktopSnapshot& after, const std::vector<SnapshotChange>& changes);
+
+    /** Add an icon to the index, or update its name if key is already indexed.
+     */
+    void insert(uint64_t key, const std::wstring& name);
+
+    /** Remove an icon from the index. Does nothing if key isn't indexed.
+     */
+    void erase(uint64_t key);
+
+    /** Remove all icons from the index.
+     */
+    void clear();
+
+    /** Get the number of icons in the index.
+     */
+    size_t size() const { return entries.size(); }
+
+    /** Find icons whose name, or a word in their name, starts with query.
+     *  Names which start with query rank above names where only a later word does.
+     *
+     *  @param query Text to match. Normalized before matching.
+     *  @param maxResults Maximum number of results to return, or 0 for no limit.
+     *  @return Matches ordered from best to worst.
+     */
+    std::vector<IconSearchResult> prefix(const std::wstring& query, size_t maxResults = 0) const;
+
+    /** Find icons whose whole name matches a wildcard pattern, where '*' matches any sequence 
+     *  of characters and '?' matches any single character. Shorter names rank higher.
+     *
+     *  @param pattern Wildcard pattern. Normalized before matching.
+     *  @param maxResults Maximum number of results to return, or 0 for no limit.
+     *  @return Matches ordered from best to worst.
+     */
+    std::vector<IconSearchResult> glob(const std::wstring& pattern, size_t maxResults = 0) const;
+
+    /** Find icons whose name contains the characters of query in order, though not necessarily 
+     *  adjacent (e.g. "dkctl" matches "DesktopController"). Matches at the start of words and 
+     *  runs of consecutive characters rank higher.
+     *
+     *  @param query Text to match. Normalized before matching.
+     *  @param maxResults Maximum number of results to return, or 0 for no limit.
+     *  @return Matches ordered from best to worst.
+     */
+    std::vector<IconSearchResult> fuzzy(const std::wstring& query, size_t maxResults = 0) const;
+
+    /** Normalize a string for matching: strips diacritics and converts to lower case.
+     */
+    static std::wstring normalize(const std::wstring& s);
+
+private:
+    struct Entry
+    {
+        uint64_t key;
+        std::wstring name;
+        std::wstring normalized;
+    };
+
+    // Moves the entry indexed under oldKey to newKey. Does nothing if oldKey isn't indexed.
+    void rekey(uint64_t oldKey, uint64_t newKey);
+
+    // Scores each entry with scorer (negative scores are excluded) and returns the best maxResults.
+    template <typename Scorer>
+    std::vector<IconSearchResult> rank(size_t maxResults, Scorer scorer) const;
+
+    std::vector<Entry> entries;
+    std::unordered_map<uint64_t, size_t> entryIndex;    // Key to index in to entries.
+};
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "Util.h"
+#include "DesktopSnapshot.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/** @brief Header at the start of a layout file. 
+ *
+ *  A layout file is laid out as a LayoutFileHeader, followed by entryCount LayoutFileEntry records, 
+ *  followed by the names of every entry as UTF-16 code units, back to back and without terminators. 
+ *  All values are little-endian.
+ */
+struct LayoutFileHeader
+{
+    static const uint32_t magicValue = 0x594C4344;  /**< "DCLY" */
+    static const uint32_t currentVersion = 1;       /**< Version written by writeLayoutFile(). */
+
+    uint32_t magic;         /**< Must be magicValue. */
+    uint32_t version;       /**< Format version. Readers reject versions newer than they understand. */
+    uint32_t entryCount;    /**< Number of LayoutFileEntry records. */
+    uint32_t nameLength;    /**< Total number of UTF-16 code units in the name block. */
+};
+
+/** @brief The saved position of one icon in a layout file.
+ */
+struct LayoutFileEntry
+{
+    uint64_t nameHash;      /**< DcUtil::hashBytes() of the name's UTF-16 code units. */
+    uint32_t nameOffset;    /**< Index of the first code unit of the name in the name block. */
+    uint32_t nameLength;    /**< Number of code units in the name. */
+    int32_t x;              /**< Horizontal coordinate of the icon's upper left corner. */
+    int32_t y;              /**< Vertical coordinate of the icon's upper left corner. */
+};
+
+/** Save the names and positions of icons to a layout file.
+ *
+ *  The file is written to a temporary file next to path, then moved over path, so an existing 
+ *  layout isn't left half overwritten if writing fails.
+ *
+ *  @param path Path of the file to create or replace.
+ *  @param names UTF-16 encoded Unicode display names.
+ *  @param positions The upper left coordinates of each respective icon. Must be the same size as names.
+ */
+void writeLayoutFile(
+    const std::wstring& path, 
+    const std::vector<std::wstring>& names, 
+    const std::vector<DcUtil::Vec2<int>>& positions);
+
+/** Save the names and positions of every icon in a snapshot to a layout file.
+ *
+ *  @see writeLayoutFile(const std::wstring&, const std::vector<std::wstring>&, const std::vector<DcUtil::Vec2<int>>&)
+ */
+void writeLayoutFile(const std::wstring& path, const DesktopSnapshot& snap);
+
+/** Hash a name the way it's stored in LayoutFileEntry::nameHash.
+ *
+ *  @param name Unicode display name.
+ */
+uint64_t layoutNameHash(const std::wstring& name);
+
+/** @brief A read-only, memory-mapped view of a layout file.
+ *
+ *  The file is mapped rather than read, so opening it costs the same however large it is, and names
+ *  are read in place rather than copied. The header and every entry are validated when the file is opened, 
+ *  so the accessors don't need to check the file's contents.
+ *
+ *  Use DesktopController::restoreLayout() to apply a layout.
+ */
+class LayoutFileView
+{
+public:
+    /** Constructor. Maps and validates a layout file. Throws std::runtime_error if the file can't be 
+     *  opened or isn't a valid layout file.
+     *
+     *  @param path Path of the layout file.
+     */
+    explicit LayoutFileView(const std::wstring& path);
+
+    /** Destructor. Unmaps the file.
+     */
+    ~LayoutFileView();
+
+    /** Get the number of entries in the layout.
+     */
+    size_t size() const { return header->entryCount; }
+
+    /** Get the entry at index i. Unchecked.
+     */
+    const LayoutFileEntry& entry(size_t i) const { return entries[i]; }
+
+    /** Get a pointer to the first UTF-16 code unit of the name of the entry at index i. 
+     *  The name isn't null terminated; its length is entry(i).nameLength. Unchecked.
+     */
+    const char16_t* nameData(size_t i) const { return names + entries[i].nameOffset; }
+
+    /** Get a copy of the name of the entry at index i.
+     */
+    std::wstring name(size_t i) const;
+
+    /** Compare the name of the entry at index i with name, in place where wchar_t is UTF-16. Unchecked.
+     */
+    bool nameEquals(size_t i, const std::wstring& name) const;
+
+    /** Get the position of the entry at index i.
+     */
+    DcUtil::Vec2<int> position(size_t i) const;
+
+    /** Copy constructor is disabled.
+     */
+    LayoutFileView(const LayoutFileView&) = delete;
+
+    /** Copy assignment operator is disabled.
+     */
+    void operator=(const LayoutFileView&) = delete;
+
+private:
+    void close();
+
+    const void* view;
+    size_t viewSize;
+#ifdef _WIN32
+    void* file;
+    void* mapping;
+#endif
+
+    // Point in to view.
+    const LayoutFileHeader* header;
+    const LayoutFileEntry* entries;
+    const char16_t* names;
+};
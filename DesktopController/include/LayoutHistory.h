@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Util.h"
+
+#include <vector>
+#include <cstdint>
+
+/** @brief The movement of one icon in a LayoutHistory step.
+ */
+struct LayoutDelta
+{
+    uint64_t key;               /**< Identity key of the icon. See DesktopIcon::key(). */
+    DcUtil::Vec2<int> before;   /**< Position of the icon before the step. */
+    DcUtil::Vec2<int> after;    /**< Position the icon was moved to. */
+};
+
+/** @brief A bounded undo/redo history of icon movements.
+ *
+ *  Each step holds only the icons which moved in it, so memory use is proportional to the number of icons 
+ *  moved, not the number on the desktop. Steps are kept in a ring buffer: once it's full, recording a step
+ *  discards the oldest. Recording a step after undoing discards the steps which could have been redone.
+ *
+ *  LayoutHistory only stores steps. DesktopController records and replays them; see 
+ *  DesktopController::enableLayoutHistory().
+ */
+class LayoutHistory
+{
+public:
+    /** Constructor.
+     *
+     *  @param capacity Maximum number of steps kept. Must be more than 0.
+     */
+    explicit LayoutHistory(size_t capacity);
+
+    /** Add a step. Empty steps are ignored.
+     */
+    void record(std::vector<LayoutDelta> step);
+
+    /** Get the step which would be reverted by an undo, or nullptr if there's nothing to undo.
+     */
+    const std::vector<LayoutDelta>* undoStep() const;
+
+    /** Get the step which would be reapplied by a redo, or nullptr if there's nothing to redo.
+     */
+    const std::vector<LayoutDelta>* redoStep() const;
+
+    /** Used internally: Move back one step after undoStep() has been reverted.
+     */
+    void markUndone();
+
+    /** Used internally: Move forward one step after redoStep() has been reapplied.
+     */
+    void markRedone();
+
+    /** Get the number of steps which can be undone.
+     */
+    size_t undoCount() const { return cursor; }
+
+    /** Get the number of steps which can be redone.
+     */
+    size_t redoCount() const { return count - cursor; }
+
+    /** Get the maximum number of steps kept.
+     */
+    size_t capacity() const { return steps.size(); }
+
+    /** Get the number of bytes allocated for stored deltas.
+     */
+    size_t memoryUsage() const { return deltaCapacity * sizeof(LayoutDelta); }
+
+    /** Discard every step.
+     */
+    void clear();
+
+private:
+    // Index in to steps of the nth oldest step.
+    size_t slot(size_t n) const { return (head + n) % steps.size(); }
+
+    // Frees the step at the given index.
+    void release(size_t index);
+
+    std::vector<std::vector<LayoutDelta>> steps;
+    size_t head;            // Index of the oldest step.
+    size_t count;           // Number of steps stored.
+    size_t cursor;          // Number of steps currently applied, counted from the oldest.
+    size_t deltaCapacity;   // Sum of the capacities of the stored steps.
+};
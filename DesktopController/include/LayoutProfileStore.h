@@ -0,0 +1,136 @@
+#pragma once
+
+#include "Util.h"
+#include "DesktopSnapshot.h"
+
+#include <string>
+#include <functional>
+#include <unordered_map>
+
+class DesktopController;
+
+/** @brief The display settings which determine where Explorer places desktop icons, returned by DesktopController::displayConfiguration().
+ */
+struct DisplayConfiguration
+{
+    DcUtil::Vec2<int> resolution;   /**< Resolution of the desktop in pixels. See DesktopController::desktopResolution(). */
+    int monitorCount = 0;           /**< Number of display monitors attached to the desktop. */
+    int dpi = 0;                    /**< System DPI, e.g. 96 at 100% scaling. */
+
+    /** Returns true if every field is equal.
+     */
+    bool operator==(const DisplayConfiguration& other) const
+    {
+        return resolution.x == other.resolution.x && resolution.y == other.resolution.y &&
+            monitorCount == other.monitorCount && dpi == other.dpi;
+    }
+
+    /** Returns true if any field differs.
+     */
+    bool operator!=(const DisplayConfiguration& other) const 
+    { 
+        return !(*this == other); 
+    }
+};
+
+/** @brief Hash function for DisplayConfiguration, for use with unordered containers.
+ */
+struct DisplayConfigurationHash
+{
+    /** Returns a hash of every field of config.
+     */
+    size_t operator()(const DisplayConfiguration& config) const
+    {
+        const int fields[4] = { config.resolution.x, config.resolution.y, config.monitorCount, config.dpi };
+        return static_cast<size_t>(DcUtil::hashBytes(fields, sizeof(fields)));
+    }
+};
+
+/** A saved layout: the upper left coordinates of each icon, keyed by display name.
+ */
+using LayoutProfile = std::unordered_map<std::wstring, DcUtil::Vec2<int>>;
+
+/** @brief Keeps one saved layout per display configuration and restores the matching layout when the configuration changes.
+ *
+ *  Explorer rearranges icons when the resolution, monitor setup or DPI changes. Save a profile for each
+ *  configuration (e.g. from DesktopController::snapshot()), then call onDisplayChange() with 
+ *  DesktopController::displayConfiguration() when a WM_DISPLAYCHANGE or WM_DPICHANGED message is received,
+ *  or periodically. Profiles are looked up in O(1) by configuration. Only icons which aren't already 
+ *  at their saved position are moved, in a single batch.
+ *
+ *  The function used to apply profiles can be replaced, so display changes can be simulated.
+ */
+class LayoutProfileStore
+{
+public:
+    /** Applies a profile and returns the number of icons moved.
+     */
+    using ApplyFunction = std::function<size_t(const LayoutProfile& profile)>;
+
+    /** Constructor. Profiles are applied to the desktop with DesktopController::repositionByName(),
+     *  skipping icons which haven't moved. The controller's current display configuration is recorded,
+     *  so onDisplayChange() doesn't apply a profile until the configuration changes from it.
+     *
+     *  @param controller The controller used to move icons. Must outlive the LayoutProfileStore.
+     */
+    explicit LayoutProfileStore(DesktopController& controller);
+
+    /** Constructor. Profiles are passed to a caller provided function.
+     *  The first call to onDisplayChange() records the current configuration without applying a profile.
+     *
+     *  @param apply Called with the profile to apply.
+     */
+    explicit LayoutProfileStore(ApplyFunction apply);
+
+    /** Save a profile for a display configuration, replacing any profile already saved for it.
+     */
+    void save(const DisplayConfiguration& config, LayoutProfile profile);
+
+    /** Save the positions of the icons in a snapshot as the profile for a display configuration.
+     *  If several icons share a name, the first in the snapshot is saved.
+     */
+    void save(const DisplayConfiguration& config, const DesktopSnapshot& snap);
+
+    /** Get the profile saved for a display configuration.
+     *
+     *  @return A pointer to the profile, or nullptr if none is saved. The pointer is invalidated 
+     *          when the profile is replaced or erased.
+     */
+    const LayoutProfile* find(const DisplayConfiguration& config) const;
+
+    /** Remove the profile saved for a display configuration.
+     *
+     *  @return True if a profile was removed.
+     */
+    bool erase(const DisplayConfiguration& config);
+
+    /** Get the number of saved profiles.
+     */
+    size_t size() const { return profiles.size(); }
+
+    /** Handle a (possibly) changed display configuration. 
+     *
+     *  If config is different to the configuration passed to the previous call (or recorded at construction),
+     *  and a profile is saved for it, the profile is applied. The first configuration seen is only recorded,
+     *  since icons are already arranged for it. Calling this again with an unchanged configuration does 
+     *  nothing, so it can be polled.
+     *
+     *  @param config The new display configuration.
+     *  @return The number of icons moved.
+     */
+    size_t onDisplayChange(const DisplayConfiguration& config);
+
+    /** Apply the profile saved for a display configuration, regardless of whether the configuration has changed.
+     *
+     *  @return The number of icons moved, or 0 if no profile is saved for config.
+     */
+    size_t applyProfile(const DisplayConfiguration& config);
+
+private:
+    ApplyFunction applyFunction;
+    std::unordered_map<DisplayConfiguration, LayoutProfile, DisplayConfigurationHash> profiles;
+
+    // The configuration passed to the last call to onDisplayChange(), or recorded at construction.
+    DisplayConfiguration currentConfig;
+    bool haveCurrentConfig;
+};
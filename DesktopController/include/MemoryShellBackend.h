@@ -0,0 +1,211 @@
+#pragma once
+
+#include "ShellBackend.h"
+#include "ShellCallMetrics.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <deque>
+#include <chrono>
+#include <cstdint>
+
+/** @brief Simulated cost of one type of Shell call, used by MemoryShellBackend.
+ *
+ *  A call which handles n items (item IDs fetched, or icons moved) takes
+ *  fixed + perItem * n + perItemSquared * n * n. Calls which handle a single item have n = 1.
+ */
+struct ShellCallLatency
+{
+    std::chrono::nanoseconds fixed = std::chrono::nanoseconds(0);           /**< Cost of every call. */
+    std::chrono::nanoseconds perItem = std::chrono::nanoseconds(0);         /**< Cost of each item handled by the call. */
+    std::chrono::nanoseconds perItemSquared = std::chrono::nanoseconds(0);  /**< Cost multiplied by the square of the number of items. */
+};
+
+/** @brief A ShellBackend which simulates a desktop in memory.
+ *
+ *  Items have a display name, a position and a selection state, and are enumerated in the order they
+ *  were added. Item IDs are laid out as the Shell's are (a single SHITEMID followed by a terminator), but 
+ *  no Shell interface is used, so DesktopController can run against this without Explorer, and on any 
+ *  platform (e.g. in benchmarks and tests).
+ *
+ *  Each type of call can be given a latency (see ShellCallLatency), which is simulated by busy-waiting
+ *  so it's accurate at sub-millisecond durations. Calls are counted per type.
+ *
+ *  Icons are placed as Explorer places them: positions are snapped to the nearest multiple of the icon
+ *  spacing when snap to grid is on, and positionItems() has no effect while auto arrange is on.
+ *
+ *  While subscribed (see subscribeChanges()), addItem(), removeItem(), renameItem(), moveItem() and clear()
+ *  queue a change as the Shell would notify it, except that moves are reported too. Like the Shell, removed
+ *  and renamed items are identified by their old item ID only, without their old name. Changes made through
+ *  positionItems() and touchItem() aren't reported.
+ *
+ *  This class isn't thread safe.
+ */
+class MemoryShellBackend : public ShellBackend
+{
+public:
+    /** Constructor. Constructs an empty 1920x1080 desktop with one monitor at 96 DPI,
+     *  75x100 icon spacing, no folder flags set and no latency.
+     */
+    MemoryShellBackend();
+
+    /** Add an item to the end of the desktop.
+     *
+     *  @param name Display name of the item. The extension, if any, is part of the name.
+     *  @param position Upper left coordinates of the item.
+     *  @return An ID which identifies the item in the other functions of this class.
+     */
+    uint32_t addItem(const std::wstring& name, const DcUtil::Vec2<int>& position);
+
+    /** Remove an item. Item IDs already returned for it are no longer recognised.
+     *
+     *  @return False if id isn't an item on the desktop.
+     */
+    bool removeItem(uint32_t id);
+
+    /** Change the display name of an item. Item IDs already returned for it are no longer recognised,
+     *  since the Shell's item IDs of files embed the file name.
+     *
+     *  @return False if id isn't an item on the desktop.
+     */
+    bool renameItem(uint32_t id, const std::wstring& name);
+
+    /** Simulate editing the file behind an item. The item's name and position are unchanged, but the bytes
+     *  of its item ID change (the Shell's embed the file's size and modification time), so its key changes
+     *  (see DesktopIcon::key()). Item IDs already returned for it are no longer recognised.
+     *
+     *  @return False if id isn't an item on the desktop.
+     */
+    bool touchItem(uint32_t id);
+
+    /** Move an item directly, e.g. to simulate the user dragging it. This isn't counted as a call.
+     *
+     *  @return False if id isn't an item on the desktop.
+     */
+    bool moveItem(uint32_t id, const DcUtil::Vec2<int>& position);
+
+    /** Select or deselect an item. Selected items are enumerated by ShellItemSet::Selection.
+     *
+     *  @return False if id isn't an item on the desktop.
+     */
+    bool selectItem(uint32_t id, bool selected);
+
+    /** Get the upper left coordinates of an item, or (0, 0) if id isn't an item on the desktop.
+     */
+    DcUtil::Vec2<int> positionOf(uint32_t id) const;
+
+    /** Get the number of items on the desktop.
+     */
+    size_t itemCount() const { return order.size(); }
+
+    /** Remove every item.
+     */
+    void clear();
+
+    /** Set the simulated latency of a type of call.
+     */
+    void setLatency(ShellCall call, const ShellCallLatency& latency);
+
+    /** Get the simulated latency of a type of call.
+     */
+    const ShellCallLatency& latency(ShellCall call) const;
+
+    /** Get the number of calls of a type made since construction or resetCallCounts().
+     */
+    uint64_t callCount(ShellCall call) const;
+
+    /** Set the number of calls of every type back to 0.
+     */
+    void resetCallCounts();
+
+    /** Set the values returned by desktopResolution(), monitorCount() and systemDpi().
+     */
+    void setDisplay(const DcUtil::Vec2<int>& resolution, int monitors, int dpi);
+
+    /** Set the value returned by spacing().
+     */
+    void setSpacing(const DcUtil::Vec2<int>& spacing);
+
+    /** Set the folder flags returned by folderFlags().
+     */
+    void setFolderFlags(const FolderFlags& flags);
+
+    /** Set the value returned by cursorPosition().
+     */
+    void setCursorPosition(const DcUtil::Vec2<int>& position);
+
+    /** Get the number of times refresh() has been called.
+     */
+    uint64_t refreshCount() const { return refreshes; }
+
+    ShellStatus items(ShellItemSet set, std::unique_ptr<ShellItemEnumerator>& enumOut) override;
+    ShellStatus displayName(DcUtil::ItemIdView itemid, ShellNameKind kind, std::wstring& nameOut) const override;
+    ShellStatus itemPosition(DcUtil::ItemIdView itemid, DcUtil::Vec2<int>& positionOut) const override;
+    ShellStatus positionItems(size_t count, const DcUtil::ItemIdView* itemids, const DcUtil::Vec2<int>* points) override;
+    ShellStatus spacing(DcUtil::Vec2<int>& spacingOut) const override;
+    ShellStatus folderFlags(FolderFlags& flagsOut) const override;
+    DcUtil::Vec2<int> desktopResolution() const override;
+    int monitorCount() const override;
+    int systemDpi() const override;
+    DcUtil::Vec2<int> cursorPosition() const override;
+    void refresh() override;
+    void subscribeChanges() override;
+    void unsubscribeChanges() override;
+    size_t pollChanges(const std::function<void(const ShellChange&)>& handler) override;
+
+    /** Used internally: Counts a call and waits for its simulated latency.
+     *
+     *  @param items Number of items handled by the call.
+     */
+    void simulateCall(ShellCall call, size_t items) const;
+
+    /** Used internally: Writes the item ID of an item to itemidOut, reusing its storage.
+     *
+     *  @return False if id isn't an item on the desktop, in which case itemidOut is unchanged.
+     */
+    bool createItemID(uint32_t id, DcUtil::ItemId& itemidOut) const;
+
+    /** Copy constructor is disabled.
+     */
+    MemoryShellBackend(const MemoryShellBackend&) = delete;
+
+    /** Copy assignment operator is disabled.
+     */
+    void operator=(const MemoryShellBackend&) = delete;
+
+private:
+    struct Item
+    {
+        std::wstring name;
+        DcUtil::Vec2<int> position;
+        uint32_t version;       // Changed when the item ID's bytes would change (rename or edit).
+        bool selected;
+    };
+
+    // Returns the item an item ID refers to, or nullptr if it doesn't refer to a current item.
+    const Item* findItem(DcUtil::ItemIdView itemid) const;
+    Item* findItem(DcUtil::ItemIdView itemid);
+
+    // Queues a change to item id, with its current item ID, if subscribed.
+    void queueChange(DesktopChangeType type, uint32_t id, const std::wstring& name, const std::wstring& newName);
+
+    // Item IDs of the desktop, in enumeration order.
+    std::vector<uint32_t> order;
+    std::unordered_map<uint32_t, Item> itemsById;
+    uint32_t nextId;
+
+    ShellCallLatency latencies[static_cast<size_t>(ShellCall::Count)];
+    mutable uint64_t callCounts[static_cast<size_t>(ShellCall::Count)];
+
+    DcUtil::Vec2<int> resolution;
+    int monitors;
+    int dpi;
+    DcUtil::Vec2<int> iconSpacing;
+    FolderFlags flags;
+    DcUtil::Vec2<int> cursor;
+    uint64_t refreshes;
+
+    bool watching;
+    std::deque<ShellChange> changes;
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "DesktopController.h"
+
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <chrono>
+#include <functional>
+
+/** @brief Repositions icons asynchronously on a dedicated thread.
+ *
+ *  Repositioning icons is expensive and blocks the caller for the duration of the call in to the Shell.
+ *  RepositionWorker queues requests instead and applies them from its own thread, which has its own
+ *  ShellBackend and DesktopController. The backend is created on the worker thread, so a ComShellBackend
+ *  gets its own COM apartment.
+ *
+ *  Queued requests are coalesced: if an icon is repositioned several times before the worker gets to it,
+ *  only the latest position is applied. All pending requests are submitted together in one batch per tick.
+ */
+class RepositionWorker
+{
+public:
+    /** Creates the backend the worker thread moves icons through. Called once, on the worker thread.
+     */
+    using BackendFactory = std::function<std::shared_ptr<ShellBackend>()>;
+
+#ifdef _WIN32
+    /** Constructor. Starts the worker thread, which accesses the desktop shown by Explorer through a ComShellBackend.
+     *
+     *  @param ticksPerSecond Maximum number of batches submitted per second. Must be more than 0.
+     */
+    explicit RepositionWorker(double ticksPerSecond = 25.0);
+#endif
+
+    /** Constructor. Starts the worker thread, which accesses the desktop through the backend returned by makeBackend.
+     *
+     *  The icons passed to reposition() and repositionIcons() must come from a DesktopController whose backend
+     *  recognises the same item IDs, e.g. a MemoryShellBackend shared with it (see ShellBackend).
+     *
+     *  @param makeBackend Called on the worker thread to create its backend. Must not return null.
+     *  @param ticksPerSecond Maximum number of batches submitted per second. Must be more than 0.
+     */
+    explicit RepositionWorker(BackendFactory makeBackend, double ticksPerSecond = 25.0);
+
+    /** Destructor. Applies any requests still pending, then stops the worker thread.
+     */
+    ~RepositionWorker();
+
+    /** Queue a new position for an icon.
+     *
+     *  @param icon The icon to move. The worker keeps its own copy of the icon's item ID, so icon
+     *              doesn't need to outlive the request.
+     *  @param point The new upper left coordinates of the icon.
+     *  @return A future which becomes ready once the batch containing this icon has been applied, or 
+     *          holds the exception thrown if that failed. If a later request for the same icon supersedes 
+     *          this one, the future completes with the later request.
+     */
+    std::future<void> reposition(const DesktopIcon& icon, const DcUtil::Vec2<int>& point);
+
+    /** Queue new positions for several icons. Both parameters must have the same number of elements.
+     *
+     *  @return A future which becomes ready once all of the icons have been repositioned.
+     *  @see reposition()
+     */
+    std::future<void> repositionIcons(const std::vector<DesktopIcon*>& icons, const std::vector<DcUtil::Vec2<int>>& points);
+
+    /** Submit pending requests without waiting for the next tick and block until they've been applied.
+     */
+    void flush();
+
+    /** Get the number of icons waiting to be repositioned.
+     */
+    size_t pendingCount() const;
+
+    /** Copy constructor is disabled.
+     */
+    RepositionWorker(const RepositionWorker&) = delete;
+
+    /** Copy assignment operator is disabled.
+     */
+    void operator=(const RepositionWorker&) = delete;
+
+private:
+    using Waiter = std::shared_ptr<std::promise<void>>;
+
+    struct Request
+    {
+        DcUtil::ItemId itemid;
+        DcUtil::Vec2<int> point;
+        std::vector<Waiter> waiters;
+    };
+
+    // Adds or coalesces a request. mutex must be held.
+    void enqueue(const DesktopIcon& icon, const DcUtil::Vec2<int>& point, const Waiter& waiter);
+
+    void run(BackendFactory makeBackend, std::promise<void> started);
+
+    std::chrono::steady_clock::duration tickInterval;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;       // Signalled when requests are queued, on flush() and on destruction.
+    std::condition_variable applied;    // Signalled after each batch is applied.
+
+    // Pending requests, keyed by DesktopIcon::key().
+    std::unordered_map<uint64_t, Request> pending;
+    bool batchInFlight;
+    bool flushRequested;
+    bool stopping;
+
+    std::thread thread;
+};
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <functional>
+#include <stdexcept>
+#include <cstdint>
+
+#include "Util.h"
+
+/** Result of a ShellBackend call. Values are those of the HRESULT the Shell would return: 
+ *  0 or more is success and negative values are errors.
+ */
+using ShellStatus = int32_t;
+
+const ShellStatus shellOk = 0;                                                  /**< Success (S_OK). */
+const ShellStatus shellFalse = 1;                                               /**< Success with fewer results than requested (S_FALSE). */
+const ShellStatus shellPointerError = static_cast<ShellStatus>(0x80004003);     /**< A required pointer was null (E_POINTER). */
+const ShellStatus shellFailure = static_cast<ShellStatus>(0x80004005);          /**< Unspecified failure (E_FAIL). */
+const ShellStatus shellInvalidArgument = static_cast<ShellStatus>(0x80070057);  /**< E.g. an item ID which doesn't refer to an item (E_INVALIDARG). */
+
+/** Returns true if status is a success code.
+ */
+inline bool shellSucceeded(ShellStatus status)
+{
+    return status >= 0;
+}
+
+/** @brief Thrown when a call in to the Shell fails.
+ */
+class ShellError : public std::runtime_error
+{
+public:
+    /** Constructor.
+     *
+     *  @param function Name of the Shell function which failed. It's included in the message.
+     *  @param status The status returned by the function.
+     */
+    ShellError(const std::string& function, ShellStatus status);
+
+    /** Get the status returned by the function which failed.
+     */
+    ShellStatus status() const { return code; }
+
+private:
+    ShellStatus code;
+};
+
+/** @brief Flags returned by DesktopController::folderFlags().
+ */
+struct FolderFlags
+{
+    bool autoArrange = false;  /**< True if the desktop has autoarrange enabled. */
+    bool snapToGrid = false;   /**< True if the desktop has align/snap to grid enabled. */
+};
+
+/** @brief Selects which items ShellBackend::items() enumerates.
+ */
+enum class ShellItemSet
+{
+    All,        /**< Every item in the view (SVGIO_ALLVIEW). */
+    Selection   /**< Only the selected items (SVGIO_SELECTION). */
+};
+
+/** @brief Selects which name ShellBackend::displayName() returns.
+ */
+enum class ShellNameKind
+{
+    Display,    /**< The name shown under the icon (SHGDN_NORMAL), which may hide the extension. */
+    Parsing     /**< The item's file name relative to the desktop, including any extension (SHGDN_INFOLDER | SHGDN_FORPARSING). */
+};
+
+/** @brief Kinds of change reported by ShellBackend::pollChanges() and DesktopController::subscribeChanges().
+ */
+enum class DesktopChangeType
+{
+    Added,      /**< An item was created on the desktop. */
+    Removed,    /**< An item was deleted from the desktop. */
+    Renamed,    /**< An item was renamed. */
+    Moved,      /**< An item was moved by other means than the backend, e.g. by the user. */
+    Updated     /**< The desktop folder changed in a way which isn't described by the other types. */
+};
+
+/** @brief A change to an item in the view, reported by ShellBackend::pollChanges().
+ */
+struct ShellChange
+{
+    DesktopChangeType type;  /**< Kind of change. */
+    DcUtil::ItemId itemid;   /**< The item's ID. For Removed and Renamed, the ID it had, which no longer refers to it. Empty for Updated or if unknown. */
+    std::wstring name;       /**< Display name of the item. For Removed and Renamed, the old name, which is often empty since the Shell can't name an item once it's gone. */
+    std::wstring newName;    /**< New display name of the item if type is Renamed, otherwise empty. */
+};
+
+/** @brief Iterates over the item IDs of a view, returned by ShellBackend::items().
+ */
+class ShellItemEnumerator
+{
+public:
+    /** Destructor.
+     */
+    virtual ~ShellItemEnumerator() {}
+
+    /** Fetch the next item IDs, as IEnumIDList::Next.
+     *
+     *  @param itemids Array of count item IDs which receive the item IDs fetched. Their previous contents are
+     *                 replaced, so the caller can reuse them (and their storage) from one call to the next.
+     *  @param count Maximum number of item IDs to fetch.
+     *  @param fetched Receives the number of item IDs fetched.
+     *  @return shellOk if count item IDs were fetched, shellFalse if fewer were (the end was reached), or an error.
+     */
+    virtual ShellStatus next(DcUtil::ItemId* itemids, size_t count, size_t& fetched) = 0;
+};
+
+/** @brief The Shell operations DesktopController uses to access desktop icons.
+ *
+ *  DesktopController makes every call in to the Shell through a ShellBackend. ComShellBackend
+ *  (Windows only) talks to the desktop shown by Explorer. MemoryShellBackend simulates a desktop in 
+ *  memory, so the controller's logic can run, be tested and be benchmarked on any platform.
+ *
+ *  Item IDs passed to a backend must have been returned by the same backend. Per-item functions
+ *  report failures by ShellStatus so the caller can decide whether to throw. The remaining functions
+ *  throw std::runtime_error.
+ */
+class ShellBackend
+{
+public:
+    /** Destructor.
+     */
+    virtual ~ShellBackend() {}
+
+    /** Start enumerating the items in the view, as IFolderView::Items.
+     *
+     *  @param set Selects which items are enumerated.
+     *  @param enumOut Receives the enumerator. May be left null on success if there are no items to enumerate.
+     *  @return shellOk on success, otherwise an error.
+     */
+    virtual ShellStatus items(ShellItemSet set, std::unique_ptr<ShellItemEnumerator>& enumOut) = 0;
+
+    /** Get the name of an item, as IShellFolder::GetDisplayNameOf.
+     *
+     *  @param itemid Item ID relative to the desktop folder.
+     *  @param kind Selects which name is returned.
+     *  @param nameOut Receives the name as a UTF-16 encoded Unicode string.
+     *  @return shellOk on success, otherwise an error.
+     */
+    virtual ShellStatus displayName(DcUtil::ItemIdView itemid, ShellNameKind kind, std::wstring& nameOut) const = 0;
+
+    /** Get the upper left coordinates of an item, as IFolderView::GetItemPosition.
+     */
+    virtual ShellStatus itemPosition(DcUtil::ItemIdView itemid, DcUtil::Vec2<int>& positionOut) const = 0;
+
+    /** Move count items in a single batch, as IFolderView::SelectAndPositionItems with SVSI_POSITIONITEM.
+     *
+     *  @param count Number of elements of itemids and points.
+     *  @param itemids The items to move.
+     *  @param points The new upper left coordinates of each respective item.
+     */
+    virtual ShellStatus positionItems(size_t count, const DcUtil::ItemIdView* itemids, const DcUtil::Vec2<int>* points) = 0;
+
+    /** Get the dimensions of an icon including surrounding whitespace, as IFolderView::GetSpacing.
+     */
+    virtual ShellStatus spacing(DcUtil::Vec2<int>& spacingOut) const = 0;
+
+    /** Get the view's auto arrange and snap to grid settings, as IShellView::GetCurrentInfo.
+     */
+    virtual ShellStatus folderFlags(FolderFlags& flagsOut) const = 0;
+
+    /** Get the resolution of the desktop in pixels.
+     */
+    virtual DcUtil::Vec2<int> desktopResolution() const = 0;
+
+    /** Get the number of display monitors attached to the desktop.
+     */
+    virtual int monitorCount() const = 0;
+
+    /** Get the system DPI, e.g. 96 at 100% scaling.
+     */
+    virtual int systemDpi() const = 0;
+
+    /** Get the position of the cursor in pixels.
+     */
+    virtual DcUtil::Vec2<int> cursorPosition() const = 0;
+
+    /** Notify the system that the contents of the desktop folder has changed.
+     */
+    virtual void refresh() = 0;
+
+    /** Start queueing changes to the items in the view, to be read with pollChanges(). Calling this 
+     *  again while subscribed has no effect. Throws std::runtime_error if changes can't be watched.
+     *
+     *  ComShellBackend registers for Shell change notifications, which are queued on the calling thread.
+     *  The Shell doesn't notify moves, so it never reports DesktopChangeType::Moved.
+     */
+    virtual void subscribeChanges() = 0;
+
+    /** Stop queueing changes and discard any not yet read. Calling this while not subscribed has no effect.
+     */
+    virtual void unsubscribeChanges() = 0;
+
+    /** Pass each change queued since the last call to handler, oldest first. This doesn't block. 
+     *  handler may call unsubscribeChanges(), after which no more changes are passed.
+     *
+     *  @return The number of changes passed to handler.
+     */
+    virtual size_t pollChanges(const std::function<void(const ShellChange&)>& handler) = 0;
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <utility>
+#include <chrono>
+
+// Records the latency of every call in to the Shell made by DesktopController and DesktopIcon.
+// Recording costs two clock reads and a few relaxed atomic increments per call, which is negligible 
+// next to the calls themselves. Change to #if 0 to compile the timing out entirely; the query 
+// functions then return empty statistics.
+#if 1
+#define ENABLE_SHELL_CALL_METRICS
+#endif
+
+/** @brief Shell calls whose latency is recorded.
+ */
+enum class ShellCall
+{
+    Items,                  /**< IFolderView::Items, once per enumeration. */
+    Next,                   /**< IEnumIDList::Next, once per batch of item IDs fetched. */
+    GetItemPosition,        /**< IFolderView::GetItemPosition. */
+    SelectAndPositionItems, /**< IFolderView::SelectAndPositionItems, once per batch of icons moved. */
+    GetDisplayNameOf,       /**< IShellFolder::GetDisplayNameOf. */
+    Count                   /**< Number of call types. Not a call type itself. */
+};
+
+/** @brief Latency statistics of one type of Shell call, returned by shellCallStats().
+ *
+ *  Latencies are recorded in a log-linear histogram (as HdrHistogram does): values below 16ns are
+ *  exact, and above that each power of 2 is split in to 16 buckets, so values are accurate to within 1/16 (6.25%).
+ */
+struct ShellCallStats
+{
+    uint64_t count = 0;              /**< Number of calls recorded. */
+    uint64_t totalNanoseconds = 0;   /**< Sum of the latencies of every call. */
+    uint64_t minNanoseconds = 0;     /**< Lowest latency recorded, or 0 if count is 0. */
+    uint64_t maxNanoseconds = 0;     /**< Highest latency recorded, or 0 if count is 0. */
+
+    /** Non-empty histogram buckets in ascending order. 
+     *  Each element holds the highest latency (in nanoseconds) which falls in the bucket, and the number of calls in it.
+     */
+    std::vector<std::pair<uint64_t, uint64_t>> buckets;
+
+    /** Get the mean latency in nanoseconds, or 0 if no calls were recorded.
+     */
+    double meanNanoseconds() const;
+
+    /** Get the latency in nanoseconds which the given percentage of calls took no longer than.
+     *
+     *  @param percentile In the range 0-100, e.g. 99.9.
+     *  @return The latency, accurate to the histogram's resolution, or 0 if no calls were recorded.
+     */
+    uint64_t percentileNanoseconds(double percentile) const;
+};
+
+/** Get the latency statistics recorded for a type of Shell call since the process started
+ *  or resetShellCallStats() was last called. Safe to call from any thread.
+ *
+ *  @param call The type of Shell call.
+ */
+ShellCallStats shellCallStats(ShellCall call);
+
+/** Discard all recorded Shell call statistics.
+ *  Calls which are being recorded at the same time may be partially discarded.
+ */
+void resetShellCallStats();
+
+/** Used internally: Adds a latency measurement to the statistics of a type of Shell call.
+ */
+void recordShellCall(ShellCall call, uint64_t nanoseconds);
+
+/** Used internally: Calls f and records how long it took under the given call type.
+ *
+ *  @return The value returned by f.
+ */
+template <typename F>
+auto timeShellCall(ShellCall call, F&& f) -> decltype(f())
+{
+#ifdef ENABLE_SHELL_CALL_METRICS
+    struct Timer
+    {
+        ShellCall call;
+        std::chrono::steady_clock::time_point start;
+
+        ~Timer()
+        {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            recordShellCall(call, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    } timer{ call, std::chrono::steady_clock::now() };
+#else
+    (void)call;
+#endif
+
+    return f();
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Util.h"
+
+#include <vector>
+#include <cstdint>
+
+/** @brief Result of assignSlots().
+ */
+struct SlotAssignment
+{
+    static const size_t unassigned = static_cast<size_t>(-1);  /**< Slot index used for icons which weren't given a slot. */
+
+    /** The slot assigned to each icon, as an index in to the slots passed to assignSlots(), or unassigned 
+     *  if there were fewer slots than icons. 
+     */
+    std::vector<size_t> slotOf;
+
+    /** Indices of the icons which have to move to reach their slot, in ascending order.
+     */
+    std::vector<size_t> moved;
+
+    /** Sum of the distances (rounded to whole pixels) between each assigned icon and its slot.
+     */
+    int64_t totalDistance = 0;
+};
+
+/** Assign icons to slots so that the total distance the icons move is as small as possible.
+ *
+ *  This suits tidying icons in to a grid: icons which are already at or near a slot keep it, rather than
+ *  being shuffled along as they would be if slots were handed out in enumeration order.
+ *
+ *  The assignment is computed with Bertsekas' auction algorithm with epsilon scaling, and is optimal for 
+ *  distances rounded to whole pixels. Only the smaller side bids: icons bid for slots, or, when there are 
+ *  fewer slots than icons, slots bid for icons. Surplus slots are left empty and surplus icons are left
+ *  unassigned, chosen so that the total distance is still minimal. A reverse auction step keeps the result
+ *  optimal when the sides differ in size.
+ *  Each bid only looks at a short list of candidate slots (or icons, when slots bid), starting with the
+ *  nearest, and a grid finds more when something outside the list could be a better choice. A bid usually
+ *  costs O(k) for k candidates rather than O(n) for n = max(icons, slots), and memory is O(m k + n) for
+ *  m = min(icons, slots), so many spare slots are cheap and no m by n matrix of distances is kept however
+ *  large the desktop.
+ *
+ *  @param positions The current upper left coordinates of each icon.
+ *  @param slots The upper left coordinates of each slot.
+ *  @return The slot assigned to each icon and the icons which have to move.
+ */
+SlotAssignment assignSlots(const std::vector<DcUtil::Vec2<int>>& positions, const std::vector<DcUtil::Vec2<int>>& slots);
@@ -1,7 +1,9 @@
 #pragma once
 
-#include <Windows.h>
 #include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
 
 /** @brief A namespace for any utility-like functionality.
  */
@@ -132,6 +134,20 @@ namespace DcUtil
             return *this;
         }
 
+        /** Equality operator overload. Compares both components.
+         */
+        bool operator==(const Vec2<T>& v) const
+        {
+            return x == v.x && y == v.y;
+        }
+
+        /** Inequality operator overload.
+         */
+        bool operator!=(const Vec2<T>& v) const
+        {
+            return !(*this == v);
+        }
+
         /** Subscript operator overload.
          *
          *  @param i Index of component to return.
@@ -151,6 +167,92 @@ namespace DcUtil
         T data[2];   /**< Array containing the first and second components. */ 
     };
 
+    /** An item ID: the bytes which identify an item to the ShellBackend which returned it. 
+     *  For ComShellBackend these are the bytes of an ITEMID_CHILD, including its terminator.
+     */
+    using ItemId = std::vector<uint8_t>;
+
+    /** @brief The bytes of an item ID which are owned elsewhere, e.g. by an ItemId or a DesktopSnapshot.
+     *
+     *  This is how item IDs are passed to a ShellBackend, so item IDs stored back to back in one buffer 
+     *  don't have to be copied out first. The bytes must outlive the view.
+     */
+    class ItemIdView
+    {
+    public:
+        /** Default constructor. Constructs an empty view.
+         */
+        ItemIdView() 
+            : bytes(nullptr)
+            , length(0) {}
+
+        /** Constructor which views the bytes of an ItemId.
+         */
+        ItemIdView(const ItemId& itemid) 
+            : bytes(itemid.data())
+            , length(itemid.size()) {}
+
+        /** Constructor which views size bytes starting at data.
+         */
+        ItemIdView(const uint8_t* data, size_t size) 
+            : bytes(data)
+            , length(size) {}
+
+        /** Get a pointer to the first byte.
+         */
+        const uint8_t* data() const { return bytes; }
+
+        /** Get the number of bytes.
+         */
+        size_t size() const { return length; }
+
+        /** Returns true if the view has no bytes.
+         */
+        bool empty() const { return length == 0; }
+
+        /** Make an ItemId holding a copy of the bytes.
+         */
+        ItemId copy() const { return ItemId(bytes, bytes + length); }
+
+        /** Returns true if both views hold the same bytes.
+         */
+        bool operator==(const ItemIdView& other) const;
+
+        /** Returns true if the views hold different bytes.
+         */
+        bool operator!=(const ItemIdView& other) const { return !(*this == other); }
+
+    private:
+        const uint8_t* bytes;
+        size_t length;
+    };
+
+    /** Compute the 64-bit FNV-1a hash of a block of memory.
+     *
+     *  FNV-1a is fast and distributes well but isn't collision resistant, so it must not be 
+     *  relied on where an attacker controls the input.
+     *
+     *  @param data Pointer to the first byte to hash.
+     *  @param size Number of bytes to hash.
+     *  @return The hash value.
+     */
+    uint64_t hashBytes(const void* data, size_t size);
+
+    /** Compute a 64-bit identity key for a desktop icon from the bytes of its item ID.
+     *
+     *  The key is stable for as long as the item ID's bytes are. Virtual items (e.g. the Recycle Bin)
+     *  have fixed item IDs. Item IDs of files and folders embed the file name and, depending on the 
+     *  version of Windows, some file attributes, so their keys change when the file is renamed and 
+     *  may change when it's modified.
+     *
+     *  Keys are a 64-bit hash, so distinct icons can collide. The probability of any collision 
+     *  among n icons is approximately n^2 / 2^65 (around 3e-10 for 100,000 icons).
+     *
+     *  @param itemid Item ID relative to the desktop folder.
+     *  @return The identity key.
+     */
+    uint64_t itemIdKey(ItemIdView itemid);
+
 #if 0
     /** Return a random integer in the range min-max (inclusive).
      *
@@ -164,16 +266,48 @@ namespace DcUtil
      * 
      * Desktop icon display names are encoded as UTF-16 Unicode. These characters aren't
      * supported easily by the Win32 console. This function approximates the Unicode characters
-     * for display in the console.
+     * for display in the console. Elsewhere consoles expect UTF-8, so the string is converted to UTF-8.
      *
      *  @param s UTF-16 Unicode string.
      *  @return OEM approximation of the UTF-16 Unicode input.
      */
     std::string wstringToOem(const std::wstring& s);
 
+    /** Converts a string of wide characters (UTF-16, or UTF-32 where wchar_t is 4 bytes) to UTF-8.
+     *  Unpaired surrogates are replaced with U+FFFD.
+     */
+    std::string wstringToUtf8(const std::wstring& s);
+
+    /** Converts a string of wide characters to UTF-16 code units. Where wchar_t is 2 bytes this is a copy, 
+     *  otherwise characters outside the Basic Multilingual Plane become surrogate pairs.
+     */
+    std::u16string wstringToUtf16(const std::wstring& s);
+
+    /** Converts UTF-16 code units to a string of wide characters. The reverse of wstringToUtf16().
+     *
+     *  @param s Pointer to the first code unit.
+     *  @param length Number of code units.
+     */
+    std::wstring utf16ToWstring(const char16_t* s, size_t length);
+
+#ifdef _WIN32
+    /** Get the system message for a Win32 error code or HRESULT, with line breaks removed.
+     *
+     *  @param id Error code, e.g. from GetLastError().
+     *  @return The message, or an empty string if the system has no message for id.
+     */
+    std::string errorIdToMessage(unsigned long id);
+
+    /** Throw a std::runtime_error describing the calling thread's last error (see GetLastError()).
+     *
+     *  @param function Name of the function which failed. It's included in the message.
+     */
+    void throwLastError(const std::string& function);
+
     /** Find the location of the user's desktop directory.
      *
      *  @return Full path of the desktop directory as a Unicode string.
      */
     std::wstring desktopDirectory();
+#endif
 };
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "AdaptiveChunker.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace
+{
+    // Factor the chunk size is grown or shrunk by per step. The factor is reduced each time the
+    // direction reverses, so the size settles near the optimum instead of oscillating around it.
+    const double initialStep = 1.5;
+    const double minStep = 1.1;
+
+    // Cost per item must be this much worse than the best seen before the direction is reversed, so timing noise
+    // doesn't cause the size to flip back and forth.
+    const double worseThreshold = 1.05;
+
+    // Chunks which exceed maxStall are shrunk to this fraction of the size predicted to fit.
+    const double stallMargin = 0.8;
+}
+
+const size_t AdaptiveChunker::defaultChunkSize;
+
+AdaptiveChunker::AdaptiveChunker(const ChunkingOptions& optionsArg, size_t initialChunkSize)
+    : options(optionsArg)
+    , growing(true)
+    , step(initialStep)
+    , haveBest(false)
+    , bestSize(0)
+    , bestCostPerItem(0.0)
+{
+    if (options.minChunkSize == 0 || options.maxChunkSize < options.minChunkSize)
+        throw runtime_error("Invalid chunk size limits in ChunkingOptions");
+
+    if (options.maxStall <= steady_clock::duration::zero())
+        throw runtime_error("ChunkingOptions::maxStall must be more than 0");
+
+    size_t initial = (options.initialChunkSize != 0 ? options.initialChunkSize : initialChunkSize);
+    size = min(max(initial, options.minChunkSize), options.maxChunkSize);
+}
+
+void AdaptiveChunker::record(size_t count, steady_clock::duration elapsed)
+{
+    if (count == 0)
+        return;
+
+    const double seconds = max(duration_cast<duration<double>>(elapsed).count(), 1e-9);
+    const double maxStallSeconds = duration_cast<duration<double>>(options.maxStall).count();
+    const double costPerItem = seconds / count;
+
+    // Largest chunk predicted to fit in maxStall, assuming the cost is linear around count.
+    const double fits = count * maxStallSeconds / seconds;
+
+    double next;
+    if (seconds > maxStallSeconds)
+    {
+        next = fits * stallMargin;
+        growing = false;
+        step = initialStep;
+    }
+    else if (count < size)
+    {
+        // A short chunk says little about the cost of a full one.
+        return;
+    }
+    else
+    {
+        // Measuring the best size again refreshes its cost, so the best isn't stuck at a 
+        // measurement taken when the Shell was less busy.
+        if (!haveBest || costPerItem < bestCostPerItem || count == bestSize)
+        {
+            bestCostPerItem = costPerItem;
+            bestSize = count;
+        }
+
+        double base = static_cast<double>(size);
+        if (costPerItem > bestCostPerItem * worseThreshold)
+        {
+            // Overshot the optimum. Head back past the best size with a smaller step.
+            growing = !growing;
+            step = max(1.0 + (step - 1.0) / 2.0, minStep);
+            base = static_cast<double>(bestSize);
+        }
+
+        next = nextSize(base, fits);
+
+        // A size limit (or maxStall) stops the size moving in this direction, which would otherwise measure 
+        // the same size indefinitely. Explore the other direction instead.
+        if (static_cast<size_t>(clampSize(next)) == size)
+        {
+            growing = !growing;
+            next = nextSize(base, fits);
+        }
+
+        haveBest = true;
+    }
+
+    size = static_cast<size_t>(clampSize(next));
+}
+
+double AdaptiveChunker::nextSize(double base, double fits) const
+{
+    return min(growing ? base * step + 1.0 : base / step, fits);
+}
+
+double AdaptiveChunker::clampSize(double s) const
+{
+    return min(max(s, static_cast<double>(options.minChunkSize)), static_cast<double>(options.maxChunkSize));
+}
@@ -0,0 +1,36 @@
+#ifdef PYBIND11_BUILD
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <pybind11/chrono.h>
+
+#include "AdaptiveChunker.h"
+
+namespace py = pybind11;
+
+void InitAdaptiveChunker_pybind11(py::module& m)
+{
+    py::class_<ChunkingOptions>(m, "ChunkingOptions")
+        .def(py::init<>())
+        .def_readwrite("initialChunkSize", &ChunkingOptions::initialChunkSize)
+        .def_readwrite("minChunkSize", &ChunkingOptions::minChunkSize)
+        .def_readwrite("maxChunkSize", &ChunkingOptions::maxChunkSize)
+        .def_readwrite("maxStall", &ChunkingOptions::maxStall);
+
+    py::class_<ChunkTiming>(m, "ChunkTiming")
+        .def_readonly("first", &ChunkTiming::first)
+        .def_readonly("count", &ChunkTiming::count)
+        .def_readonly("elapsed", &ChunkTiming::elapsed);
+
+    py::class_<ChunkedRepositionReport>(m, "ChunkedRepositionReport")
+        .def_readonly("chunks", &ChunkedRepositionReport::chunks)
+        .def_readonly("total", &ChunkedRepositionReport::total)
+        .def_readonly("longestStall", &ChunkedRepositionReport::longestStall);
+
+    // Exposed so chunk sizing can be tried out against a simulated cost model.
+    py::class_<AdaptiveChunker>(m, "AdaptiveChunker")
+        .def(py::init<const ChunkingOptions&, size_t>(), py::arg("options"), py::arg("initialChunkSize") = AdaptiveChunker::defaultChunkSize)
+        .def("chunkSize", &AdaptiveChunker::chunkSize, "Size the next chunk should be.")
+        .def("record", &AdaptiveChunker::record, "Record the time taken by a chunk and choose the size of the next one.");
+}
+
+#endif
@@ -0,0 +1,505 @@
+#include "ComShellBackend.h"
+
+#include <exdisp.h>
+#include <shlwapi.h>
+#include <atlalloc.h>
+#include <ShellScalingApi.h>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace DcUtil;
+
+namespace
+{
+    // The Shell's item IDs are passed by pointer to their first byte.
+    PCUITEMID_CHILD toItemIdPointer(ItemIdView itemid)
+    {
+        return reinterpret_cast<PCUITEMID_CHILD>(itemid.data());
+    }
+
+    // Adapts an IEnumIDList to ShellItemEnumerator, copying each item ID the Shell allocates in to the caller's.
+    class ComItemEnumerator : public ShellItemEnumerator
+    {
+    public:
+        explicit ComItemEnumerator(CComPtr<IEnumIDList> idlistArg)
+            : idlist(idlistArg)
+        {
+        }
+
+        ShellStatus next(ItemId* itemids, size_t count, size_t& fetched) override
+        {
+            fetchedIds.assign(count, nullptr);
+
+            ULONG fetchedCount = 0;
+            HRESULT result = idlist->Next(static_cast<ULONG>(count), fetchedIds.data(), &fetchedCount);
+            fetched = SUCCEEDED(result) ? fetchedCount : 0;
+
+            for (size_t i = 0; i < fetched; ++i)
+            {
+                // ILGetSize includes the terminating null SHITEMID.
+                const BYTE* bytes = reinterpret_cast<const BYTE*>(fetchedIds[i]);
+                itemids[i].assign(bytes, bytes + ILGetSize(fetchedIds[i]));
+                CoTaskMemFree(fetchedIds[i]);
+            }
+
+            return result;
+        }
+
+    private:
+        CComPtr<IEnumIDList> idlist;
+        std::vector<PITEMID_CHILD> fetchedIds;
+    };
+
+    // Display name of an item given its absolute item ID, or an empty string if the name can't be retrieved 
+    // (e.g. the item has been deleted and is no longer known to the Shell).
+    wstring absoluteItemName(PCIDLIST_ABSOLUTE pidl)
+    {
+        CComHeapPtr<wchar_t> name;
+        if (!pidl || !SUCCEEDED(SHGetNameFromIDList(pidl, SIGDN_NORMALDISPLAY, &name)))
+            return wstring();
+        return wstring(name);
+    }
+
+    // The last item ID of an absolute item ID, which is the child item ID the desktop folder knows the item by.
+    ItemId childItemId(PCIDLIST_ABSOLUTE pidl)
+    {
+        if (!pidl)
+            return ItemId();
+
+        PCUITEMID_CHILD child = ILFindLastID(pidl);
+        const BYTE* bytes = reinterpret_cast<const BYTE*>(child);
+        return ItemId(bytes, bytes + ILGetSize(child));
+    }
+
+    std::pair<DWORD, DWORD> getWindowsVersion()
+    {
+        OSVERSIONINFOEXW os;
+
+        typedef void (WINAPI* RtlGetVersion_FUNC) (OSVERSIONINFOEXW*);
+        RtlGetVersion_FUNC RtlGetVersion_DLL;
+
+        HMODULE hmod = LoadLibrary(TEXT("ntdll.dll"));
+        if (hmod)
+        {
+            RtlGetVersion_DLL = (RtlGetVersion_FUNC)GetProcAddress(hmod, "RtlGetVersion");
+            if (RtlGetVersion_DLL == NULL)
+            {
+                FreeLibrary(hmod);
+                throw runtime_error("Failed to get pointer to RtlGetVersion.");
+            }
+            ZeroMemory(&os, sizeof(os));
+            os.dwOSVersionInfoSize = sizeof(os);
+            RtlGetVersion_DLL(&os);
+        }
+        else
+        {
+            throw runtime_error("Failed to load ntdll.dll.");
+        }
+
+        FreeLibrary(hmod);
+
+        return make_pair(os.dwMajorVersion, os.dwMinorVersion);
+    }
+
+    bool Win81OrNewer()
+    {
+        DWORD majorVersion, minorVersion;
+        std::tie(majorVersion, minorVersion) = getWindowsVersion();
+
+        if (majorVersion == 6 && minorVersion >= 3)
+            return true;
+        else if (majorVersion > 6)
+            return true;
+        return false;
+    }
+
+    // This is done programmatically here (not in the manifest) because manifests are typically
+    // only applied to .exe. There may well be ways to embded a manifest in the .lib or .dll but
+    // for now this works.
+    // TODO: DPI awareness should be set in the manifest. Need to work out the details since this is compiled in 
+    // to a static and shared library.
+    void SetHighDpiAwareness()
+    {
+        // At least Windows 8.1 is required to load Shcore.dll (for Set/GetProcessDpiAwareness).
+        // TODO: Is setting DPI awareness necessary (or even possible) on earlier Windows versions?
+        if (Win81OrNewer())
+        {
+            HINSTANCE hinst = LoadLibrary(L"Shcore.dll");
+
+            if (hinst != NULL)
+            {
+                typedef HRESULT(STDAPICALLTYPE* GET_DPI_AWARE_PROC)(HANDLE, PROCESS_DPI_AWARENESS*);
+                typedef HRESULT(STDAPICALLTYPE* SET_DPI_AWARE_PROC)(PROCESS_DPI_AWARENESS);
+
+                GET_DPI_AWARE_PROC GetProcessDpiAwareness_DLL =
+                    (GET_DPI_AWARE_PROC)GetProcAddress(hinst, "GetProcessDpiAwareness");
+
+                SET_DPI_AWARE_PROC SetProcessDpiAwareness_DLL =
+                    (SET_DPI_AWARE_PROC)GetProcAddress(hinst, "SetProcessDpiAwareness");
+
+                PROCESS_DPI_AWARENESS dpiAwareness;
+
+                if (NULL != GetProcessDpiAwareness_DLL)
+                {
+                    HRESULT result = GetProcessDpiAwareness_DLL(NULL, &dpiAwareness);
+
+                    if (!SUCCEEDED(result))
+                        throw ShellError("GetProcessDpiAwareness_DLL", result);
+                }
+                else
+                {
+                    throw runtime_error("Failed to load GetProcessDpiAwareness_DLL from Shcore.dll");
+                }
+
+                if (NULL != SetProcessDpiAwareness_DLL)
+                {
+                    if (dpiAwareness == PROCESS_DPI_UNAWARE)
+                    {
+                        // Set DPI awareness for 1-to-1 pixel control.
+                        HRESULT result = SetProcessDpiAwareness_DLL(PROCESS_SYSTEM_DPI_AWARE);
+                        if (result == E_INVALIDARG)
+                            throw ShellError("SetProcessDpiAwareness", result);
+                    }
+                }
+                else
+                {
+                    throw runtime_error("Failed to load SetProcessDpiAwareness from Shcore.dll");
+                }
+
+                if (!FreeLibrary(hinst))
+                    throwLastError("FreeLibrary");
+            }
+            else
+            {
+                throw runtime_error("LoadLibrary failed to load Shcore.dll");
+            }
+        }
+        else
+        {
+            cout << "Warning: At least Windows 8.1 is required to set DPI awareness." << endl;
+        }
+    }
+}
+
+ComShellBackend::ComShellBackend()
+    : changeNotifyWindow(NULL)
+    , changeNotifyId(0)
+{
+    SetHighDpiAwareness();
+
+    HRESULT result = CoInitialize(NULL);
+    if (!SUCCEEDED(result))
+        throw ShellError("CoInitialize", result);
+
+    try
+    {
+        // Extract IShellView, IFolderView and IShellFolder from the desktop.
+        findDesktopShellView(shellview);
+        findDesktopFolderView(shellview, IID_PPV_ARGS(&folderview));
+        result = folderview->GetFolder(IID_PPV_ARGS(&shellfolder));
+        if (!SUCCEEDED(result))
+            throw ShellError("GetFolder", result);
+    }
+    catch (...)
+    {
+        // The destructor doesn't run if the constructor throws.
+        releaseInterfaces();
+        CoUninitialize();
+        throw;
+    }
+}
+
+ComShellBackend::~ComShellBackend()
+{
+    // Every interface must be released before COM is uninitialised on this thread.
+    unsubscribeChanges();
+    releaseInterfaces();
+    CoUninitialize();
+}
+
+void ComShellBackend::releaseInterfaces()
+{
+    shellfolder.Release();
+    folderview.Release();
+    shellview.Release();
+}
+
+void ComShellBackend::findDesktopShellView(CComPtr<IShellView>& shellViewOut)
+{
+    CComPtr<IShellWindows> shellWindows;
+    HRESULT result = shellWindows.CoCreateInstance(CLSID_ShellWindows);
+    if (!SUCCEEDED(result))
+        throw ShellError("CoCreateInstance", result);
+
+    CComVariant idloc(CSIDL_DESKTOP);
+    CComVariant emptyloc;
+    CComPtr<IDispatch> dispatch;
+    long hwnd;
+
+    result = shellWindows->FindWindowSW(
+        &idloc,
+        &emptyloc,
+        SWC_DESKTOP,
+        &hwnd,
+        SWFO_NEEDDISPATCH,
+        &dispatch);
+    if (!SUCCEEDED(result))
+        throw ShellError("FindWindowSW", result);
+
+    CComPtr<IShellBrowser> shellBrowser;
+    result = CComQIPtr<IServiceProvider>(dispatch)->QueryService(
+        SID_STopLevelBrowser,
+        IID_PPV_ARGS(&shellBrowser));
+    if (!SUCCEEDED(result))
+        throw ShellError("QueryService", result);
+
+    result = shellBrowser->QueryActiveShellView(&shellViewOut);
+    if (!SUCCEEDED(result))
+        throw ShellError("QueryActiveShellView", result);
+}
+
+void ComShellBackend::findDesktopFolderView(CComPtr<IShellView> shellViewArg, REFIID riid, void** ppv)
+{
+    HRESULT result = shellViewArg->QueryInterface(riid, ppv);
+    if (!SUCCEEDED(result))
+        throw ShellError("QueryInterface", result);
+}
+
+ShellStatus ComShellBackend::items(ShellItemSet set, unique_ptr<ShellItemEnumerator>& enumOut)
+{
+    const UINT svgio = (set == ShellItemSet::Selection ? SVGIO_SELECTION : SVGIO_ALLVIEW);
+
+    CComPtr<IEnumIDList> idlist;
+    HRESULT result = folderview->Items(svgio, IID_PPV_ARGS(&idlist));
+    if (!SUCCEEDED(result))
+        return result;
+
+    // Items() may succeed without an enumerator, e.g. for SVGIO_SELECTION when nothing is selected.
+    if (idlist)
+        enumOut = make_unique<ComItemEnumerator>(idlist);
+    else
+        enumOut.reset();
+
+    return result;
+}
+
+ShellStatus ComShellBackend::displayName(ItemIdView itemid, ShellNameKind kind, wstring& nameOut) const
+{
+    const SHGDNF flags = (kind == ShellNameKind::Parsing ? SHGDN_INFOLDER | SHGDN_FORPARSING : SHGDN_NORMAL);
+
+    STRRET str;
+    HRESULT result = shellfolder->GetDisplayNameOf(toItemIdPointer(itemid), flags, &str);
+    if (!SUCCEEDED(result))
+        return result;
+
+    CComHeapPtr<wchar_t> name;
+    result = StrRetToStr(&str, toItemIdPointer(itemid), &name);
+    if (!SUCCEEDED(result))
+        return result;
+
+    nameOut = name;
+    return S_OK;
+}
+
+ShellStatus ComShellBackend::itemPosition(ItemIdView itemid, Vec2<int>& positionOut) const
+{
+    POINT pt = { 0, 0 };
+    HRESULT result = folderview->GetItemPosition(toItemIdPointer(itemid), &pt);
+    positionOut = Vec2<int>(pt.x, pt.y);
+    return result;
+}
+
+ShellStatus ComShellBackend::positionItems(size_t count, const ItemIdView* itemids, const Vec2<int>* points)
+{
+    std::vector<PCUITEMID_CHILD> itemidv(count);
+    std::vector<POINT> pointsv(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        itemidv[i] = toItemIdPointer(itemids[i]);
+        pointsv[i] = { points[i].x, points[i].y };
+    }
+
+    return folderview->SelectAndPositionItems(static_cast<UINT>(count), itemidv.data(), pointsv.data(), SVSI_POSITIONITEM);
+}
+
+ShellStatus ComShellBackend::spacing(Vec2<int>& spacingOut) const
+{
+    POINT pt = { 0, 0 };
+    HRESULT result = folderview->GetSpacing(&pt);
+    spacingOut = Vec2<int>(pt.x, pt.y);
+    return result;
+}
+
+ShellStatus ComShellBackend::folderFlags(FolderFlags& flagsOut) const
+{
+    FOLDERSETTINGS settings;
+    HRESULT result = shellview->GetCurrentInfo(&settings);
+    if (!SUCCEEDED(result))
+        return result;
+
+    flagsOut.autoArrange = (settings.fFlags & FWF_AUTOARRANGE ? true : false);
+    flagsOut.snapToGrid = (settings.fFlags & FWF_SNAPTOGRID ? true : false);
+    return result;
+}
+
+Vec2<int> ComShellBackend::desktopResolution() const
+{
+    RECT desktop;
+    const HWND hwnd = GetDesktopWindow();
+
+    if (!GetWindowRect(hwnd, &desktop))
+        throwLastError("GetWindowRect");
+
+    return Vec2<int>(desktop.right, desktop.bottom);
+}
+
+int ComShellBackend::monitorCount() const
+{
+    return GetSystemMetrics(SM_CMONITORS);
+}
+
+int ComShellBackend::systemDpi() const
+{
+    // This is the system DPI rather than 96 as long as the process is DPI aware (see the constructor).
+    HDC screen = GetDC(NULL);
+    if (!screen)
+        throwLastError("GetDC");
+    int dpi = GetDeviceCaps(screen, LOGPIXELSX);
+    ReleaseDC(NULL, screen);
+
+    return dpi;
+}
+
+Vec2<int> ComShellBackend::cursorPosition() const
+{
+    POINT pt;
+    if (!GetCursorPos(&pt))
+        throwLastError("cursorPosition");
+    return Vec2<int>(pt.x, pt.y);
+}
+
+void ComShellBackend::refresh()
+{
+    SHChangeNotify(SHCNE_UPDATEDIR, SHCNF_PATH | SHCNF_FLUSHNOWAIT, desktopDirectory().c_str(), NULL);
+}
+
+void ComShellBackend::subscribeChanges()
+{
+    if (changeNotifyWindow)
+        return;
+
+    // Icons on the desktop come from the virtual desktop folder as well as the user's and the public desktop directories.
+    const int folders[] = { CSIDL_DESKTOP, CSIDL_DESKTOPDIRECTORY, CSIDL_COMMON_DESKTOPDIRECTORY };
+    const int folderCount = sizeof(folders) / sizeof(folders[0]);
+
+    CComHeapPtr<ITEMIDLIST_ABSOLUTE> folderIds[folderCount];
+    SHChangeNotifyEntry entries[folderCount];
+
+    for (int i = 0; i < folderCount; ++i)
+    {
+        HRESULT result = SHGetSpecialFolderLocation(NULL, folders[i], &folderIds[i]);
+        if (!SUCCEEDED(result))
+            throw ShellError("SHGetSpecialFolderLocation", result);
+
+        entries[i].pidl = folderIds[i];
+        entries[i].fRecursive = FALSE;
+    }
+
+    changeNotifyWindow = CreateWindowExW(0, L"STATIC", L"", 0, 0, 0, 0, 0, HWND_MESSAGE, NULL, NULL, NULL);
+    if (!changeNotifyWindow)
+        throwLastError("CreateWindowExW");
+
+    changeNotifyId = SHChangeNotifyRegister(
+        changeNotifyWindow,
+        SHCNRF_ShellLevel | SHCNRF_InterruptLevel | SHCNRF_NewDelivery,
+        SHCNE_CREATE | SHCNE_MKDIR | SHCNE_DELETE | SHCNE_RMDIR | SHCNE_RENAMEITEM | SHCNE_RENAMEFOLDER | SHCNE_UPDATEDIR,
+        changeNotifyMessage,
+        folderCount,
+        entries);
+    if (changeNotifyId == 0)
+    {
+        unsubscribeChanges();
+        throw runtime_error("SHChangeNotifyRegister failed.");
+    }
+}
+
+void ComShellBackend::unsubscribeChanges()
+{
+    if (changeNotifyId != 0)
+    {
+        SHChangeNotifyDeregister(changeNotifyId);
+        changeNotifyId = 0;
+    }
+
+    // Destroying the window discards any notifications still queued for it.
+    if (changeNotifyWindow)
+    {
+        DestroyWindow(changeNotifyWindow);
+        changeNotifyWindow = NULL;
+    }
+}
+
+size_t ComShellBackend::pollChanges(const function<void(const ShellChange&)>& handler)
+{
+    size_t passed = 0;
+    MSG msg;
+
+    // The handler may unsubscribe, which destroys the window, so it's checked on each iteration.
+    while (changeNotifyWindow && 
+           PeekMessageW(&msg, changeNotifyWindow, changeNotifyMessage, changeNotifyMessage, PM_REMOVE))
+    {
+        PIDLIST_ABSOLUTE* pidls = nullptr;
+        LONG event = 0;
+        HANDLE lock = SHChangeNotification_Lock(
+            reinterpret_cast<HANDLE>(msg.wParam), 
+            static_cast<DWORD>(msg.lParam), 
+            &pidls, 
+            &event);
+        if (!lock)
+            continue;
+
+        ShellChange change;
+        bool relevant = true;
+
+        switch (event & ~SHCNE_INTERRUPT)
+        {
+        case SHCNE_CREATE:
+        case SHCNE_MKDIR:
+            change.type = DesktopChangeType::Added;
+            change.name = absoluteItemName(pidls[0]);
+            break;
+        case SHCNE_DELETE:
+        case SHCNE_RMDIR:
+            change.type = DesktopChangeType::Removed;
+            change.name = absoluteItemName(pidls[0]);
+            break;
+        case SHCNE_RENAMEITEM:
+        case SHCNE_RENAMEFOLDER:
+            change.type = DesktopChangeType::Renamed;
+            change.name = absoluteItemName(pidls[0]);
+            change.newName = absoluteItemName(pidls[1]);
+            break;
+        case SHCNE_UPDATEDIR:
+            change.type = DesktopChangeType::Updated;
+            break;
+        default:
+            relevant = false;
+            break;
+        }
+
+        // The item ID is copied while the notification is locked, since the Shell frees it on unlock.
+        if (relevant && change.type != DesktopChangeType::Updated)
+            change.itemid = childItemId(pidls[0]);
+
+        SHChangeNotification_Unlock(lock);
+
+        if (!relevant)
+            continue;
+
+        handler(change);
+        ++passed;
+    }
+
+    return passed;
+}
\ No newline at end of file
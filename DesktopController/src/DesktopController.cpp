@@ -1,71 +1,75 @@
 #include "DesktopController.h"
 #include "DesktopIcon.h"
 
-#include <iostream>
-#include <ShellScalingApi.h>
+#include <unordered_set>
+#include <algorithm>
+#include <thread>
+#include <cstdlib>
+#include <cwctype>
+
+#ifdef _WIN32
+#include "ComShellBackend.h"
+#endif
 
 using namespace std;
 using namespace DcUtil;
 
+#ifdef _WIN32
 DesktopController::DesktopController() 
+    : DesktopController(make_shared<ComShellBackend>())
 {
-    HRESULT result = CoInitialize(NULL);
-    if (!SUCCEEDED(result))
-        throwHRESULTException("CoInitialize", result);
-
-    // Extract IShellView, IFolderView and IShellFolder from the desktop.
-    findDesktopShellView(shellview);
-    findDesktopFolderView(shellview, IID_PPV_ARGS(&folderview));
-    result = folderview->GetFolder(IID_PPV_ARGS(&shellfolder));
-    if (!SUCCEEDED(result))
-        throwHRESULTException("GetFolder", result);
+}
+#endif
 
-    SetHighDpiAwareness();
+DesktopController::DesktopController(shared_ptr<ShellBackend> backendArg)
+    : backend(std::move(backendArg))
+    , nameIndexValid(false)
+    , nameGeneration(0)
+    , replayingHistory(false)
+    , chunkSizeHint(0)
+    , nextChangeCallbackId(1)
+{
+    if (!backend)
+        throw runtime_error("DesktopController requires a ShellBackend");
 }
 
 DesktopController::~DesktopController()
 {
+    // The backend may outlive this object, so it stops queueing changes nobody will process.
+    if (!changeCallbacks.empty())
+        backend->unsubscribeChanges();
 }
 
-void DesktopController::findDesktopShellView(CComPtr<IShellView>& shellViewOut)
+void DesktopController::enumerateItemIDs(
+    ShellItemSet set,
+    size_t batchSize, 
+    const function<bool(ItemId*, size_t)>& callback)
 {
-    CComPtr<IShellWindows> shellWindows;
-    HRESULT result = shellWindows.CoCreateInstance(CLSID_ShellWindows);
-    if (!SUCCEEDED(result))
-        throwHRESULTException("CoCreateInstance", result);
+    unique_ptr<ShellItemEnumerator> idlist;
+    ShellStatus result = timeShellCall(ShellCall::Items, [&] { return backend->items(set, idlist); });
+    if (!shellSucceeded(result))
+        throw ShellError("Items", result);
 
-    CComVariant idloc(CSIDL_DESKTOP);
-    CComVariant emptyloc;
-    CComPtr<IDispatch> dispatch;
-    long hwnd;
+    // Items() may succeed without an enumerator, e.g. for a selection when nothing is selected.
+    if (!idlist)
+        return;
 
-    result = shellWindows->FindWindowSW(
-        &idloc,
-        &emptyloc,
-        SWC_DESKTOP,
-        &hwnd,
-        SWFO_NEEDDISPATCH,
-        &dispatch);
-    if (!SUCCEEDED(result))
-        throwHRESULTException("FindWindowSW", result);
+    // Reused for every batch, so item IDs the callback doesn't take keep their storage for the next one.
+    vector<ItemId> batch(batchSize);
 
-    CComPtr<IShellBrowser> shellBrowser;
-    result = CComQIPtr<IServiceProvider>(dispatch)->QueryService(
-        SID_STopLevelBrowser,
-        IID_PPV_ARGS(&shellBrowser));
-    if (!SUCCEEDED(result))
-        throwHRESULTException("QueryService", result);
+    for (;;)
+    {
+        size_t count = 0;
+        result = timeShellCall(ShellCall::Next, [&] { return idlist->next(batch.data(), batchSize, count); });
+        if (!shellSucceeded(result))
+            throw ShellError("Next", result);
 
-    result = shellBrowser->QueryActiveShellView(&shellViewOut);
-    if (!SUCCEEDED(result))
-        throwHRESULTException("QueryActiveShellView", result);
-}
+        bool keepGoing = (count == 0 ? false : callback(batch.data(), count));
 
-void DesktopController::findDesktopFolderView(CComPtr<IShellView> shellViewArg, REFIID riid, void** ppv)
-{
-    HRESULT result = shellViewArg->QueryInterface(riid, ppv);
-    if (!SUCCEEDED(result))
-        throwHRESULTException("QueryInterface", result);
+        // shellFalse is returned when fewer than batchSize items remain.
+        if (!keepGoing || result != shellOk)
+            break;
+    }
 }
 
 // NOTE: pybind11 doesn't recognise a reference to DesktopIcon here, instead it 
@@ -75,303 +79,1050 @@ void DesktopController::enumerateIcons(const function<void(const DesktopIcon*)>&
     if (!callback)
         throw runtime_error("Invalid callback in enumerateIcons().");
 
-    CComPtr<IEnumIDList> idlist;
-    HRESULT result = folderview->Items(SVGIO_ALLVIEW, IID_PPV_ARGS(&idlist));
-    if (!SUCCEEDED(result))
-        throwHRESULTException("Items", result);
+    enumerateItemIDs(ShellItemSet::All, defaultEnumBatchSize,
+        [&](ItemId* itemids, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                // Construct a DesktopIcon and pass to the caller.
+                // Note: itemid ownership moves to DesktopIcon and is freed by its destructor.
+                DesktopIcon icon(backend.get(), std::move(itemids[i]), &nameGeneration);
+                callback(&icon);
+            }
+            return true;
+        });
+}
+
+void DesktopController::enumerateIconsBatched(
+    unsigned int batchSize, 
+    const function<void(const vector<const DesktopIcon*>&)>& callback)
+{
+    if (!callback)
+        throw runtime_error("Invalid callback in enumerateIconsBatched().");
+    if (batchSize == 0)
+        throw runtime_error("batchSize must be more than 0 in enumerateIconsBatched().");
+
+    vector<const DesktopIcon*> iconPtrs;
+    iconPtrs.reserve(batchSize);
 
-    // Note: itemid is freed by the destructor of DesktopIcon.
-    for (CComHeapPtr<ITEMID_CHILD> itemid; idlist->Next(1, &itemid, nullptr) == S_OK; )
+    enumerateItemIDs(ShellItemSet::All, batchSize,
+        [&](ItemId* itemids, size_t count)
+        {
+            // Reserved up front so the pointers passed to the caller aren't invalidated by reallocation.
+            vector<DesktopIcon> icons;
+            icons.reserve(count);
+            iconPtrs.clear();
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                icons.emplace_back(backend.get(), std::move(itemids[i]), &nameGeneration);
+                iconPtrs.push_back(&icons.back());
+            }
+
+            callback(iconPtrs);
+            return true;
+        });
+}
+
+// Case-insensitive comparison of the first count characters of a and b.
+static bool equalsIgnoreCase(const wchar_t* a, const wchar_t* b, size_t count)
+{
+#ifdef _WIN32
+    return CompareStringOrdinal(a, static_cast<int>(count), b, static_cast<int>(count), TRUE) == CSTR_EQUAL;
+#else
+    // CompareStringOrdinal compares the upper case forms of each character.
+    for (size_t i = 0; i < count; ++i)
     {
-        // Construct a DesktopIcon and pass to the caller.
-        DesktopIcon icon(shellfolder, folderview, itemid);
-        callback(&icon);
+        if (a[i] != b[i] && towupper(static_cast<wint_t>(a[i])) != towupper(static_cast<wint_t>(b[i])))
+            return false;
     }
+    return true;
+#endif
+}
+
+// The extension of a file name including the dot (e.g. ".txt"), or an empty string if it has none, as PathFindExtension.
+static const wchar_t* findExtension(const wstring& fileName)
+{
+    size_t dot = fileName.find_last_of(L".\\/ ");
+    if (dot == wstring::npos || fileName[dot] != L'.')
+        return fileName.c_str() + fileName.size();
+    return fileName.c_str() + dot;
+}
+
+size_t DesktopController::enumerateIconsWhere(
+    const EnumerationOptions& options, 
+    const function<bool(const DesktopIcon*)>& callback)
+{
+    if (!callback)
+        throw runtime_error("Invalid callback in enumerateIconsWhere().");
+
+    wstring extension = options.extension;
+    if (!extension.empty() && extension[0] != L'.')
+        extension.insert(extension.begin(), L'.');
+
+    size_t passed = 0;
+    wstring name;
+
+    enumerateItemIDs(options.selectedOnly ? ShellItemSet::Selection : ShellItemSet::All, defaultEnumBatchSize,
+        [&](ItemId* itemids, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                // Filters are applied before a DesktopIcon is constructed. Names are only fetched when a filter needs them.
+                if (!options.namePrefix.empty())
+                {
+                    if (!tryDisplayName(itemids[i], name) || 
+                        name.size() < options.namePrefix.size() ||
+                        !equalsIgnoreCase(name.c_str(), options.namePrefix.c_str(), options.namePrefix.size()))
+                        continue;
+                }
+
+                if (!extension.empty())
+                {
+                    // The display name may hide the extension, so the parsing name is used here.
+                    if (!tryDisplayName(itemids[i], name, ShellNameKind::Parsing))
+                        continue;
+
+                    const wchar_t* ext = findExtension(name);
+                    size_t extLength = wcslen(ext);
+                    if (extLength != extension.size() || !equalsIgnoreCase(ext, extension.c_str(), extLength))
+                        continue;
+                }
+
+                DesktopIcon icon(backend.get(), std::move(itemids[i]), &nameGeneration);
+                ++passed;
+                if (!callback(&icon))
+                    return false;
+            }
+            return true;
+        });
+
+    return passed;
 }
 
 unique_ptr<DesktopIcon> DesktopController::iconByName(const wstring& name)
 {
-    CComPtr<IEnumIDList> idlist;
-    HRESULT result = folderview->Items(SVGIO_ALLVIEW, IID_PPV_ARGS(&idlist));
-    if (!SUCCEEDED(result))
-        throwHRESULTException("Items", result);
+    const ItemId* indexed = findIndexedName(name);
+    if (!indexed)
+        return unique_ptr<DesktopIcon>(nullptr);
+
+    // The index keeps its own copy of the item ID, DesktopIcon is given a clone.
+    return cloneIcon(*indexed);
+}
+
+unique_ptr<DesktopIcon> DesktopController::cloneIcon(ItemIdView itemid)
+{
+    return make_unique<DesktopIcon>(backend.get(), itemid.copy(), &nameGeneration);
+}
+
+vector<unique_ptr<DesktopIcon>> DesktopController::iconsByNames(const vector<wstring>& names)
+{
+    vector<unique_ptr<DesktopIcon>> icons(names.size());
+
+    // Maps each requested name to the index of its first occurrence in names.
+    unordered_map<wstring, size_t> requested;
+    requested.reserve(names.size());
+    for (size_t i = 0; i < names.size(); ++i)
+        requested.emplace(names[i], i);
+
+    size_t remaining = requested.size();
+    if (remaining == 0)
+        return icons;
+
+    enumerateItemIDs(ShellItemSet::All, defaultEnumBatchSize,
+        [&](ItemId* itemids, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                auto it = requested.find(displayNameOf(itemids[i]));
+
+                // As with iconByName, the first icon in enumeration order wins if names are duplicated.
+                if (it == requested.end() || icons[it->second])
+                    continue;
 
-    // Note: If an icon with a matching name is found, itemid is not freed here.
-    for (CComHeapPtr<ITEMID_CHILD> itemid; idlist->Next(1, &itemid, nullptr) == S_OK; itemid.Free())
+                icons[it->second] = make_unique<DesktopIcon>(backend.get(), std::move(itemids[i]), &nameGeneration);
+
+                // Stop as soon as every name has been found.
+                if (--remaining == 0)
+                    return false;
+            }
+            return true;
+        });
+
+    // Names requested more than once get their own DesktopIcon, cloned from the first.
+    for (size_t i = 0; i < names.size(); ++i)
     {
-        wstring displayName = shellFolderObjNameToStrW(shellfolder, itemid);
-        if (displayName == name)
-            return make_unique<DesktopIcon>(shellfolder, folderview, itemid);
+        size_t first = requested[names[i]];
+        if (first != i && icons[first])
+            icons[i] = cloneIcon(icons[first]->getItemID());
     }
 
-    return unique_ptr<DesktopIcon>(nullptr);
+    return icons;
 }
 
-vector<unique_ptr<DesktopIcon>> DesktopController::allIcons()
+const ItemId* DesktopController::findIndexedName(const wstring& name)
 {
-    CComPtr<IEnumIDList> idlist;
-    HRESULT result = folderview->Items(SVGIO_ALLVIEW, IID_PPV_ARGS(&idlist));
-    if (!SUCCEEDED(result))
-        throwHRESULTException("Items", result);
+    bool builtNow = false;
+    if (!nameIndexValid)
+    {
+        buildNameIndex();
+        builtNow = true;
+    }
 
-    vector<unique_ptr<DesktopIcon>> icons;
+    auto it = nameIndex.find(name);
+    if (it != nameIndex.end())
+    {
+        if (builtNow)
+            return &it->second;
+
+        // The desktop may have changed since the index was built (e.g. the icon was renamed or deleted), so
+        // check the indexed item ID, and so its key, still refers to an item. Item IDs embed the name, so a 
+        // renamed or deleted item's doesn't. This costs a single GetItemPosition call, without fetching or 
+        // comparing a name, and the index is only rebuilt when the key no longer matches.
+        Vec2<int> position;
+        if (shellSucceeded(backend->itemPosition(it->second, position)))
+            return &it->second;
+    }
+    else if (builtNow || missingNames.count(name) != 0)
+    {
+        missingNames.insert(name);
+        return nullptr;
+    }
 
-    for (CComHeapPtr<ITEMID_CHILD> itemid; idlist->Next(1, &itemid, nullptr) == S_OK;)
-        icons.push_back(make_unique<DesktopIcon>(shellfolder, folderview, itemid));
+    // The entry is out of date or the icon may have been added since the index was built.
+    buildNameIndex();
 
-    return icons;
+    it = nameIndex.find(name);
+    if (it != nameIndex.end())
+        return &it->second;
+
+    missingNames.insert(name);
+    return nullptr;
 }
 
-wstring DesktopController::shellFolderObjNameToStrW(IShellFolder* shellFolderArg, ITEMID_CHILD* itemid)
+void DesktopController::buildNameIndex()
 {
-    STRRET str;
-    HRESULT result = shellFolderArg->GetDisplayNameOf(itemid, SHGDN_NORMAL, &str);
-    if (!SUCCEEDED(result))
-        throwHRESULTException("GetDisplayNameOf", result);
+    unordered_map<wstring, ItemId> index;
 
-    CComHeapPtr<wchar_t> name;
-    result = StrRetToStr(&str, itemid, &name);
-    if (!SUCCEEDED(result))
-        throwHRESULTException("StrRetToStr", result);
+    enumerateItemIDs(ShellItemSet::All, defaultEnumBatchSize,
+        [&](ItemId* itemids, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                wstring name = displayNameOf(itemids[i]);
+                if (index.find(name) == index.end())
+                    index.emplace(std::move(name), std::move(itemids[i]));
+            }
+            return true;
+        });
 
-    return wstring(name);
+    nameIndex.swap(index);
+    nameIndexValid = true;
+    missingNames.clear();
 }
 
-void DesktopController::repositionIcons(const vector<DesktopIcon*>& icons, vector<Vec2<int>>& points)
+void DesktopController::invalidateNameIndex()
 {
-    if (icons.size() != points.size())
-        throw runtime_error("Argument size mismatch in DesktopController::repositionIcons");
+    nameIndex.clear();
+    nameIndexValid = false;
+    missingNames.clear();
+}
 
-    vector<PCITEMID_CHILD> itemidv;
-    for (auto& icon : icons)
-        itemidv.push_back(icon->getItemID());
+vector<unique_ptr<DesktopIcon>> DesktopController::allIcons()
+{
+    vector<unique_ptr<DesktopIcon>> icons;
 
-    vector<POINT> pointsv;
-    for (auto& pt : points)
-        pointsv.push_back({ pt.x, pt.y });
+    enumerateItemIDs(ShellItemSet::All, defaultEnumBatchSize,
+        [&](ItemId* itemids, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+                icons.push_back(make_unique<DesktopIcon>(backend.get(), std::move(itemids[i]), &nameGeneration));
+            return true;
+        });
 
-    HRESULT result = folderview->SelectAndPositionItems(
-        static_cast<UINT>(icons.size()),
-        itemidv.data(),
-        pointsv.data(),
-        SVSI_POSITIONITEM);
-    if (!SUCCEEDED(result))
-        throwHRESULTException("SelectAndPositionItems", result);
+    return icons;
 }
 
-string DesktopController::errorIdToMessage(DWORD id)
+vector<DesktopIcon> DesktopController::allIconsValue()
 {
-    string message;
-    if (id == 0)
-        message = "";
+    vector<DesktopIcon> icons;
+
+    enumerateItemIDs(ShellItemSet::All, defaultEnumBatchSize,
+        [&](ItemId* itemids, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+                icons.emplace_back(backend.get(), std::move(itemids[i]), &nameGeneration);
+            return true;
+        });
 
-    LPSTR buffer = nullptr;
-    size_t size = FormatMessageA(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
-        NULL, id, MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), (LPSTR)&buffer, 0, NULL);
+    return icons;
+}
+
+DesktopSnapshot DesktopController::snapshot()
+{
+    DesktopSnapshot snap;
 
-    message = std::string(buffer, size);
+    enumerateItemIDs(ShellItemSet::All, defaultEnumBatchSize,
+        [&](ItemId* itemids, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                wstring name = displayNameOf(itemids[i]);
 
-    LocalFree(buffer);
+                Vec2<int> pt;
+                ShellStatus result = readItemPosition(itemids[i], pt);
+                if (!shellSucceeded(result))
+                    throw ShellError("GetItemPosition", result);
 
-    message.erase(std::remove(message.begin(), message.end(), '\n'), message.end());
+                snap.append(itemids[i], std::move(name), pt);
+            }
+            return true;
+        });
 
-    return message;
+    return snap;
 }
 
-void DesktopController::throwHRESULTException(const std::string& function, HRESULT result)
+bool DesktopController::tryDisplayName(ItemIdView itemid, wstring& nameOut, ShellNameKind kind) const
 {
-    throw runtime_error(function + " failed: " + errorIdToMessage(result));
+    ShellStatus result = timeShellCall(ShellCall::GetDisplayNameOf, [&] { return backend->displayName(itemid, kind, nameOut); });
+    return shellSucceeded(result);
 }
 
-void DesktopController::getLastErrorWithString(DWORD& dw, std::string& message)
+wstring DesktopController::displayNameOf(ItemIdView itemid) const
 {
-    dw = GetLastError();
-    message = errorIdToMessage(dw);
+    wstring name;
+    ShellStatus result = timeShellCall(ShellCall::GetDisplayNameOf, [&] { return backend->displayName(itemid, ShellNameKind::Display, name); });
+    if (!shellSucceeded(result))
+        throw ShellError("GetDisplayNameOf", result);
+
+    return name;
 }
 
-void DesktopController::throwLastError(const string& function)
+ShellStatus DesktopController::readItemPosition(ItemIdView itemid, Vec2<int>& out) const
 {
-    string message;
-    DWORD error;
-    getLastErrorWithString(error, message);
-    throw runtime_error(function + " failed: (" + std::to_string(error) + ") " + message);
+    ShellStatus result = timeShellCall(ShellCall::GetItemPosition, [&] { return backend->itemPosition(itemid, out); });
+
+    if (!shellSucceeded(result))
+        out = Vec2<int>(0, 0);
+
+    return result;
 }
 
-Vec2<int> DesktopController::iconSpacing() const
+size_t DesktopController::positionsOf(
+    const vector<DesktopIcon*>& icons, 
+    vector<Vec2<int>>& positions, 
+    vector<ShellStatus>& status) const
 {
-    POINT pt{ 0,0 };
-    HRESULT result = folderview->GetSpacing(&pt);
-    if (!SUCCEEDED(result))
-        throwHRESULTException("GetSpacing", result);
-    return Vec2<int>(pt.x, pt.y);
+    positions.resize(icons.size());
+    status.resize(icons.size());
+
+    size_t failures = 0;
+    for (size_t i = 0; i < icons.size(); ++i)
+    {
+        status[i] = (icons[i] ? readItemPosition(icons[i]->getItemID(), positions[i]) : shellPointerError);
+        if (!shellSucceeded(status[i]))
+            ++failures;
+    }
+
+    return failures;
 }
 
-Vec2<int> DesktopController::desktopResolution() const
+size_t DesktopController::positionsOf(
+    const DesktopSnapshot& snap, 
+    vector<Vec2<int>>& positions, 
+    vector<ShellStatus>& status) const
 {
-    RECT desktop;
-    const HWND hwnd = GetDesktopWindow();
+    positions.resize(snap.size());
+    status.resize(snap.size());
 
-    if (!GetWindowRect(hwnd, &desktop))
-        throwLastError("GetWindowRect");
+    size_t failures = 0;
+    for (size_t i = 0; i < snap.size(); ++i)
+    {
+        status[i] = readItemPosition(snap.itemID(i), positions[i]);
+        if (!shellSucceeded(status[i]))
+            ++failures;
+    }
 
-    return Vec2<int>(desktop.right, desktop.bottom);
+    return failures;
 }
 
-Vec2<int> DesktopController::cursorPosition() const
+size_t DesktopController::allIconPositions(vector<Vec2<int>>& positions, vector<ShellStatus>& status)
 {
-    POINT pt;
-    if (!GetCursorPos(&pt))
-        throwLastError("cursorPosition");
-    return Vec2<int>(pt.x, pt.y);
+    positions.clear();
+    status.clear();
+
+    size_t failures = 0;
+
+    enumerateItemIDs(ShellItemSet::All, defaultEnumBatchSize,
+        [&](ItemId* itemids, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                Vec2<int> pt;
+                ShellStatus result = readItemPosition(itemids[i], pt);
+                if (!shellSucceeded(result))
+                    ++failures;
+
+                positions.push_back(pt);
+                status.push_back(result);
+            }
+            return true;
+        });
+
+    return failures;
 }
 
-#ifdef ENABLE_VIEW_MODE
-ViewMode DesktopController::viewMode() const
+void DesktopController::repositionIcons(const vector<DesktopIcon*>& icons, vector<Vec2<int>>& points)
 {
-    FOLDERSETTINGS settings = folderSettings();
+    if (icons.size() != points.size())
+        throw runtime_error("Argument size mismatch in DesktopController::repositionIcons");
 
-    if (settings.ViewMode == FVM_SMALLICON)
-        return ViewMode::Small;
-    if (settings.ViewMode == FVM_ICON)
-        return ViewMode::Medium;
-    if (settings.ViewMode == FVM_TILE)
-        return ViewMode::Large;
+    vector<ItemIdView> itemidv;
+    itemidv.reserve(icons.size());
+    for (auto& icon : icons)
+        itemidv.push_back(icon->getItemID());
 
-    return ViewMode::Unknown;
+    HistoryScope scope(*this, icons.size(), itemidv.data(), points.data());
+    positionItems(icons.size(), itemidv.data(), points.data());
+    scope.accept();
 }
-#endif
 
-FolderFlags DesktopController::folderFlags() const
+void DesktopController::repositionIcons(
+    const DesktopSnapshot& snap, 
+    const vector<size_t>& indices, 
+    vector<Vec2<int>>& points)
 {
-    FOLDERSETTINGS settings = folderSettings();
+    if (indices.size() != points.size())
+        throw runtime_error("Argument size mismatch in DesktopController::repositionIcons");
 
-    FolderFlags flags;
+    vector<ItemIdView> itemidv;
+    itemidv.reserve(indices.size());
+    for (size_t index : indices)
+        itemidv.push_back(snap.itemID(index));
 
-    flags.autoArrange = (settings.fFlags & FWF_AUTOARRANGE ? true : false);
-    flags.snapToGrid = (settings.fFlags & FWF_SNAPTOGRID ? true : false);
+    HistoryScope scope(*this, indices.size(), itemidv.data(), points.data());
+    positionItems(indices.size(), itemidv.data(), points.data());
+    scope.accept();
+}
 
-    return flags;
+VerifiedRepositionReport DesktopController::repositionIconsVerified(
+    const vector<DesktopIcon*>& icons, 
+    const vector<Vec2<int>>& points,
+    const VerifyOptions& options)
+{
+    if (icons.size() != points.size())
+        throw runtime_error("Argument size mismatch in DesktopController::repositionIconsVerified");
+
+    VerifiedRepositionReport report;
+
+    // Indices of the icons still to be placed.
+    vector<size_t> pending(icons.size());
+    for (size_t i = 0; i < pending.size(); ++i)
+        pending[i] = i;
+
+    vector<ItemIdView> itemidv;
+    vector<Vec2<int>> pointsv;
+    vector<size_t> mismatched;
+
+    itemidv.reserve(icons.size());
+    pointsv.reserve(icons.size());
+    for (size_t i : pending)
+    {
+        itemidv.push_back(icons[i]->getItemID());
+        pointsv.push_back(points[i]);
+    }
+
+    // Retries move the same icons to the same targets, so the whole call is one step.
+    HistoryScope scope(*this, icons.size(), itemidv.data(), pointsv.data());
+
+    while (!pending.empty())
+    {
+        if (report.batches > 0)
+        {
+            itemidv.clear();
+            pointsv.clear();
+            for (size_t i : pending)
+            {
+                itemidv.push_back(icons[i]->getItemID());
+                pointsv.push_back(points[i]);
+            }
+        }
+
+        ShellStatus batchResult = tryPositionItems(pending.size(), itemidv.data(), pointsv.data());
+        ++report.batches;
+        if (shellSucceeded(batchResult))
+            scope.accept();
+
+        if (options.settleDelay.count() > 0)
+            this_thread::sleep_for(options.settleDelay);
+
+        const bool lastAttempt = (report.batches > options.maxRetries);
+        mismatched.clear();
+
+        for (size_t i : pending)
+        {
+            Vec2<int> actual;
+            ShellStatus status = readItemPosition(icons[i]->getItemID(), actual);
+
+            if (shellSucceeded(status) && 
+                abs(actual.x - points[i].x) <= options.tolerance && 
+                abs(actual.y - points[i].y) <= options.tolerance)
+            {
+                ++report.placed;
+                continue;
+            }
+
+            if (!lastAttempt)
+                mismatched.push_back(i);
+            else
+            {
+                // Report why the icon isn't in place: the batch was rejected, its position couldn't be read,
+                // or (shellOk) it was placed somewhere else.
+                if (shellSucceeded(status))
+                    status = (shellSucceeded(batchResult) ? shellOk : batchResult);
+                report.failures.push_back({ i, points[i], actual, status });
+            }
+        }
+
+        if (lastAttempt)
+            break;
+
+        pending.swap(mismatched);
+    }
+
+    return report;
 }
 
-FOLDERSETTINGS DesktopController::folderSettings() const
+ChunkedRepositionReport DesktopController::repositionIconsChunked(
+    const vector<DesktopIcon*>& icons, 
+    const vector<Vec2<int>>& points,
+    const ChunkingOptions& options)
 {
-    FOLDERSETTINGS settings;
-    HRESULT result = shellview->GetCurrentInfo(&settings);
-    if (!SUCCEEDED(result))
-        throwHRESULTException("GetCurrentInfo", result);
+    if (icons.size() != points.size())
+        throw runtime_error("Argument size mismatch in DesktopController::repositionIconsChunked");
+
+    // A size found under other limits may be far from the best under these, e.g. with a shorter maxStall.
+    const bool sameLimits =
+        options.minChunkSize == chunkSizeHintOptions.minChunkSize &&
+        options.maxChunkSize == chunkSizeHintOptions.maxChunkSize &&
+        options.maxStall == chunkSizeHintOptions.maxStall;
+    if (!sameLimits)
+        chunkSizeHint = 0;
+
+    AdaptiveChunker chunker(options, (chunkSizeHint != 0 ? chunkSizeHint : AdaptiveChunker::defaultChunkSize));
+    ChunkedRepositionReport report;
+
+    vector<ItemIdView> itemidv;
+    itemidv.reserve(icons.size());
+    for (auto& icon : icons)
+        itemidv.push_back(icon->getItemID());
+
+    // If a chunk throws, the chunks before it have moved, so they're still recorded.
+    HistoryScope scope(*this, icons.size(), itemidv.data(), points.data());
 
-    return settings;
+    for (size_t first = 0; first < icons.size(); )
+    {
+        size_t count = min(chunker.chunkSize(), icons.size() - first);
+
+        auto start = chrono::steady_clock::now();
+        positionItems(count, itemidv.data() + first, points.data() + first);
+        auto elapsed = chrono::steady_clock::now() - start;
+        scope.accept();
+
+        chunker.record(count, elapsed);
+        report.chunks.push_back({ first, count, elapsed });
+        report.total += elapsed;
+        report.longestStall = max(report.longestStall, elapsed);
+
+        first += count;
+    }
+
+    chunkSizeHint = chunker.chunkSize();
+    chunkSizeHintOptions = options;
+    return report;
 }
 
-void DesktopController::refresh()
+size_t DesktopController::repositionByName(const unordered_map<wstring, Vec2<int>>& targets, bool skipUnmoved)
 {
-    SHChangeNotify(SHCNE_UPDATEDIR, SHCNF_PATH | SHCNF_FLUSHNOWAIT, desktopDirectory().c_str(), NULL);
+    wstring name;
+    return positionMatchedItems(targets.size(), skipUnmoved,
+        [&](const ItemId& itemid) -> const Vec2<int>*
+        {
+            if (!tryDisplayName(itemid, name))
+                return nullptr;
+
+            auto it = targets.find(name);
+            return (it == targets.end() ? nullptr : &it->second);
+        });
 }
 
-// TODO: DPI awareness should be set in the manifest. Need to work out the details since this is compiled in 
-// to a static and shared library.
-void DesktopController::SetHighDpiAwareness()
+size_t DesktopController::repositionByKey(const unordered_map<uint64_t, Vec2<int>>& targets)
 {
-    // At least Windows 8.1 is required to load Shcore.dll (for Set/GetProcessDpiAwareness).
-    // TODO: Is setting DPI awareness necessary (or even possible) on earlier Windows versions?
-    if (Win81OrNewer())
-    {
-        HINSTANCE hinst = LoadLibrary(L"Shcore.dll");
+    return positionMatchedItems(targets.size(), false,
+        [&](const ItemId& itemid) -> const Vec2<int>*
+        {
+            auto it = targets.find(itemIdKey(itemid));
+            return (it == targets.end() ? nullptr : &it->second);
+        });
+}
 
-        if (hinst != NULL)
+SlotAssignment DesktopController::tidyIcons(const vector<DesktopIcon*>& icons, const vector<Vec2<int>>& slots)
+{
+    vector<Vec2<int>> positions;
+    vector<ShellStatus> status;
+    positionsOf(icons, positions, status);
+
+    // Icons whose position can't be read are left out of the assignment, and so left unassigned.
+    vector<size_t> readable;
+    vector<Vec2<int>> readablePositions;
+    readable.reserve(icons.size());
+    readablePositions.reserve(icons.size());
+    for (size_t i = 0; i < icons.size(); ++i)
+    {
+        if (shellSucceeded(status[i]))
         {
-            typedef HRESULT(STDAPICALLTYPE* GET_DPI_AWARE_PROC)(HANDLE, PROCESS_DPI_AWARENESS*);
-            typedef HRESULT(STDAPICALLTYPE* SET_DPI_AWARE_PROC)(PROCESS_DPI_AWARENESS);
+            readable.push_back(i);
+            readablePositions.push_back(positions[i]);
+        }
+    }
+
+    SlotAssignment readableAssignment = assignSlots(readablePositions, slots);
+
+    SlotAssignment assignment;
+    assignment.slotOf.assign(icons.size(), SlotAssignment::unassigned);
+    assignment.totalDistance = readableAssignment.totalDistance;
+    for (size_t k = 0; k < readable.size(); ++k)
+        assignment.slotOf[readable[k]] = readableAssignment.slotOf[k];
 
-            GET_DPI_AWARE_PROC GetProcessDpiAwareness_DLL =
-                (GET_DPI_AWARE_PROC)GetProcAddress(hinst, "GetProcessDpiAwareness");
+    // readable is ascending, so moved stays in ascending order.
+    assignment.moved.reserve(readableAssignment.moved.size());
+    for (size_t k : readableAssignment.moved)
+        assignment.moved.push_back(readable[k]);
 
-            SET_DPI_AWARE_PROC SetProcessDpiAwareness_DLL =
-                (SET_DPI_AWARE_PROC)GetProcAddress(hinst, "SetProcessDpiAwareness");
+    vector<ItemIdView> itemidv;
+    vector<Vec2<int>> pointsv;
+    itemidv.reserve(assignment.moved.size());
+    pointsv.reserve(assignment.moved.size());
 
-            PROCESS_DPI_AWARENESS dpiAwareness;
+    for (size_t i : assignment.moved)
+    {
+        itemidv.push_back(icons[i]->getItemID());
+        pointsv.push_back(slots[assignment.slotOf[i]]);
+    }
 
-            if (NULL != GetProcessDpiAwareness_DLL)
+    HistoryScope scope(*this, itemidv.size(), itemidv.data(), pointsv.data());
+    positionItems(itemidv.size(), itemidv.data(), pointsv.data());
+    scope.accept();
+    return assignment;
+}
+
+size_t DesktopController::restoreLayout(const LayoutFileView& layout)
+{
+    unordered_multimap<uint64_t, size_t> entriesByHash;
+    vector<Vec2<int>> targets;
+    entriesByHash.reserve(layout.size());
+    targets.reserve(layout.size());
+
+    // Only the first entry with each name is indexed, so enumeration can stop once every unique name has 
+    // been matched. Entries are compared in place, as icons' names are below.
+    for (size_t i = 0; i < layout.size(); ++i)
+    {
+        targets.push_back(layout.position(i));
+
+        const LayoutFileEntry& entry = layout.entry(i);
+        auto range = entriesByHash.equal_range(entry.nameHash);
+        bool duplicate = any_of(range.first, range.second, [&](const pair<const uint64_t, size_t>& other)
             {
-                HRESULT result = GetProcessDpiAwareness_DLL(NULL, &dpiAwareness);
+                return layout.entry(other.second).nameLength == entry.nameLength &&
+                    equal(layout.nameData(i), layout.nameData(i) + entry.nameLength, layout.nameData(other.second));
+            });
 
-                if (!SUCCEEDED(result))
-                    throwHRESULTException("GetProcessDpiAwareness_DLL", result);
-            }
-            else
+        if (!duplicate)
+            entriesByHash.emplace(entry.nameHash, i);
+    }
+
+    wstring name;
+    return positionMatchedItems(entriesByHash.size(), false,
+        [&](const ItemId& itemid) -> const Vec2<int>*
+        {
+            if (!tryDisplayName(itemid, name))
+                return nullptr;
+
+            // Names are compared in place to rule out hash collisions.
+            auto range = entriesByHash.equal_range(layoutNameHash(name));
+            for (auto it = range.first; it != range.second; ++it)
             {
-                throw runtime_error("Failed to load GetProcessDpiAwareness_DLL from Shcore.dll");
+                if (layout.nameEquals(it->second, name))
+                    return &targets[it->second];
             }
+            return nullptr;
+        });
+}
 
-            if (NULL != SetProcessDpiAwareness_DLL)
+size_t DesktopController::positionMatchedItems(
+    size_t targetCount, 
+    bool skipUnmoved,
+    const function<const Vec2<int>*(const ItemId&)>& match)
+{
+    if (targetCount == 0)
+        return 0;
+
+    vector<ItemId> matched;
+    vector<Vec2<int>> pointsv;
+    unordered_set<const Vec2<int>*> seen;
+    matched.reserve(targetCount);
+    pointsv.reserve(targetCount);
+    seen.reserve(targetCount);
+
+    enumerateItemIDs(ShellItemSet::All, defaultEnumBatchSize,
+        [&](ItemId* itemids, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
             {
-                if (dpiAwareness == PROCESS_DPI_UNAWARE)
+                const Vec2<int>* target = match(itemids[i]);
+                if (!target || !seen.insert(target).second)
+                    continue;
+
+                Vec2<int> current;
+                bool unmoved = skipUnmoved && 
+                    shellSucceeded(readItemPosition(itemids[i], current)) && 
+                    current.x == target->x && current.y == target->y;
+
+                if (!unmoved)
                 {
-                    // Set DPI awareness for 1-to-1 pixel control.
-                    HRESULT result = SetProcessDpiAwareness_DLL(PROCESS_SYSTEM_DPI_AWARE);
-                    if (result == E_INVALIDARG)
-                        throwHRESULTException("SetProcessDpiAwareness", result);
+                    // Ownership is taken so the item ID outlives the batch.
+                    matched.push_back(std::move(itemids[i]));
+                    pointsv.push_back(*target);
                 }
+
+                if (seen.size() == targetCount)
+                    return false;
             }
-            else
-            {
-                throw runtime_error("Failed to load SetProcessDpiAwareness from Shcore.dll");
-            }
+            return true;
+        });
 
-            if (!FreeLibrary(hinst))
-                throwLastError("FreeLibrary");
-        }
-        else
+    vector<ItemIdView> itemidv(matched.begin(), matched.end());
+
+    HistoryScope scope(*this, itemidv.size(), itemidv.data(), pointsv.data());
+    positionItems(itemidv.size(), itemidv.data(), pointsv.data());
+    scope.accept();
+    return itemidv.size();
+}
+
+size_t DesktopController::applyLayout(const vector<DesktopIcon*>& icons, const vector<Vec2<int>>& points)
+{
+    if (icons.size() != points.size())
+        throw runtime_error("Argument size mismatch in DesktopController::applyLayout");
+
+    vector<ItemIdView> itemidv;
+    vector<Vec2<int>> pointsv;
+    vector<size_t> submitted;
+
+    for (size_t i = 0; i < icons.size(); ++i)
+    {
+        auto it = appliedLayout.find(icons[i]->key());
+        if (it != appliedLayout.end() && it->second.x == points[i].x && it->second.y == points[i].y)
+            continue;
+
+        itemidv.push_back(icons[i]->getItemID());
+        pointsv.push_back(points[i]);
+        submitted.push_back(i);
+    }
+
+    positionItems(itemidv.size(), itemidv.data(), pointsv.data());
+
+    // Only remembered once the Shell has accepted the batch.
+    for (size_t i : submitted)
+        appliedLayout[icons[i]->key()] = points[i];
+
+    // Entries of icons which were deleted without a change notification being processed are never
+    // looked up again, so once there are too many only the icons in this call are kept.
+    if (appliedLayout.size() > maxAppliedLayoutSize)
+    {
+        unordered_map<uint64_t, Vec2<int>> current;
+        current.reserve(icons.size());
+        for (DesktopIcon* icon : icons)
         {
-            throw runtime_error("LoadLibrary failed to load Shcore.dll");
+            auto it = appliedLayout.find(icon->key());
+            if (it != appliedLayout.end())
+                current.insert(*it);
         }
+        appliedLayout.swap(current);
+    }
+
+    return icons.size() - submitted.size();
+}
+
+void DesktopController::forgetAppliedLayout()
+{
+    appliedLayout.clear();
+}
+
+void DesktopController::positionItems(size_t count, const ItemIdView* itemids, const Vec2<int>* points)
+{
+    ShellStatus result = tryPositionItems(count, itemids, points);
+    if (!shellSucceeded(result))
+        throw ShellError("SelectAndPositionItems", result);
+}
+
+ShellStatus DesktopController::tryPositionItems(size_t count, const ItemIdView* itemids, const Vec2<int>* points)
+{
+    if (count == 0)
+        return shellOk;
+
+    return timeShellCall(ShellCall::SelectAndPositionItems, 
+        [&] { return backend->positionItems(count, itemids, points); });
+}
+
+DesktopController::HistoryScope::HistoryScope(
+    DesktopController& dcArg, 
+    size_t count, 
+    const ItemIdView* itemids, 
+    const Vec2<int>* points)
+    : dc(dcArg)
+    , accepted(false)
+{
+    if (!dc.history || dc.replayingHistory)
+        return;
+
+    step.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        // Icons whose position can't be read couldn't be put back, so they aren't recorded.
+        Vec2<int> before;
+        if (!shellSucceeded(dc.readItemPosition(itemids[i], before)))
+            continue;
+
+        if (before.x != points[i].x || before.y != points[i].y)
+            step.push_back({ itemIdKey(itemids[i]), before, points[i] });
+    }
+}
+
+DesktopController::HistoryScope::~HistoryScope()
+{
+    if (!accepted || step.empty() || !dc.history)
+        return;
+
+    // The scope may be ending because the call threw, so a failure to record is swallowed rather than thrown.
+    try
+    {
+        dc.history->record(std::move(step));
     }
-    else
+    catch (...)
     {
-        cout << "Warning: At least Windows 8.1 is required to set DPI awareness." << endl;
     }
 }
 
-bool DesktopController::Win81OrNewer()
+void DesktopController::enableLayoutHistory(size_t maxSteps)
+{
+    history = make_unique<LayoutHistory>(maxSteps);
+}
+
+void DesktopController::disableLayoutHistory()
 {
-    DWORD majorVersion, minorVersion;
-    std::tie(majorVersion, minorVersion) = getWindowsVersion();
+    history.reset();
+}
+
+size_t DesktopController::undoLayout()
+{
+    const vector<LayoutDelta>* step = (history ? history->undoStep() : nullptr);
+    if (!step)
+        return 0;
 
-    if (majorVersion == 6 && minorVersion >= 3)
-        return true;
-    else if (majorVersion > 6)
-        return true;
-    return false;
+    size_t moved = replayLayoutStep(*step, true);
+    history->markUndone();
+    return moved;
 }
 
-std::pair<DWORD, DWORD> DesktopController::getWindowsVersion()
+size_t DesktopController::redoLayout()
 {
-    OSVERSIONINFOEXW os;
+    const vector<LayoutDelta>* step = (history ? history->redoStep() : nullptr);
+    if (!step)
+        return 0;
 
-    typedef void (WINAPI* RtlGetVersion_FUNC) (OSVERSIONINFOEXW*);
-    RtlGetVersion_FUNC RtlGetVersion_DLL;
+    size_t moved = replayLayoutStep(*step, false);
+    history->markRedone();
+    return moved;
+}
 
-    HMODULE hmod = LoadLibrary(TEXT("ntdll.dll"));
-    if (hmod)
+size_t DesktopController::replayLayoutStep(const vector<LayoutDelta>& step, bool undo)
+{
+    unordered_map<uint64_t, Vec2<int>> targets;
+    targets.reserve(step.size());
+    for (auto& delta : step)
+        targets[delta.key] = (undo ? delta.before : delta.after);
+
+    // Cleared on exit, including when repositionByKey throws.
+    struct ReplayGuard
     {
-        RtlGetVersion_DLL = (RtlGetVersion_FUNC)GetProcAddress(hmod, "RtlGetVersion");
-        if (RtlGetVersion_DLL == NULL)
+        bool& flag;
+        explicit ReplayGuard(bool& f) : flag(f) { flag = true; }
+        ~ReplayGuard() { flag = false; }
+    } guard(replayingHistory);
+
+    return repositionByKey(targets);
+}
+
+int DesktopController::subscribeChanges(const function<void(const DesktopChange&)>& callback)
+{
+    if (!callback)
+        throw runtime_error("Invalid callback in subscribeChanges().");
+
+    if (changeCallbacks.empty())
+        backend->subscribeChanges();
+
+    int id = nextChangeCallbackId++;
+    changeCallbacks[id] = callback;
+    return id;
+}
+
+void DesktopController::unsubscribeChanges(int id)
+{
+    if (changeCallbacks.erase(id) != 0 && changeCallbacks.empty())
+        backend->unsubscribeChanges();
+}
+
+size_t DesktopController::processChanges()
+{
+    return backend->pollChanges([this](const ShellChange& shellChange)
         {
-            FreeLibrary(hmod);
-            throw runtime_error("Failed to get pointer to RtlGetVersion.");
+            DesktopChange change;
+            change.type = shellChange.type;
+            change.name = shellChange.name;
+            change.newName = shellChange.newName;
+
+            // Removed and renamed items are matched by the item ID they had, which also gives callbacks
+            // the name the item had if the backend couldn't name it.
+            patchNameIndex(change, shellChange.itemid);
+            pruneAppliedLayout(change, shellChange.itemid);
+
+            // Iterate over a copy since callbacks may subscribe or unsubscribe.
+            auto callbacks = changeCallbacks;
+            for (auto& callback : callbacks)
+                callback.second(change);
+        });
+}
+
+void DesktopController::patchNameIndex(DesktopChange& change, ItemIdView itemid)
+{
+    switch (change.type)
+    {
+    case DesktopChangeType::Removed:
+    case DesktopChangeType::Renamed:
+    {
+        // The Shell usually can't name an item which has already been deleted or renamed, so the entry
+        // is found by its item ID, which also gives callbacks the name the item had.
+        wstring indexedName = eraseIndexedItemID(itemid);
+        if (indexedName.empty())
+            nameIndex.erase(change.name);
+        else if (change.name.empty())
+            change.name = indexedName;
+
+        if (change.type == DesktopChangeType::Renamed)
+        {
+            // A renamed icon is indexed under its new name the first time it's looked up.
+            missingNames.erase(change.newName);
+            ++nameGeneration;
         }
-        ZeroMemory(&os, sizeof(os));
-        os.dwOSVersionInfoSize = sizeof(os);
-        RtlGetVersion_DLL(&os);
+        break;
+    }
+    case DesktopChangeType::Updated:
+        invalidateNameIndex();
+        ++nameGeneration;
+        break;
+    case DesktopChangeType::Added:
+        // Looking up a name which isn't indexed rebuilds the index, unless it was already missed.
+        missingNames.erase(change.name);
+        break;
+    case DesktopChangeType::Moved:
+        // Neither the name nor the item ID changes.
+        break;
     }
-    else
+}
+
+void DesktopController::pruneAppliedLayout(const DesktopChange& change, ItemIdView itemid)
+{
+    switch (change.type)
     {
-        throw runtime_error("Failed to load ntdll.dll.");
+    case DesktopChangeType::Removed:
+    case DesktopChangeType::Renamed:
+        // A renamed item's item ID changes, so its entry can't be found under the new key either.
+    case DesktopChangeType::Moved:
+        // The remembered position is no longer where the item is, so the next applyLayout() moves it back.
+        if (itemid.size() != 0)
+            appliedLayout.erase(itemIdKey(itemid));
+        break;
+    case DesktopChangeType::Updated:
+        appliedLayout.clear();
+        break;
+    case DesktopChangeType::Added:
+        break;
     }
+}
+
+wstring DesktopController::eraseIndexedItemID(ItemIdView itemid)
+{
+    if (itemid.size() == 0)
+        return wstring();
+
+    // A linear scan, but notifications are rare compared to lookups and this avoids enumerating the desktop.
+    for (auto it = nameIndex.begin(); it != nameIndex.end(); ++it)
+    {
+        if (ItemIdView(it->second) == itemid)
+        {
+            wstring name = it->first;
+            nameIndex.erase(it);
+            return name;
+        }
+    }
+
+    return wstring();
+}
+
+Vec2<int> DesktopController::iconSpacing() const
+{
+    Vec2<int> spacing(0, 0);
+    ShellStatus result = backend->spacing(spacing);
+    if (!shellSucceeded(result))
+        throw ShellError("GetSpacing", result);
+    return spacing;
+}
 
-    FreeLibrary(hmod);
+Vec2<int> DesktopController::desktopResolution() const
+{
+    return backend->desktopResolution();
+}
+
+DisplayConfiguration DesktopController::displayConfiguration() const
+{
+    DisplayConfiguration config;
+    config.resolution = backend->desktopResolution();
+    config.monitorCount = backend->monitorCount();
+    config.dpi = backend->systemDpi();
+    return config;
+}
+
+Vec2<int> DesktopController::cursorPosition() const
+{
+    return backend->cursorPosition();
+}
 
-    return make_pair(os.dwMajorVersion, os.dwMinorVersion);
+FolderFlags DesktopController::folderFlags() const
+{
+    FolderFlags flags;
+    ShellStatus result = backend->folderFlags(flags);
+    if (!shellSucceeded(result))
+        throw ShellError("GetCurrentInfo", result);
+
+    return flags;
+}
+
+void DesktopController::refresh()
+{
+    invalidateNameIndex();
+    appliedLayout.clear();
+    ++nameGeneration;
+    backend->refresh();
 }
 
 // deskctrl pybind11 module definition.
@@ -380,12 +1131,36 @@ std::pair<DWORD, DWORD> DesktopController::getWindowsVersion()
 
 void InitUtil_pybind11(pybind11::module&);
 void InitDesktopIcon_pybind11(pybind11::module&);
+void InitDesktopSnapshot_pybind11(pybind11::module&);
+void InitIconSearchIndex_pybind11(pybind11::module&);
+void InitRepositionWorker_pybind11(pybind11::module&);
+void InitIconAnimator_pybind11(pybind11::module&);
+void InitShellCallMetrics_pybind11(pybind11::module&);
+void InitShellBackend_pybind11(pybind11::module&);
+void InitMemoryShellBackend_pybind11(pybind11::module&);
+void InitAdaptiveChunker_pybind11(pybind11::module&);
+void InitLayoutFile_pybind11(pybind11::module&);
+void InitLayoutProfileStore_pybind11(pybind11::module&);
+void InitSlotAssignment_pybind11(pybind11::module&);
+void InitLayoutHistory_pybind11(pybind11::module&);
 void DesktopController_pybind11(pybind11::module&);
 
 PYBIND11_MODULE(deskctrl, m) 
 {
     InitUtil_pybind11(m);
     InitDesktopIcon_pybind11(m);
+    InitDesktopSnapshot_pybind11(m);
+    InitIconSearchIndex_pybind11(m);
+    InitRepositionWorker_pybind11(m);
+    InitIconAnimator_pybind11(m);
+    InitShellCallMetrics_pybind11(m);
+    InitShellBackend_pybind11(m);
+    InitMemoryShellBackend_pybind11(m);
+    InitAdaptiveChunker_pybind11(m);
+    InitLayoutFile_pybind11(m);
+    InitLayoutProfileStore_pybind11(m);
+    InitSlotAssignment_pybind11(m);
+    InitLayoutHistory_pybind11(m);
     DesktopController_pybind11(m);
 }
 #endif
@@ -3,6 +3,7 @@
 #include <pybind11/stl.h>
 #include <pybind11/stl_bind.h>
 #include <pybind11/functional.h>
+#include <pybind11/chrono.h>
 
 #include "DesktopController.h"
 
@@ -10,32 +11,106 @@ namespace py = pybind11;
 
 void DesktopController_pybind11(py::module& m)
 {
-#ifdef ENABLE_VIEW_MODE
-    py::enum_<ViewMode>(m, "ViewMode")  // Strongly typed enum.
-        .value("Small", ViewMode::Small)
-        .value("Medium", ViewMode::Medium)
-        .value("Large", ViewMode::Large);
-#endif
+    py::class_<EnumerationOptions>(m, "EnumerationOptions")
+        .def(py::init<>())
+        .def_readwrite("selectedOnly", &EnumerationOptions::selectedOnly)
+        .def_readwrite("namePrefix", &EnumerationOptions::namePrefix)
+        .def_readwrite("extension", &EnumerationOptions::extension);
 
-    py::class_<FolderFlags>(m, "FolderFlags")
+    py::class_<VerifyOptions>(m, "VerifyOptions")
         .def(py::init<>())
-        .def_readonly("autoArrange", &FolderFlags::autoArrange)
-        .def_readonly("snapToGrid", &FolderFlags::snapToGrid);
+        .def_readwrite("maxRetries", &VerifyOptions::maxRetries)
+        .def_readwrite("tolerance", &VerifyOptions::tolerance)
+        .def_readwrite("settleDelay", &VerifyOptions::settleDelay);
+
+    py::class_<PlacementFailure>(m, "PlacementFailure")
+        .def_readonly("index", &PlacementFailure::index)
+        .def_readonly("target", &PlacementFailure::target)
+        .def_readonly("actual", &PlacementFailure::actual)
+        .def_readonly("status", &PlacementFailure::status);
+
+    py::class_<VerifiedRepositionReport>(m, "VerifiedRepositionReport")
+        .def_readonly("batches", &VerifiedRepositionReport::batches)
+        .def_readonly("placed", &VerifiedRepositionReport::placed)
+        .def_readonly("failures", &VerifiedRepositionReport::failures);
+
+    py::enum_<DesktopChangeType>(m, "DesktopChangeType")
+        .value("Added", DesktopChangeType::Added)
+        .value("Removed", DesktopChangeType::Removed)
+        .value("Renamed", DesktopChangeType::Renamed)
+        .value("Moved", DesktopChangeType::Moved)
+        .value("Updated", DesktopChangeType::Updated);
+
+    py::class_<DesktopChange>(m, "DesktopChange")
+        .def_readonly("type", &DesktopChange::type)
+        .def_readonly("name", &DesktopChange::name)
+        .def_readonly("newName", &DesktopChange::newName);
 
     py::class_<DesktopController>(m, "DesktopController")
+#ifdef _WIN32
         .def(py::init<>())
-#ifdef ENABLE_VIEW_MODE
-        .def("viewMode", &DesktopController::viewMode, "Get the current view mode.")
 #endif
+        .def(py::init<std::shared_ptr<ShellBackend>>(), "Access the desktop through the given backend, e.g. a MemoryShellBackend.")
         .def("enumerateIcons", &DesktopController::enumerateIcons, "Iterate over all desktop icons.")
+        .def("enumerateIconsWhere", &DesktopController::enumerateIconsWhere, "Iterate over desktop icons matching the given options. Return False from the callback to stop.")
+        .def("enumerateIconsBatched", &DesktopController::enumerateIconsBatched, "Iterate over all desktop icons, fetching several at a time.")
         .def("iconByName", &DesktopController::iconByName, "Get a desktop icon which matches the given name exactly.")
+        .def("iconsByNames", &DesktopController::iconsByNames, "Find several icons by name in one pass. Returns None for names which aren't found.")
         .def("allIcons", &DesktopController::allIcons, "Get all desktop icons present on the desktop.")
+        .def("allIconsValue", &DesktopController::allIconsValue, "Get all desktop icons present on the desktop, stored by value.")
+        .def("snapshot", &DesktopController::snapshot, "Capture the names and positions of all desktop icons in one pass.")
         .def("folderFlags", &DesktopController::folderFlags, "Get the current desktop folder flags.")
         .def("cursorPosition", &DesktopController::cursorPosition, "Get the current position of the cursor.")
         .def("desktopResolution", &DesktopController::desktopResolution, "Get the resolution of the desktop.")
+        .def("displayConfiguration", &DesktopController::displayConfiguration, "Get the resolution, monitor count and DPI of the display.")
         .def("iconSpacing", &DesktopController::iconSpacing, "Get the dimensions of desktop icons in pixels, including surrounding whitespace.")
-        .def("repositionIcons", &DesktopController::repositionIcons, "Set the position of one or more icons.")
-        .def("refresh", &DesktopController::refresh, "Notify the system that the contents of the desktop folder has changed.");
+        .def("positionsOf", 
+            [](const DesktopController& dc, const std::vector<DesktopIcon*>& icons)
+            {
+                std::vector<DcUtil::Vec2<int>> positions;
+                std::vector<ShellStatus> status;
+                dc.positionsOf(icons, positions, status);
+                return std::make_pair(positions, status);
+            }, 
+            "Get the positions of several icons. Returns a tuple of (positions, status codes).")
+        .def("allIconPositions", 
+            [](DesktopController& dc)
+            {
+                std::vector<DcUtil::Vec2<int>> positions;
+                std::vector<ShellStatus> status;
+                dc.allIconPositions(positions, status);
+                return std::make_pair(positions, status);
+            }, 
+            "Get the positions of all icons in enumeration order. Returns a tuple of (positions, status codes).")
+        .def("applyLayout", &DesktopController::applyLayout, "Set the position of icons, skipping those already at the position last applied. Returns the number skipped.")
+        .def("forgetAppliedLayout", &DesktopController::forgetAppliedLayout, "Forget the positions remembered by applyLayout.")
+        .def("repositionIcons", 
+            py::overload_cast<const std::vector<DesktopIcon*>&, std::vector<DcUtil::Vec2<int>>&>(&DesktopController::repositionIcons), 
+            "Set the position of one or more icons.")
+        .def("repositionIcons", 
+            py::overload_cast<const DesktopSnapshot&, const std::vector<size_t>&, std::vector<DcUtil::Vec2<int>>&>(&DesktopController::repositionIcons), 
+            "Set the position of one or more icons in a snapshot, given their indices.")
+        .def("repositionIconsVerified", &DesktopController::repositionIconsVerified, 
+            py::arg("icons"), py::arg("points"), py::arg("options") = VerifyOptions(),
+            "Set the position of icons, read them back and retry those which didn't land. Returns a report of icons which couldn't be placed.")
+        .def("repositionIconsChunked", &DesktopController::repositionIconsChunked, 
+            py::arg("icons"), py::arg("points"), py::arg("options") = ChunkingOptions(),
+            "Set the position of many icons in adaptively sized chunks. Returns the time taken by each chunk.")
+        .def("tidyIcons", &DesktopController::tidyIcons, "Move icons in to a set of slots with the least total movement. Only icons not already at their slot are moved.")
+        .def("restoreLayout", &DesktopController::restoreLayout, "Apply a layout file opened with LayoutFileView. Returns the number of icons moved.")
+        .def("repositionByName", &DesktopController::repositionByName, py::arg("targets"), py::arg("skipUnmoved") = false, 
+            "Set the position of icons given a dict of display names to positions. Returns the number moved.")
+        .def("repositionByKey", &DesktopController::repositionByKey, "Set the position of icons given a dict of identity keys to positions. Returns the number moved.")
+        .def("enableLayoutHistory", &DesktopController::enableLayoutHistory, "Start recording icon movements so they can be undone.")
+        .def("disableLayoutHistory", &DesktopController::disableLayoutHistory, "Stop recording icon movements and discard the history.")
+        .def("layoutHistory", &DesktopController::layoutHistory, py::return_value_policy::reference_internal, "Get the layout history, or None if it isn't enabled.")
+        .def("undoLayout", &DesktopController::undoLayout, "Move the icons in the most recent step back. Returns the number of icons found and moved, 0 if none were or there was nothing to undo.")
+        .def("redoLayout", &DesktopController::redoLayout, "Reapply the most recently undone step. Returns the number of icons found and moved, 0 if none were or there was nothing to redo.")
+        .def("refresh", &DesktopController::refresh, "Notify the system that the contents of the desktop folder has changed.")
+        .def("invalidateNameIndex", &DesktopController::invalidateNameIndex, "Discard the name index used by iconByName.")
+        .def("subscribeChanges", &DesktopController::subscribeChanges, "Subscribe to icons being added, removed or renamed. Returns a subscription ID.")
+        .def("unsubscribeChanges", &DesktopController::unsubscribeChanges, "Remove a subscription added by subscribeChanges.")
+        .def("processChanges", &DesktopController::processChanges, "Deliver queued desktop changes to subscribers.");
 }
 
 #endif
\ No newline at end of file
@@ -5,31 +5,80 @@ using namespace std;
 using namespace DcUtil;
 
 DesktopIcon::DesktopIcon(
-    IShellFolder* shellFolderArg,
-    IFolderView* folderViewArg,
-    CComHeapPtr<ITEMID_CHILD> itemIdArg) 
-        : shellfolder(shellFolderArg)
-        , folderview(folderViewArg)
-        , itemid(itemIdArg)
+    ShellBackend* backendArg,
+    ItemId itemIdArg,
+    const unsigned long* nameGenerationArg) 
+        : backend(backendArg)
+        , itemid(std::move(itemIdArg))
+        , identityKey(itemid.empty() ? 0 : itemIdKey(itemid))
+        , nameGeneration(nameGenerationArg)
+        , cachedNameGeneration(0)
+        , nameCached(false)
 {
 }
 
-DesktopIcon::~DesktopIcon()
+DesktopIcon::DesktopIcon(DesktopIcon&& other) noexcept
+    : backend(other.backend)
+    , itemid(std::move(other.itemid))
+    , identityKey(other.identityKey)
+    , nameGeneration(other.nameGeneration)
+    , cachedName(std::move(other.cachedName))
+    , cachedNameGeneration(other.cachedNameGeneration)
+    , nameCached(other.nameCached)
 {
-    if (itemid)
-        itemid.Free();
+    other.nameCached = false;
 }
 
-std::wstring DesktopIcon::displayName() const
+DesktopIcon& DesktopIcon::operator=(DesktopIcon&& other) noexcept
+{
+    if (this != &other)
+    {
+        backend = other.backend;
+        itemid = std::move(other.itemid);
+        identityKey = other.identityKey;
+        nameGeneration = other.nameGeneration;
+        cachedName = std::move(other.cachedName);
+        cachedNameGeneration = other.cachedNameGeneration;
+        nameCached = other.nameCached;
+        other.nameCached = false;
+    }
+    return *this;
+}
+
+wstring DesktopIcon::displayName() const
 { 
-    return DesktopController::shellFolderObjNameToStrW(shellfolder, itemid);
+    wstring name;
+    ShellStatus result = timeShellCall(ShellCall::GetDisplayNameOf, [&] { return backend->displayName(itemid, ShellNameKind::Display, name); });
+    if (!shellSucceeded(result))
+        throw ShellError("GetDisplayNameOf", result);
+
+    return name;
+}
+
+const wstring& DesktopIcon::cachedDisplayName() const
+{
+    unsigned long generation = (nameGeneration ? *nameGeneration : 0);
+
+    if (!nameCached || cachedNameGeneration != generation)
+    {
+        cachedName = displayName();
+        cachedNameGeneration = generation;
+        nameCached = true;
+    }
+
+    return cachedName;
+}
+
+void DesktopIcon::invalidateDisplayName() const
+{
+    nameCached = false;
 }
 
 Vec2<int> DesktopIcon::position() const
 {
-    POINT pt;
-    folderview->GetItemPosition(itemid, &pt);
-    return Vec2<int>(pt.x, pt.y); 
+    Vec2<int> pt;
+    timeShellCall(ShellCall::GetItemPosition, [&] { return backend->itemPosition(itemid, pt); });
+    return pt; 
 }
 
 // Prefer DesktopController::repositionIcons (for multiple icons) over this. 
@@ -37,7 +86,6 @@ Vec2<int> DesktopIcon::position() const
 // to position multiple items at once.
 void DesktopIcon::reposition(const Vec2<int>& point) const 
 {
-    PCITEMID_CHILD itemIdList[1] = { itemid };
-    POINT pt = { point.x, point.y };
-    folderview->SelectAndPositionItems(1, itemIdList, &pt, SVSI_POSITIONITEM);
+    ItemIdView itemIdList[1] = { itemid };
+    timeShellCall(ShellCall::SelectAndPositionItems, [&] { return backend->positionItems(1, itemIdList, &point); });
 }
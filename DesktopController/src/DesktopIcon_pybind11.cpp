@@ -10,6 +10,9 @@ void InitDesktopIcon_pybind11(py::module& m)
 {
     py::class_<DesktopIcon, std::unique_ptr<DesktopIcon>>(m, "DesktopIcon")
         .def("displayName", &DesktopIcon::displayName, "Display name of icon.")
+        .def("cachedDisplayName", &DesktopIcon::cachedDisplayName, "Display name of icon, cached after the first call.")
+        .def("invalidateDisplayName", &DesktopIcon::invalidateDisplayName, "Discard the name cached by cachedDisplayName.")
+        .def("key", &DesktopIcon::key, "64-bit key identifying the icon, derived from its item ID.")
         .def("position", &DesktopIcon::position, "Get the position of icon.")
         .def("reposition", &DesktopIcon::reposition, "Set the position of an icon.");
 }
@@ -0,0 +1,166 @@
+#include "DesktopController.h"
+#include "DesktopSnapshot.h"
+
+#include <cstring>
+#include <unordered_map>
+#include <functional>
+
+using namespace std;
+using namespace DcUtil;
+
+const uint32_t SnapshotChange::npos;
+
+// Item IDs in the arena start on multiples of this, so they're suitably aligned for the Shell.
+static const size_t itemIdAlignment = sizeof(void*);
+
+ItemIdView DesktopSnapshot::itemID(size_t i) const
+{
+    return ItemIdView(itemIdArena.data() + itemIdOffsets.at(i), itemIdSizes[i]);
+}
+
+void DesktopSnapshot::reserve(size_t n)
+{
+    nameColumn.reserve(n);
+    positionColumn.reserve(n);
+    keyColumn.reserve(n);
+    itemIdOffsets.reserve(n);
+    itemIdSizes.reserve(n);
+}
+
+void DesktopSnapshot::append(ItemIdView itemid, wstring name, const Vec2<int>& position)
+{
+    const size_t size = itemid.size();
+    const size_t offset = (itemIdArena.size() + itemIdAlignment - 1) & ~(itemIdAlignment - 1);
+
+    itemIdArena.resize(offset + size);
+    if (size != 0)
+        memcpy(itemIdArena.data() + offset, itemid.data(), size);
+
+    itemIdOffsets.push_back(offset);
+    itemIdSizes.push_back(static_cast<uint32_t>(size));
+    nameColumn.push_back(std::move(name));
+    positionColumn.push_back(position);
+    keyColumn.push_back(itemIdKey(itemid));
+}
+
+namespace
+{
+    // Hashes the string pointed to, so names can be used as keys without being copied.
+    struct NameRefHash
+    {
+        size_t operator()(const wstring* s) const { return hash<wstring>()(*s); }
+    };
+
+    struct NameRefEqual
+    {
+        bool operator()(const wstring* a, const wstring* b) const { return *a == *b; }
+    };
+
+    // A hash table from keys to chains of indices. Indices which share a key are 
+    // returned by take() in ascending order.
+    template <typename Key, typename Hash = hash<Key>, typename Equal = equal_to<Key>>
+    class IndexChains
+    {
+    public:
+        explicit IndexChains(size_t indexCount)
+            : next(indexCount, SnapshotChange::npos)
+        {
+            heads.reserve(indexCount);
+        }
+
+        // Indices must be added in descending order.
+        void add(const Key& key, uint32_t index)
+        {
+            auto result = heads.emplace(key, index);
+            if (!result.second)
+            {
+                next[index] = result.first->second;
+                result.first->second = index;
+            }
+        }
+
+        // Removes and returns the lowest index with this key, or npos.
+        uint32_t take(const Key& key)
+        {
+            auto it = heads.find(key);
+            if (it == heads.end() || it->second == SnapshotChange::npos)
+                return SnapshotChange::npos;
+
+            uint32_t index = it->second;
+            it->second = next[index];
+            return index;
+        }
+
+    private:
+        unordered_map<Key, uint32_t, Hash, Equal> heads;
+        vector<uint32_t> next;
+    };
+}
+
+vector<SnapshotChange> diffSnapshots(const DesktopSnapshot& before, const DesktopSnapshot& after)
+{
+    if (before.size() >= SnapshotChange::npos || after.size() >= SnapshotChange::npos)
+        throw runtime_error("Snapshot too large in diffSnapshots().");
+
+    const uint32_t beforeCount = static_cast<uint32_t>(before.size());
+    const uint32_t afterCount = static_cast<uint32_t>(after.size());
+
+    vector<SnapshotChange> changes;
+
+    // An icon whose key is in both snapshots is the same item: its item ID hasn't changed.
+    IndexChains<uint64_t> afterByKey(afterCount);
+    for (uint32_t i = afterCount; i-- > 0; )
+        afterByKey.add(after.key(i), i);
+
+    vector<bool> afterMatched(afterCount, false);
+    vector<uint32_t> unmatchedBefore;
+
+    for (uint32_t i = 0; i < beforeCount; ++i)
+    {
+        uint32_t match = afterByKey.take(before.key(i));
+        if (match == SnapshotChange::npos)
+        {
+            unmatchedBefore.push_back(i);
+            continue;
+        }
+
+        afterMatched[match] = true;
+
+        if (before.name(i) != after.name(match))
+            changes.push_back({ SnapshotChangeType::Renamed, i, match });
+        else if (before.position(i) != after.position(match))
+            changes.push_back({ SnapshotChangeType::Moved, i, match });
+    }
+
+    // Icons whose key changed are paired by name, e.g. a file whose item ID changed because it was edited.
+    // A rename changes both, so it can't be told from a removal and an addition and is reported as those.
+    IndexChains<const wstring*, NameRefHash, NameRefEqual> unmatchedAfterByName(afterCount);
+    for (uint32_t i = afterCount; i-- > 0; )
+    {
+        if (!afterMatched[i])
+            unmatchedAfterByName.add(&after.name(i), i);
+    }
+
+    for (uint32_t i : unmatchedBefore)
+    {
+        uint32_t match = unmatchedAfterByName.take(&before.name(i));
+        if (match == SnapshotChange::npos)
+        {
+            changes.push_back({ SnapshotChangeType::Removed, i, SnapshotChange::npos });
+            continue;
+        }
+
+        afterMatched[match] = true;
+
+        if (before.position(i) != after.position(match))
+            changes.push_back({ SnapshotChangeType::Moved, i, match });
+    }
+
+    for (uint32_t i = 0; i < afterCount; ++i)
+    {
+        if (!afterMatched[i])
+            changes.push_back({ SnapshotChangeType::Added, SnapshotChange::npos, i });
+    }
+
+    return changes;
+}
@@ -0,0 +1,38 @@
+#ifdef PYBIND11_BUILD
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "DesktopController.h"
+
+namespace py = pybind11;
+using namespace DcUtil;
+
+void InitDesktopSnapshot_pybind11(py::module& m)
+{
+    py::class_<DesktopSnapshot>(m, "DesktopSnapshot")
+        .def(py::init<>())
+        .def("size", &DesktopSnapshot::size, "Number of icons in the snapshot.")
+        .def("__len__", &DesktopSnapshot::size)
+        .def("name", &DesktopSnapshot::name, "Display name of the icon at the given index.")
+        .def("position", &DesktopSnapshot::position, "Position of the icon at the given index.")
+        .def("key", &DesktopSnapshot::key, "Identity key of the icon at the given index.")
+        .def("keys", &DesktopSnapshot::keys, "Identity keys of all icons in the snapshot.")
+        .def("names", &DesktopSnapshot::names, "Display names of all icons in the snapshot.")
+        .def("positions", &DesktopSnapshot::positions, "Positions of all icons in the snapshot.");
+
+    py::enum_<SnapshotChangeType>(m, "SnapshotChangeType")
+        .value("Added", SnapshotChangeType::Added)
+        .value("Removed", SnapshotChangeType::Removed)
+        .value("Moved", SnapshotChangeType::Moved)
+        .value("Renamed", SnapshotChangeType::Renamed);
+
+    py::class_<SnapshotChange>(m, "SnapshotChange")
+        .def_readonly("type", &SnapshotChange::type)
+        .def_readonly("beforeIndex", &SnapshotChange::beforeIndex)
+        .def_readonly("afterIndex", &SnapshotChange::afterIndex)
+        .def_readonly_static("npos", &SnapshotChange::npos);
+
+    m.def("diffSnapshots", &diffSnapshots, "List the icons added, removed, moved or renamed between two snapshots.");
+}
+
+#endif
@@ -0,0 +1,163 @@
+#include "DesktopController.h"
+#include "IconAnimator.h"
+
+#include <thread>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+using namespace std::chrono;
+using namespace DcUtil;
+
+namespace
+{
+    // Weight given to the newest measurement in the moving average of frame costs.
+    const double frameCostSmoothing = 0.25;
+
+    IconAnimator::Clock::duration secondsToDuration(double seconds)
+    {
+        return duration_cast<IconAnimator::Clock::duration>(duration<double>(seconds));
+    }
+}
+
+double applyEasing(Easing easing, double t)
+{
+    t = min(max(t, 0.0), 1.0);
+
+    switch (easing)
+    {
+    case Easing::EaseIn:
+        return t * t;
+    case Easing::EaseOut:
+        return t * (2.0 - t);
+    case Easing::EaseInOut:
+        if (t < 0.5)
+            return 4.0 * t * t * t;
+        else
+        {
+            double u = 2.0 * t - 2.0;
+            return 0.5 * u * u * u + 1.0;
+        }
+    case Easing::Linear:
+    default:
+        return t;
+    }
+}
+
+IconAnimator::IconAnimator(DesktopController& controller, const vector<DesktopIcon*>& icons)
+    : IconAnimator([&controller, icons](const vector<Vec2<int>>& points) { controller.applyLayout(icons, points); })
+{
+}
+
+IconAnimator::IconAnimator(FrameFunction applyFrame, NowFunction now, SleepFunction sleep)
+    : applyFrame(std::move(applyFrame))
+    , now(std::move(now))
+    , sleep(std::move(sleep))
+    , frameCostRatio(2.0)
+    , averageFrameCost(0.0)
+    , haveFrameCost(false)
+{
+    if (!this->applyFrame)
+        throw runtime_error("IconAnimator requires a frame function");
+
+    if (!this->now)
+        this->now = [] { return Clock::now(); };
+
+    if (!this->sleep)
+        this->sleep = [](Clock::duration d) { this_thread::sleep_for(d); };
+
+    setFrameRateLimits(10.0, 60.0);
+}
+
+void IconAnimator::setFrameRateLimits(double minFramesPerSecond, double maxFramesPerSecond)
+{
+    if (minFramesPerSecond <= 0.0 || maxFramesPerSecond < minFramesPerSecond)
+        throw runtime_error("Invalid frame rate limits in IconAnimator::setFrameRateLimits");
+
+    minInterval = secondsToDuration(1.0 / maxFramesPerSecond);
+    maxInterval = secondsToDuration(1.0 / minFramesPerSecond);
+}
+
+void IconAnimator::setFrameCostRatio(double ratio)
+{
+    if (ratio < 1.0)
+        throw runtime_error("Frame cost ratio must be at least 1");
+
+    frameCostRatio = ratio;
+}
+
+IconAnimator::Clock::duration IconAnimator::frameInterval() const
+{
+    if (!haveFrameCost)
+        return minInterval;
+
+    return clampInterval(secondsToDuration(averageFrameCost * frameCostRatio));
+}
+
+IconAnimator::Clock::duration IconAnimator::clampInterval(Clock::duration interval) const
+{
+    return min(max(interval, minInterval), maxInterval);
+}
+
+AnimationStats IconAnimator::animate(
+    const vector<Vec2<int>>& start,
+    const vector<Vec2<int>>& end,
+    Clock::duration duration,
+    Easing easing)
+{
+    if (start.size() != end.size())
+        throw runtime_error("Argument size mismatch in IconAnimator::animate");
+
+    AnimationStats stats;
+    vector<Vec2<int>> points(start.size());
+
+    const Clock::time_point animationStart = now();
+    const Clock::time_point animationEnd = animationStart + duration;
+
+    for (;;)
+    {
+        const Clock::time_point frameStart = now();
+
+        // Progress is derived from the clock rather than the frame number, so slow frames
+        // make the animation coarser, not longer.
+        double t = 1.0;
+        if (duration.count() > 0 && frameStart < animationEnd)
+            t = duration_cast<std::chrono::duration<double>>(frameStart - animationStart).count() /
+                duration_cast<std::chrono::duration<double>>(duration).count();
+
+        const double eased = applyEasing(easing, t);
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+            points[i].x = static_cast<int>(lround(start[i].x + (end[i].x - start[i].x) * eased));
+            points[i].y = static_cast<int>(lround(start[i].y + (end[i].y - start[i].y) * eased));
+        }
+
+        applyFrame(points);
+
+        const Clock::time_point frameEnd = now();
+        const Clock::duration cost = frameEnd - frameStart;
+        const double costSeconds = duration_cast<std::chrono::duration<double>>(cost).count();
+
+        averageFrameCost = haveFrameCost ? 
+            averageFrameCost + (costSeconds - averageFrameCost) * frameCostSmoothing : 
+            costSeconds;
+        haveFrameCost = true;
+
+        ++stats.frames;
+        stats.totalFrameCost += cost;
+        stats.maxFrameCost = max(stats.maxFrameCost, cost);
+
+        if (t >= 1.0)
+        {
+            stats.elapsed = frameEnd - animationStart;
+            break;
+        }
+
+        // Never schedule past the end, so the final frame lands on time.
+        const Clock::time_point nextFrame = min(frameStart + frameInterval(), animationEnd);
+        if (nextFrame > frameEnd)
+            sleep(nextFrame - frameEnd);
+    }
+
+    return stats;
+}
@@ -0,0 +1,39 @@
+#ifdef PYBIND11_BUILD
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <pybind11/chrono.h>
+
+#include "DesktopController.h"
+#include "IconAnimator.h"
+
+namespace py = pybind11;
+using namespace DcUtil;
+
+void InitIconAnimator_pybind11(py::module& m)
+{
+    py::enum_<Easing>(m, "Easing")
+        .value("Linear", Easing::Linear)
+        .value("EaseIn", Easing::EaseIn)
+        .value("EaseOut", Easing::EaseOut)
+        .value("EaseInOut", Easing::EaseInOut);
+
+    m.def("applyEasing", &applyEasing, "Map linear animation progress (0-1) to eased progress.");
+
+    py::class_<AnimationStats>(m, "AnimationStats")
+        .def_readonly("frames", &AnimationStats::frames)
+        .def_readonly("elapsed", &AnimationStats::elapsed)
+        .def_readonly("totalFrameCost", &AnimationStats::totalFrameCost)
+        .def_readonly("maxFrameCost", &AnimationStats::maxFrameCost);
+
+    // Only the DesktopController constructor is exposed. The icons are kept alive by the animator.
+    py::class_<IconAnimator>(m, "IconAnimator")
+        .def(py::init<DesktopController&, const std::vector<DesktopIcon*>&>(), py::keep_alive<1, 2>(), py::keep_alive<1, 3>())
+        .def("setFrameRateLimits", &IconAnimator::setFrameRateLimits, "Set the range the frame rate adapts within.")
+        .def("setFrameCostRatio", &IconAnimator::setFrameCostRatio, "Set how many times the average frame cost the interval between frames is.")
+        .def("animate", &IconAnimator::animate, 
+            py::arg("start"), py::arg("end"), py::arg("duration"), py::arg("easing") = Easing::EaseInOut,
+            "Animate between two layouts. Blocks until the animation has finished.")
+        .def("frameInterval", &IconAnimator::frameInterval, "Interval between frames the last animation finished with.");
+}
+
+#endif
@@ -0,0 +1,397 @@
+#include "DesktopController.h"
+#include "IconSearchIndex.h"
+
+#include <algorithm>
+#include <unordered_set>
+#include <cwctype>
+
+using namespace std;
+using namespace DcUtil;
+
+namespace
+{
+    bool isWordSeparator(wchar_t c)
+    {
+        return c == L' ' || c == L'.' || c == L'_' || c == L'-' || c == L'(' || c == L'[';
+    }
+
+    // Wildcard match of the whole of s against pattern p ('*' and '?').
+    bool globMatch(const wchar_t* p, const wchar_t* s)
+    {
+        const wchar_t* star = nullptr;
+        const wchar_t* starMatch = nullptr;
+
+        while (*s)
+        {
+            if (*p == L'?' || (*p != L'*' && *p == *s))
+            {
+                ++p;
+                ++s;
+            }
+            else if (*p == L'*')
+            {
+                // Initially match nothing, extend the match on backtracking.
+                star = p++;
+                starMatch = s;
+            }
+            else if (star)
+            {
+                p = star + 1;
+                s = ++starMatch;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        while (*p == L'*')
+            ++p;
+
+        return *p == L'\0';
+    }
+
+    // Returns a score for query as a subsequence of name, or -1 if it isn't one.
+    int subsequenceScore(const wstring& query, const wstring& name)
+    {
+        const size_t none = wstring::npos;
+
+        int score = 0;
+        size_t qi = 0;
+        size_t lastMatch = none;
+
+        for (size_t ni = 0; ni < name.size() && qi < query.size(); ++ni)
+        {
+            if (name[ni] != query[qi])
+                continue;
+
+            int bonus = 1;
+            if (ni == 0 || isWordSeparator(name[ni - 1]))
+                bonus += 8;
+            if (lastMatch != none && lastMatch + 1 == ni)
+                bonus += 5;
+
+            score += bonus;
+            lastMatch = ni;
+            ++qi;
+        }
+
+        if (qi < query.size())
+            return -1;
+
+        // Prefer shorter names among equally good matches.
+        return max(0, score * 256 - static_cast<int>(name.size()));
+    }
+}
+
+void IconSearchIndex::assign(const DesktopSnapshot& snap)
+{
+    clear();
+    entries.reserve(snap.size());
+    entryIndex.reserve(snap.size());
+
+    for (size_t i = 0; i < snap.size(); ++i)
+        insert(snap.key(i), snap.name(i));
+}
+
+void IconSearchIndex::update(
+    const DesktopSnapshot& before, 
+    const DesktopSnapshot& after, 
+    const vector<SnapshotChange>& changes)
+{
+    vector<bool> reportedBefore(before.size(), false);
+    vector<bool> reportedAfter(after.size(), false);
+
+    for (const SnapshotChange& change : changes)
+    {
+        if (change.beforeIndex != SnapshotChange::npos)
+            reportedBefore[change.beforeIndex] = true;
+        if (change.afterIndex != SnapshotChange::npos)
+            reportedAfter[change.afterIndex] = true;
+
+        switch (change.type)
+        {
+        case SnapshotChangeType::Added:
+            insert(after.key(change.afterIndex), after.name(change.afterIndex));
+            break;
+        case SnapshotChangeType::Removed:
+            erase(before.key(change.beforeIndex));
+            break;
+        case SnapshotChangeType::Renamed:
+            erase(before.key(change.beforeIndex));
+            insert(after.key(change.afterIndex), after.name(change.afterIndex));
+            break;
+        case SnapshotChangeType::Moved:
+            rekey(before.key(change.beforeIndex), after.key(change.afterIndex));
+            break;
+        }
+    }
+
+    // Icons which weren't reported are unchanged, but their keys may still differ, e.g. when a file is edited
+    // its item ID changes. Usually every such key is already indexed, which is checked without touching names.
+    vector<size_t> unindexed;
+    for (size_t j = 0; j < after.size(); ++j)
+    {
+        if (!reportedAfter[j] && entryIndex.find(after.key(j)) == entryIndex.end())
+            unindexed.push_back(j);
+    }
+
+    if (unindexed.empty())
+        return;
+
+    // Pair the remaining icons as diffSnapshots() does: the nth unreported icon whose key isn't in after
+    // matches the nth unreported icon with the same name in after. Only the names of re-keyed icons are tracked.
+    unordered_map<wstring, vector<size_t>> beforeByName;
+    for (size_t j : unindexed)
+        beforeByName.emplace(after.name(j), vector<size_t>());
+
+    unordered_set<uint64_t> afterKeys(after.keys().begin(), after.keys().end());
+
+    for (size_t i = 0; i < before.size(); ++i)
+    {
+        if (reportedBefore[i] || afterKeys.count(before.key(i)) != 0)
+            continue;
+
+        auto it = beforeByName.find(before.name(i));
+        if (it != beforeByName.end())
+            it->second.push_back(i);
+    }
+
+    // The unindexed icons are exactly the unreported ones whose key isn't in before, in enumeration order.
+    unordered_map<wstring, size_t> occurrences;
+    for (size_t j : unindexed)
+    {
+        auto it = beforeByName.find(after.name(j));
+        size_t occurrence = occurrences[it->first]++;
+        if (occurrence < it->second.size())
+            rekey(before.key(it->second[occurrence]), after.key(j));
+    }
+}
+
+void IconSearchIndex::insert(uint64_t key, const wstring& name)
+{
+    auto it = entryIndex.find(key);
+    if (it != entryIndex.end())
+    {
+        Entry& entry = entries[it->second];
+        entry.name = name;
+        entry.normalized = normalize(name);
+        return;
+    }
+
+    entryIndex.emplace(key, entries.size());
+    entries.push_back({ key, name, normalize(name) });
+}
+
+void IconSearchIndex::erase(uint64_t key)
+{
+    auto it = entryIndex.find(key);
+    if (it == entryIndex.end())
+        return;
+
+    // Swap the last entry in to the erased slot to keep entries contiguous.
+    size_t index = it->second;
+    entryIndex.erase(it);
+
+    if (index != entries.size() - 1)
+    {
+        entries[index] = std::move(entries.back());
+        entryIndex[entries[index].key] = index;
+    }
+    entries.pop_back();
+}
+
+void IconSearchIndex::rekey(uint64_t oldKey, uint64_t newKey)
+{
+    if (oldKey == newKey)
+        return;
+
+    auto it = entryIndex.find(oldKey);
+    if (it == entryIndex.end())
+        return;
+
+    // Should newKey already be indexed, the newer entry is kept.
+    if (entryIndex.find(newKey) != entryIndex.end())
+    {
+        erase(oldKey);
+        return;
+    }
+
+    size_t index = it->second;
+    entryIndex.erase(it);
+    entryIndex.emplace(newKey, index);
+    entries[index].key = newKey;
+}
+
+void IconSearchIndex::clear()
+{
+    entries.clear();
+    entryIndex.clear();
+}
+
+template <typename Scorer>
+vector<IconSearchResult> IconSearchIndex::rank(size_t maxResults, Scorer scorer) const
+{
+    // Score first and copy names only for the results which are returned.
+    vector<pair<int, size_t>> matches;
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        int score = scorer(entries[i].normalized);
+        if (score >= 0)
+            matches.emplace_back(score, i);
+    }
+
+    auto better = [this](const pair<int, size_t>& a, const pair<int, size_t>& b)
+    {
+        if (a.first != b.first)
+            return a.first > b.first;
+        return entries[a.second].normalized < entries[b.second].normalized;
+    };
+
+    if (maxResults != 0 && maxResults < matches.size())
+    {
+        partial_sort(matches.begin(), matches.begin() + maxResults, matches.end(), better);
+        matches.resize(maxResults);
+    }
+    else
+    {
+        sort(matches.begin(), matches.end(), better);
+    }
+
+    vector<IconSearchResult> results;
+    results.reserve(matches.size());
+    for (auto& match : matches)
+        results.push_back({ entries[match.second].key, entries[match.second].name, match.first });
+
+    return results;
+}
+
+vector<IconSearchResult> IconSearchIndex::prefix(const wstring& query, size_t maxResults) const
+{
+    const wstring q = normalize(query);
+
+    return rank(maxResults, 
+        [&](const wstring& name)
+        {
+            const int length = static_cast<int>(name.size());
+
+            if (name.compare(0, q.size(), q) == 0)
+                return 2 * 65536 - length;
+
+            for (size_t i = 1; i + q.size() <= name.size(); ++i)
+            {
+                if (isWordSeparator(name[i - 1]) && name.compare(i, q.size(), q) == 0)
+                    return 65536 - length;
+            }
+
+            return -1;
+        });
+}
+
+vector<IconSearchResult> IconSearchIndex::glob(const wstring& pattern, size_t maxResults) const
+{
+    const wstring p = normalize(pattern);
+
+    return rank(maxResults, 
+        [&](const wstring& name)
+        {
+            return (globMatch(p.c_str(), name.c_str()) ? 65536 - static_cast<int>(name.size()) : -1);
+        });
+}
+
+vector<IconSearchResult> IconSearchIndex::fuzzy(const wstring& query, size_t maxResults) const
+{
+    const wstring q = normalize(query);
+
+    return rank(maxResults, 
+        [&](const wstring& name)
+        {
+            return subsequenceScore(q, name);
+        });
+}
+
+#ifndef _WIN32
+namespace
+{
+    // The lower case base letter of each character from U+00C0 to U+017F (Latin-1 Supplement and Latin 
+    // Extended-A). Matches FoldStringW(MAP_COMPOSITE), dropping the combining marks and CharLowerBuffW on 
+    // Windows. It's a table since towlower() only maps ASCII in the default "C" locale.
+    const wchar_t latinBaseLetters[] =
+    {
+        L'a', L'a', L'a', L'a', L'a', L'a', 0x00E6, L'c', L'e', L'e', L'e', L'e', L'i', L'i', L'i', L'i',
+        0x00F0, L'n', L'o', L'o', L'o', L'o', L'o', 0x00D7, 0x00F8, L'u', L'u', L'u', L'u', L'y', 0x00FE, 0x00DF,
+        L'a', L'a', L'a', L'a', L'a', L'a', 0x00E6, L'c', L'e', L'e', L'e', L'e', L'i', L'i', L'i', L'i',
+        0x00F0, L'n', L'o', L'o', L'o', L'o', L'o', 0x00F7, 0x00F8, L'u', L'u', L'u', L'u', L'y', 0x00FE, L'y',
+        L'a', L'a', L'a', L'a', L'a', L'a', L'c', L'c', L'c', L'c', L'c', L'c', L'c', L'c', L'd', L'd',
+        0x0111, 0x0111, L'e', L'e', L'e', L'e', L'e', L'e', L'e', L'e', L'e', L'e', L'g', L'g', L'g', L'g',
+        L'g', L'g', L'g', L'g', L'h', L'h', 0x0127, 0x0127, L'i', L'i', L'i', L'i', L'i', L'i', L'i', L'i',
+        L'i', 0x0131, 0x0133, 0x0133, L'j', L'j', L'k', L'k', 0x0138, L'l', L'l', L'l', L'l', L'l', L'l', 0x0140,
+        0x0140, 0x0142, 0x0142, L'n', L'n', L'n', L'n', L'n', L'n', 0x0149, 0x014B, 0x014B, L'o', L'o', L'o', L'o',
+        L'o', L'o', 0x0153, 0x0153, L'r', L'r', L'r', L'r', L'r', L'r', L's', L's', L's', L's', L's', L's',
+        L's', L's', L't', L't', L't', L't', 0x0167, 0x0167, L'u', L'u', L'u', L'u', L'u', L'u', L'u', L'u',
+        L'u', L'u', L'u', L'u', L'w', L'w', L'y', L'y', L'y', L'z', L'z', L'z', L'z', L'z', L'z', 0x017F
+    };
+
+    wchar_t latinBaseLetter(wchar_t c)
+    {
+        const size_t i = static_cast<size_t>(c) - 0xC0;
+        if (c >= 0xC0 && i < sizeof(latinBaseLetters) / sizeof(latinBaseLetters[0]))
+            return latinBaseLetters[i];
+        return c;
+    }
+
+    bool isCombiningMark(wchar_t c)
+    {
+        return c >= 0x0300 && c <= 0x036F;
+    }
+}
+#endif
+
+wstring IconSearchIndex::normalize(const wstring& s)
+{
+    if (s.empty())
+        return s;
+
+#ifndef _WIN32
+    // Without the Windows NLS functions, accented Latin letters are mapped to their lower case base letter 
+    // and combining marks are dropped.
+    wstring normalized;
+    normalized.reserve(s.size());
+    for (wchar_t c : s)
+    {
+        if (!isCombiningMark(c))
+            normalized.push_back(static_cast<wchar_t>(towlower(static_cast<wint_t>(latinBaseLetter(c)))));
+    }
+    return normalized;
+#else
+
+    // Decompose accented characters in to a base character followed by combining marks.
+    wstring decomposed;
+    int size = FoldStringW(MAP_COMPOSITE, s.c_str(), static_cast<int>(s.size()), nullptr, 0);
+    if (size > 0)
+    {
+        decomposed.resize(size);
+        size = FoldStringW(MAP_COMPOSITE, s.c_str(), static_cast<int>(s.size()), &decomposed[0], size);
+    }
+    if (size <= 0)
+        decomposed = s;
+
+    // Drop the combining marks.
+    vector<WORD> types(decomposed.size());
+    if (!GetStringTypeW(CT_CTYPE3, decomposed.c_str(), static_cast<int>(decomposed.size()), types.data()))
+        fill(types.begin(), types.end(), static_cast<WORD>(0));
+
+    wstring normalized;
+    normalized.reserve(decomposed.size());
+    for (size_t i = 0; i < decomposed.size(); ++i)
+    {
+        if (!(types[i] & C3_NONSPACING))
+            normalized.push_back(decomposed[i]);
+    }
+
+    if (!normalized.empty())
+        CharLowerBuffW(&normalized[0], static_cast<DWORD>(normalized.size()));
+
+    return normalized;
+#endif
+}
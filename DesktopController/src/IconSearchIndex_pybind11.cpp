@@ -0,0 +1,31 @@
+#ifdef PYBIND11_BUILD
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "DesktopController.h"
+#include "IconSearchIndex.h"
+
+namespace py = pybind11;
+
+void InitIconSearchIndex_pybind11(py::module& m)
+{
+    py::class_<IconSearchResult>(m, "IconSearchResult")
+        .def_readonly("key", &IconSearchResult::key)
+        .def_readonly("name", &IconSearchResult::name)
+        .def_readonly("score", &IconSearchResult::score);
+
+    py::class_<IconSearchIndex>(m, "IconSearchIndex")
+        .def(py::init<>())
+        .def("assign", &IconSearchIndex::assign, "Replace the contents of the index with the icons in a snapshot.")
+        .def("update", &IconSearchIndex::update, "Apply the output of diffSnapshots to the index.")
+        .def("insert", &IconSearchIndex::insert, "Add an icon to the index or update its name.")
+        .def("erase", &IconSearchIndex::erase, "Remove an icon from the index.")
+        .def("clear", &IconSearchIndex::clear, "Remove all icons from the index.")
+        .def("size", &IconSearchIndex::size, "Number of icons in the index.")
+        .def("prefix", &IconSearchIndex::prefix, py::arg("query"), py::arg("maxResults") = 0, "Find icons whose name or a word in it starts with query.")
+        .def("glob", &IconSearchIndex::glob, py::arg("pattern"), py::arg("maxResults") = 0, "Find icons whose name matches a wildcard pattern.")
+        .def("fuzzy", &IconSearchIndex::fuzzy, py::arg("query"), py::arg("maxResults") = 0, "Find icons whose name contains the characters of query in order.")
+        .def_static("normalize", &IconSearchIndex::normalize, "Strip diacritics and convert to lower case.");
+}
+
+#endif
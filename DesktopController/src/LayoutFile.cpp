@@ -0,0 +1,322 @@
+#include "LayoutFile.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace DcUtil;
+
+static_assert(sizeof(LayoutFileHeader) == 16, "LayoutFileHeader must match the file format");
+static_assert(sizeof(LayoutFileEntry) == 24, "LayoutFileEntry must match the file format");
+
+const uint32_t LayoutFileHeader::magicValue;
+const uint32_t LayoutFileHeader::currentVersion;
+
+#ifndef _WIN32
+// Throw a std::runtime_error describing errno, in the same form as throwLastError().
+static void throwErrno(const string& function)
+{
+    int error = errno;
+    throw runtime_error(function + " failed: (" + to_string(error) + ") " + strerror(error));
+}
+#endif
+
+// Write buffer to a temporary file next to path, then move it over path.
+static void replaceFile(const wstring& path, const vector<uint8_t>& buffer)
+{
+#ifdef _WIN32
+    if (buffer.size() > MAXDWORD)
+        throw runtime_error("Layout is too large to write");
+
+    const wstring tempPath = path + L".tmp";
+
+    HANDLE file = CreateFileW(tempPath.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        throwLastError("CreateFileW");
+
+    DWORD written = 0;
+    BOOL ok = WriteFile(file, buffer.data(), static_cast<DWORD>(buffer.size()), &written, NULL);
+    DWORD error = GetLastError();
+    CloseHandle(file);
+
+    if (!ok || written != buffer.size())
+    {
+        DeleteFileW(tempPath.c_str());
+        SetLastError(error);
+        throwLastError("WriteFile");
+    }
+
+    if (!MoveFileExW(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING))
+    {
+        error = GetLastError();
+        DeleteFileW(tempPath.c_str());
+        SetLastError(error);
+        throwLastError("MoveFileExW");
+    }
+#else
+    const string target = wstringToUtf8(path);
+    const string tempPath = target + ".tmp";
+
+    int file = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file < 0)
+        throwErrno("open");
+
+    size_t written = 0;
+    while (written < buffer.size())
+    {
+        ssize_t count = write(file, buffer.data() + written, buffer.size() - written);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            int error = errno;
+            ::close(file);
+            unlink(tempPath.c_str());
+            errno = error;
+            throwErrno("write");
+        }
+        written += static_cast<size_t>(count);
+    }
+    ::close(file);
+
+    if (rename(tempPath.c_str(), target.c_str()) != 0)
+    {
+        int error = errno;
+        unlink(tempPath.c_str());
+        errno = error;
+        throwErrno("rename");
+    }
+#endif
+}
+
+uint64_t layoutNameHash(const wstring& name)
+{
+    if (sizeof(wchar_t) == sizeof(char16_t))
+        return hashBytes(name.data(), name.size() * sizeof(wchar_t));
+
+    u16string utf16 = wstringToUtf16(name);
+    return hashBytes(utf16.data(), utf16.size() * sizeof(char16_t));
+}
+
+void writeLayoutFile(const wstring& path, const vector<wstring>& names, const vector<Vec2<int>>& positions)
+{
+    if (names.size() != positions.size())
+        throw runtime_error("Argument size mismatch in writeLayoutFile");
+
+    if (names.size() > UINT32_MAX)
+        throw runtime_error("Too many entries for a layout file");
+
+    // Names are stored as UTF-16, which is how they're already held where wchar_t is 2 bytes.
+    vector<u16string> utf16Names;
+    if (sizeof(wchar_t) != sizeof(char16_t))
+    {
+        utf16Names.reserve(names.size());
+        for (auto& name : names)
+            utf16Names.push_back(wstringToUtf16(name));
+    }
+
+    auto nameUnits = [&](size_t i) -> pair<const char16_t*, size_t>
+    {
+        if (utf16Names.empty())
+            return make_pair(reinterpret_cast<const char16_t*>(names[i].data()), names[i].size());
+        return make_pair(utf16Names[i].data(), utf16Names[i].size());
+    };
+
+    size_t nameLength = 0;
+    for (size_t i = 0; i < names.size(); ++i)
+        nameLength += nameUnits(i).second;
+
+    if (nameLength > UINT32_MAX)
+        throw runtime_error("Names are too long for a layout file");
+
+    // The whole file is built in memory and written with one call.
+    const size_t entriesOffset = sizeof(LayoutFileHeader);
+    const size_t namesOffset = entriesOffset + names.size() * sizeof(LayoutFileEntry);
+    vector<uint8_t> buffer(namesOffset + nameLength * sizeof(char16_t));
+
+    auto header = reinterpret_cast<LayoutFileHeader*>(buffer.data());
+    header->magic = LayoutFileHeader::magicValue;
+    header->version = LayoutFileHeader::currentVersion;
+    header->entryCount = static_cast<uint32_t>(names.size());
+    header->nameLength = static_cast<uint32_t>(nameLength);
+
+    auto entries = reinterpret_cast<LayoutFileEntry*>(buffer.data() + entriesOffset);
+    auto nameBlock = reinterpret_cast<char16_t*>(buffer.data() + namesOffset);
+
+    uint32_t offset = 0;
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        auto name = nameUnits(i);
+        LayoutFileEntry& entry = entries[i];
+
+        entry.nameHash = hashBytes(name.first, name.second * sizeof(char16_t));
+        entry.nameOffset = offset;
+        entry.nameLength = static_cast<uint32_t>(name.second);
+        entry.x = positions[i].x;
+        entry.y = positions[i].y;
+
+        copy(name.first, name.first + name.second, nameBlock + offset);
+        offset += entry.nameLength;
+    }
+
+    replaceFile(path, buffer);
+}
+
+void writeLayoutFile(const wstring& path, const DesktopSnapshot& snap)
+{
+    writeLayoutFile(path, snap.names(), snap.positions());
+}
+
+LayoutFileView::LayoutFileView(const wstring& path)
+    : view(nullptr)
+    , viewSize(0)
+#ifdef _WIN32
+    , file(INVALID_HANDLE_VALUE)
+    , mapping(NULL)
+#endif
+    , header(nullptr)
+    , entries(nullptr)
+    , names(nullptr)
+{
+#ifdef _WIN32
+    file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        throwLastError("CreateFileW");
+#else
+    int file = open(wstringToUtf8(path).c_str(), O_RDONLY);
+    if (file < 0)
+        throwErrno("open");
+#endif
+
+    try
+    {
+#ifdef _WIN32
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize))
+            throwLastError("GetFileSizeEx");
+
+        if (fileSize.QuadPart < static_cast<LONGLONG>(sizeof(LayoutFileHeader)))
+            throw runtime_error("Layout file is truncated");
+
+        mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!mapping)
+            throwLastError("CreateFileMappingW");
+
+        view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!view)
+            throwLastError("MapViewOfFile");
+
+        const uint64_t size = static_cast<uint64_t>(fileSize.QuadPart);
+#else
+        struct stat status;
+        if (fstat(file, &status) != 0)
+            throwErrno("fstat");
+
+        if (status.st_size < static_cast<off_t>(sizeof(LayoutFileHeader)))
+            throw runtime_error("Layout file is truncated");
+
+        void* mapped = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        if (mapped == MAP_FAILED)
+            throwErrno("mmap");
+
+        // The mapping stays valid once the descriptor is closed.
+        view = mapped;
+        ::close(file);
+        file = -1;
+
+        const uint64_t size = static_cast<uint64_t>(status.st_size);
+#endif
+        viewSize = static_cast<size_t>(size);
+        const uint8_t* base = static_cast<const uint8_t*>(view);
+
+        header = reinterpret_cast<const LayoutFileHeader*>(base);
+        if (header->magic != LayoutFileHeader::magicValue)
+            throw runtime_error("Not a layout file");
+
+        if (header->version == 0 || header->version > LayoutFileHeader::currentVersion)
+            throw runtime_error("Unsupported layout file version " + to_string(header->version));
+
+        const uint64_t entriesOffset = sizeof(LayoutFileHeader);
+        const uint64_t namesOffset = entriesOffset + uint64_t(header->entryCount) * sizeof(LayoutFileEntry);
+        if (namesOffset + uint64_t(header->nameLength) * sizeof(char16_t) > size)
+            throw runtime_error("Layout file is truncated");
+
+        entries = reinterpret_cast<const LayoutFileEntry*>(base + entriesOffset);
+        names = reinterpret_cast<const char16_t*>(base + namesOffset);
+
+        for (uint32_t i = 0; i < header->entryCount; ++i)
+        {
+            if (uint64_t(entries[i].nameOffset) + entries[i].nameLength > header->nameLength)
+                throw runtime_error("Layout file entry " + to_string(i) + " has an invalid name");
+        }
+    }
+    catch (...)
+    {
+#ifndef _WIN32
+        if (file >= 0)
+            ::close(file);
+#endif
+        close();
+        throw;
+    }
+}
+
+LayoutFileView::~LayoutFileView()
+{
+    close();
+}
+
+void LayoutFileView::close()
+{
+#ifdef _WIN32
+    if (view)
+        UnmapViewOfFile(view);
+    if (mapping)
+        CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE)
+        CloseHandle(file);
+
+    mapping = NULL;
+    file = INVALID_HANDLE_VALUE;
+#else
+    if (view)
+        munmap(const_cast<void*>(view), viewSize);
+#endif
+
+    view = nullptr;
+    viewSize = 0;
+}
+
+wstring LayoutFileView::name(size_t i) const
+{
+    return utf16ToWstring(nameData(i), entries[i].nameLength);
+}
+
+bool LayoutFileView::nameEquals(size_t i, const wstring& name) const
+{
+    const char16_t* data = nameData(i);
+    const size_t length = entries[i].nameLength;
+
+    if (sizeof(wchar_t) == sizeof(char16_t))
+        return length == name.size() && equal(name.begin(), name.end(), data);
+
+    return name == utf16ToWstring(data, length);
+}
+
+Vec2<int> LayoutFileView::position(size_t i) const
+{
+    return Vec2<int>(entries[i].x, entries[i].y);
+}
@@ -0,0 +1,41 @@
+#ifdef PYBIND11_BUILD
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "LayoutFile.h"
+
+namespace py = pybind11;
+using namespace DcUtil;
+
+void InitLayoutFile_pybind11(py::module& m)
+{
+    m.def("writeLayoutFile", 
+        py::overload_cast<const std::wstring&, const DesktopSnapshot&>(&writeLayoutFile), 
+        "Save the names and positions of every icon in a snapshot to a layout file.");
+    m.def("writeLayoutFile", 
+        py::overload_cast<const std::wstring&, const std::vector<std::wstring>&, const std::vector<Vec2<int>>&>(&writeLayoutFile), 
+        "Save a list of names and positions to a layout file.");
+
+    // The C++ accessors are unchecked, so indices are checked here.
+    auto checkIndex = [](const LayoutFileView& view, size_t i)
+    {
+        if (i >= view.size())
+            throw py::index_error();
+    };
+
+    py::class_<LayoutFileView>(m, "LayoutFileView")
+        .def(py::init<const std::wstring&>())
+        .def("size", &LayoutFileView::size, "Number of entries in the layout.")
+        .def("__len__", &LayoutFileView::size)
+        .def("name", 
+            [checkIndex](const LayoutFileView& view, size_t i) { checkIndex(view, i); return view.name(i); }, 
+            "Name of the entry at the given index.")
+        .def("position", 
+            [checkIndex](const LayoutFileView& view, size_t i) { checkIndex(view, i); return view.position(i); }, 
+            "Position of the entry at the given index.")
+        .def("nameHash", 
+            [checkIndex](const LayoutFileView& view, size_t i) { checkIndex(view, i); return view.entry(i).nameHash; }, 
+            "Hash of the name of the entry at the given index.");
+}
+
+#endif
@@ -0,0 +1,80 @@
+#include "LayoutHistory.h"
+
+#include <stdexcept>
+
+using namespace std;
+using namespace DcUtil;
+
+LayoutHistory::LayoutHistory(size_t capacity)
+    : steps(capacity)
+    , head(0)
+    , count(0)
+    , cursor(0)
+    , deltaCapacity(0)
+{
+    if (capacity == 0)
+        throw runtime_error("LayoutHistory capacity must be more than 0");
+}
+
+void LayoutHistory::record(vector<LayoutDelta> step)
+{
+    if (step.empty())
+        return;
+
+    // Discard the steps which could have been redone.
+    while (count > cursor)
+        release(slot(--count));
+
+    if (count == steps.size())
+    {
+        release(head);
+        head = slot(1);
+        --count;
+        --cursor;
+    }
+
+    step.shrink_to_fit();
+    deltaCapacity += step.capacity();
+    steps[slot(count)] = std::move(step);
+
+    ++count;
+    cursor = count;
+}
+
+const vector<LayoutDelta>* LayoutHistory::undoStep() const
+{
+    return (cursor > 0 ? &steps[slot(cursor - 1)] : nullptr);
+}
+
+const vector<LayoutDelta>* LayoutHistory::redoStep() const
+{
+    return (cursor < count ? &steps[slot(cursor)] : nullptr);
+}
+
+void LayoutHistory::markUndone()
+{
+    if (cursor == 0)
+        throw runtime_error("Nothing to undo");
+    --cursor;
+}
+
+void LayoutHistory::markRedone()
+{
+    if (cursor == count)
+        throw runtime_error("Nothing to redo");
+    ++cursor;
+}
+
+void LayoutHistory::clear()
+{
+    for (size_t i = 0; i < count; ++i)
+        release(slot(i));
+
+    head = count = cursor = 0;
+}
+
+void LayoutHistory::release(size_t index)
+{
+    deltaCapacity -= steps[index].capacity();
+    vector<LayoutDelta>().swap(steps[index]);
+}
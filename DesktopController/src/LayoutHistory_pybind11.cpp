@@ -0,0 +1,26 @@
+#ifdef PYBIND11_BUILD
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "LayoutHistory.h"
+
+namespace py = pybind11;
+
+void InitLayoutHistory_pybind11(py::module& m)
+{
+    py::class_<LayoutDelta>(m, "LayoutDelta")
+        .def_readonly("key", &LayoutDelta::key)
+        .def_readonly("before", &LayoutDelta::before)
+        .def_readonly("after", &LayoutDelta::after);
+
+    // Read only. Steps are recorded and replayed by DesktopController.
+    py::class_<LayoutHistory>(m, "LayoutHistory")
+        .def("undoStep", &LayoutHistory::undoStep, py::return_value_policy::copy, "The step an undo would revert, or None.")
+        .def("redoStep", &LayoutHistory::redoStep, py::return_value_policy::copy, "The step a redo would reapply, or None.")
+        .def("undoCount", &LayoutHistory::undoCount, "Number of steps which can be undone.")
+        .def("redoCount", &LayoutHistory::redoCount, "Number of steps which can be redone.")
+        .def("capacity", &LayoutHistory::capacity, "Maximum number of steps kept.")
+        .def("memoryUsage", &LayoutHistory::memoryUsage, "Number of bytes allocated for stored deltas.");
+}
+
+#endif
@@ -0,0 +1,67 @@
+#include "DesktopController.h"
+#include "LayoutProfileStore.h"
+
+using namespace std;
+using namespace DcUtil;
+
+LayoutProfileStore::LayoutProfileStore(DesktopController& controller)
+    : LayoutProfileStore([&controller](const LayoutProfile& profile) { return controller.repositionByName(profile, true); })
+{
+    currentConfig = controller.displayConfiguration();
+    haveCurrentConfig = true;
+}
+
+LayoutProfileStore::LayoutProfileStore(ApplyFunction apply)
+    : applyFunction(std::move(apply))
+    , haveCurrentConfig(false)
+{
+    if (!applyFunction)
+        throw runtime_error("LayoutProfileStore requires an apply function");
+}
+
+void LayoutProfileStore::save(const DisplayConfiguration& config, LayoutProfile profile)
+{
+    profiles[config] = std::move(profile);
+}
+
+void LayoutProfileStore::save(const DisplayConfiguration& config, const DesktopSnapshot& snap)
+{
+    LayoutProfile profile;
+    profile.reserve(snap.size());
+
+    for (size_t i = 0; i < snap.size(); ++i)
+        profile.emplace(snap.name(i), snap.position(i));
+
+    save(config, std::move(profile));
+}
+
+const LayoutProfile* LayoutProfileStore::find(const DisplayConfiguration& config) const
+{
+    auto it = profiles.find(config);
+    return (it == profiles.end() ? nullptr : &it->second);
+}
+
+bool LayoutProfileStore::erase(const DisplayConfiguration& config)
+{
+    return profiles.erase(config) != 0;
+}
+
+size_t LayoutProfileStore::onDisplayChange(const DisplayConfiguration& config)
+{
+    // The first configuration seen is the one the icons are already arranged for.
+    if (!haveCurrentConfig || config == currentConfig)
+    {
+        currentConfig = config;
+        haveCurrentConfig = true;
+        return 0;
+    }
+
+    currentConfig = config;
+    return applyProfile(config);
+}
+
+size_t LayoutProfileStore::applyProfile(const DisplayConfiguration& config)
+{
+    const LayoutProfile* profile = find(config);
+    return (profile ? applyFunction(*profile) : 0);
+}
@@ -0,0 +1,42 @@
+#ifdef PYBIND11_BUILD
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <pybind11/functional.h>
+
+#include "DesktopController.h"
+#include "LayoutProfileStore.h"
+
+namespace py = pybind11;
+
+void InitLayoutProfileStore_pybind11(py::module& m)
+{
+    py::class_<DisplayConfiguration>(m, "DisplayConfiguration")
+        .def(py::init<>())
+        .def_readwrite("resolution", &DisplayConfiguration::resolution)
+        .def_readwrite("monitorCount", &DisplayConfiguration::monitorCount)
+        .def_readwrite("dpi", &DisplayConfiguration::dpi)
+        .def("__eq__", &DisplayConfiguration::operator==)
+        .def("__hash__", [](const DisplayConfiguration& config) { return DisplayConfigurationHash()(config); });
+
+    py::class_<LayoutProfileStore>(m, "LayoutProfileStore")
+        .def(py::init<DesktopController&>(), py::keep_alive<1, 2>())
+        .def(py::init<LayoutProfileStore::ApplyFunction>())
+        .def("save", py::overload_cast<const DisplayConfiguration&, LayoutProfile>(&LayoutProfileStore::save), 
+            "Save a dict of names to positions as the profile for a display configuration.")
+        .def("save", py::overload_cast<const DisplayConfiguration&, const DesktopSnapshot&>(&LayoutProfileStore::save), 
+            "Save the positions of the icons in a snapshot as the profile for a display configuration.")
+        .def("find", 
+            [](const LayoutProfileStore& store, const DisplayConfiguration& config) -> py::object
+            {
+                const LayoutProfile* profile = store.find(config);
+                return (profile ? py::cast(*profile) : py::none());
+            }, 
+            "Get a copy of the profile saved for a display configuration, or None.")
+        .def("erase", &LayoutProfileStore::erase, "Remove the profile saved for a display configuration.")
+        .def("size", &LayoutProfileStore::size, "Number of saved profiles.")
+        .def("__len__", &LayoutProfileStore::size)
+        .def("onDisplayChange", &LayoutProfileStore::onDisplayChange, "Apply the matching profile if the display configuration has changed. Returns the number of icons moved.")
+        .def("applyProfile", &LayoutProfileStore::applyProfile, "Apply the profile saved for a display configuration. Returns the number of icons moved.");
+}
+
+#endif
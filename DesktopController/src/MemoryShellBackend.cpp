@@ -0,0 +1,421 @@
+#include "MemoryShellBackend.h"
+
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+using namespace DcUtil;
+
+namespace
+{
+    // Layout of the item IDs made by MemoryShellBackend: a single SHITEMID followed by the terminator.
+#pragma pack(push, 1)
+    struct MemoryItemID
+    {
+        uint16_t cb;
+        uint32_t signature;
+        uint32_t id;
+        uint32_t version;
+        uint16_t terminator;
+    };
+#pragma pack(pop)
+
+    const uint32_t itemSignature = 0x4D454D44; // "DMEM"
+
+    // Rounds value to the nearest multiple of step.
+    int snap(int value, int step)
+    {
+        if (step <= 0)
+            return value;
+
+        int half = step / 2;
+        int cell = (value >= 0 ? (value + half) / step : -((-value + half) / step));
+        return cell * step;
+    }
+
+    // Fetches item IDs from a list of item IDs captured when the enumeration started.
+    class MemoryItemEnumerator : public ShellItemEnumerator
+    {
+    public:
+        MemoryItemEnumerator(const MemoryShellBackend& backendArg, vector<uint32_t> idsArg)
+            : backend(backendArg)
+            , ids(std::move(idsArg))
+            , nextIndex(0)
+        {
+        }
+
+        ShellStatus next(ItemId* itemids, size_t count, size_t& fetched) override
+        {
+            size_t n = 0;
+            while (n < count && nextIndex < ids.size())
+            {
+                // Items removed since the enumeration started are skipped.
+                if (backend.createItemID(ids[nextIndex++], itemids[n]))
+                    ++n;
+            }
+
+            backend.simulateCall(ShellCall::Next, n);
+
+            fetched = n;
+            return (n == count ? shellOk : shellFalse);
+        }
+
+    private:
+        const MemoryShellBackend& backend;
+        vector<uint32_t> ids;
+        size_t nextIndex;
+    };
+}
+
+MemoryShellBackend::MemoryShellBackend()
+    : nextId(1)
+    , resolution(1920, 1080)
+    , monitors(1)
+    , dpi(96)
+    , iconSpacing(75, 100)
+    , refreshes(0)
+    , watching(false)
+{
+    resetCallCounts();
+}
+
+uint32_t MemoryShellBackend::addItem(const wstring& name, const Vec2<int>& position)
+{
+    uint32_t id = nextId++;
+    itemsById[id] = Item{ name, position, 0, false };
+    order.push_back(id);
+    queueChange(DesktopChangeType::Added, id, name, wstring());
+    return id;
+}
+
+bool MemoryShellBackend::removeItem(uint32_t id)
+{
+    // Queued before the item is erased, while its item ID can still be made. Like the Shell, the
+    // change doesn't name the item.
+    if (watching && itemsById.count(id) != 0)
+        queueChange(DesktopChangeType::Removed, id, wstring(), wstring());
+
+    if (itemsById.erase(id) == 0)
+        return false;
+
+    order.erase(find(order.begin(), order.end(), id));
+    return true;
+}
+
+bool MemoryShellBackend::renameItem(uint32_t id, const wstring& name)
+{
+    auto it = itemsById.find(id);
+    if (it == itemsById.end())
+        return false;
+
+    // The change carries the item ID the item had before it was renamed.
+    queueChange(DesktopChangeType::Renamed, id, wstring(), name);
+    it->second.name = name;
+    ++it->second.version;
+    return true;
+}
+
+bool MemoryShellBackend::touchItem(uint32_t id)
+{
+    auto it = itemsById.find(id);
+    if (it == itemsById.end())
+        return false;
+
+    ++it->second.version;
+    return true;
+}
+
+bool MemoryShellBackend::moveItem(uint32_t id, const Vec2<int>& position)
+{
+    auto it = itemsById.find(id);
+    if (it == itemsById.end())
+        return false;
+
+    it->second.position = position;
+    queueChange(DesktopChangeType::Moved, id, it->second.name, wstring());
+    return true;
+}
+
+bool MemoryShellBackend::selectItem(uint32_t id, bool selected)
+{
+    auto it = itemsById.find(id);
+    if (it == itemsById.end())
+        return false;
+
+    it->second.selected = selected;
+    return true;
+}
+
+Vec2<int> MemoryShellBackend::positionOf(uint32_t id) const
+{
+    auto it = itemsById.find(id);
+    return (it == itemsById.end() ? Vec2<int>() : it->second.position);
+}
+
+void MemoryShellBackend::clear()
+{
+    order.clear();
+    itemsById.clear();
+
+    if (watching)
+        changes.push_back(ShellChange{ DesktopChangeType::Updated, ItemId(), wstring(), wstring() });
+}
+
+void MemoryShellBackend::setLatency(ShellCall call, const ShellCallLatency& latency)
+{
+    if (call >= ShellCall::Count)
+        throw runtime_error("Invalid call type in MemoryShellBackend::setLatency");
+
+    latencies[static_cast<size_t>(call)] = latency;
+}
+
+const ShellCallLatency& MemoryShellBackend::latency(ShellCall call) const
+{
+    if (call >= ShellCall::Count)
+        throw runtime_error("Invalid call type in MemoryShellBackend::latency");
+
+    return latencies[static_cast<size_t>(call)];
+}
+
+uint64_t MemoryShellBackend::callCount(ShellCall call) const
+{
+    return (call < ShellCall::Count ? callCounts[static_cast<size_t>(call)] : 0);
+}
+
+void MemoryShellBackend::resetCallCounts()
+{
+    fill(begin(callCounts), end(callCounts), 0);
+}
+
+void MemoryShellBackend::setDisplay(const Vec2<int>& resolutionArg, int monitorsArg, int dpiArg)
+{
+    resolution = resolutionArg;
+    monitors = monitorsArg;
+    dpi = dpiArg;
+}
+
+void MemoryShellBackend::setSpacing(const Vec2<int>& spacingArg)
+{
+    iconSpacing = spacingArg;
+}
+
+void MemoryShellBackend::setFolderFlags(const FolderFlags& flagsArg)
+{
+    flags = flagsArg;
+}
+
+void MemoryShellBackend::setCursorPosition(const Vec2<int>& position)
+{
+    cursor = position;
+}
+
+void MemoryShellBackend::simulateCall(ShellCall call, size_t items) const
+{
+    ++callCounts[static_cast<size_t>(call)];
+
+    const ShellCallLatency& cost = latencies[static_cast<size_t>(call)];
+    const long long n = static_cast<long long>(items);
+    chrono::nanoseconds delay = cost.fixed + cost.perItem * n + cost.perItemSquared * (n * n);
+    if (delay.count() <= 0)
+        return;
+
+    // Sleep isn't precise enough for the latencies of most Shell calls, so this spins.
+    auto until = chrono::steady_clock::now() + delay;
+    while (chrono::steady_clock::now() < until)
+        ;
+}
+
+bool MemoryShellBackend::createItemID(uint32_t id, ItemId& itemidOut) const
+{
+    auto it = itemsById.find(id);
+    if (it == itemsById.end())
+        return false;
+
+    MemoryItemID fields;
+    fields.cb = static_cast<uint16_t>(sizeof(MemoryItemID) - sizeof(uint16_t));
+    fields.signature = itemSignature;
+    fields.id = id;
+    fields.version = it->second.version;
+    fields.terminator = 0;
+
+    itemidOut.resize(sizeof(fields));
+    memcpy(itemidOut.data(), &fields, sizeof(fields));
+    return true;
+}
+
+const MemoryShellBackend::Item* MemoryShellBackend::findItem(ItemIdView itemid) const
+{
+    // Fields are copied out since item IDs aren't necessarily aligned.
+    MemoryItemID fields;
+    if (itemid.size() != sizeof(fields))
+        return nullptr;
+
+    memcpy(&fields, itemid.data(), sizeof(fields));
+    if (fields.cb != sizeof(MemoryItemID) - sizeof(uint16_t) || fields.signature != itemSignature)
+        return nullptr;
+
+    auto it = itemsById.find(fields.id);
+    if (it == itemsById.end() || it->second.version != fields.version)
+        return nullptr;
+
+    return &it->second;
+}
+
+MemoryShellBackend::Item* MemoryShellBackend::findItem(ItemIdView itemid)
+{
+    return const_cast<Item*>(static_cast<const MemoryShellBackend*>(this)->findItem(itemid));
+}
+
+ShellStatus MemoryShellBackend::items(ShellItemSet set, unique_ptr<ShellItemEnumerator>& enumOut)
+{
+    simulateCall(ShellCall::Items, 1);
+
+    vector<uint32_t> ids;
+    if (set == ShellItemSet::Selection)
+    {
+        for (uint32_t id : order)
+        {
+            if (itemsById[id].selected)
+                ids.push_back(id);
+        }
+
+        // As the Shell does, no enumerator is returned when nothing is selected.
+        if (ids.empty())
+        {
+            enumOut.reset();
+            return shellOk;
+        }
+    }
+    else
+    {
+        ids = order;
+    }
+
+    enumOut = make_unique<MemoryItemEnumerator>(*this, std::move(ids));
+    return shellOk;
+}
+
+ShellStatus MemoryShellBackend::displayName(ItemIdView itemid, ShellNameKind, wstring& nameOut) const
+{
+    simulateCall(ShellCall::GetDisplayNameOf, 1);
+
+    const Item* item = findItem(itemid);
+    if (!item)
+        return shellInvalidArgument;
+
+    nameOut = item->name;
+    return shellOk;
+}
+
+ShellStatus MemoryShellBackend::itemPosition(ItemIdView itemid, Vec2<int>& positionOut) const
+{
+    simulateCall(ShellCall::GetItemPosition, 1);
+
+    const Item* item = findItem(itemid);
+    if (!item)
+        return shellInvalidArgument;
+
+    positionOut = item->position;
+    return shellOk;
+}
+
+ShellStatus MemoryShellBackend::positionItems(size_t count, const ItemIdView* itemids, const Vec2<int>* points)
+{
+    simulateCall(ShellCall::SelectAndPositionItems, count);
+
+    ShellStatus result = shellOk;
+    for (size_t i = 0; i < count; ++i)
+    {
+        Item* item = findItem(itemids[i]);
+        if (!item)
+        {
+            result = shellInvalidArgument;
+            continue;
+        }
+
+        if (flags.autoArrange)
+            continue;
+
+        if (flags.snapToGrid)
+            item->position = Vec2<int>(snap(points[i].x, iconSpacing.x), snap(points[i].y, iconSpacing.y));
+        else
+            item->position = points[i];
+    }
+
+    return result;
+}
+
+ShellStatus MemoryShellBackend::spacing(Vec2<int>& spacingOut) const
+{
+    spacingOut = iconSpacing;
+    return shellOk;
+}
+
+ShellStatus MemoryShellBackend::folderFlags(FolderFlags& flagsOut) const
+{
+    flagsOut = flags;
+    return shellOk;
+}
+
+Vec2<int> MemoryShellBackend::desktopResolution() const
+{
+    return resolution;
+}
+
+int MemoryShellBackend::monitorCount() const
+{
+    return monitors;
+}
+
+int MemoryShellBackend::systemDpi() const
+{
+    return dpi;
+}
+
+Vec2<int> MemoryShellBackend::cursorPosition() const
+{
+    return cursor;
+}
+
+void MemoryShellBackend::refresh()
+{
+    ++refreshes;
+}
+
+void MemoryShellBackend::subscribeChanges()
+{
+    watching = true;
+}
+
+void MemoryShellBackend::unsubscribeChanges()
+{
+    watching = false;
+    changes.clear();
+}
+
+size_t MemoryShellBackend::pollChanges(const function<void(const ShellChange&)>& handler)
+{
+    size_t passed = 0;
+
+    // The handler may make further changes, which are passed in the same call, or unsubscribe.
+    while (watching && !changes.empty())
+    {
+        ShellChange change = std::move(changes.front());
+        changes.pop_front();
+        handler(change);
+        ++passed;
+    }
+
+    return passed;
+}
+
+void MemoryShellBackend::queueChange(DesktopChangeType type, uint32_t id, const wstring& name, const wstring& newName)
+{
+    if (!watching)
+        return;
+
+    ShellChange change{ type, ItemId(), name, newName };
+    createItemID(id, change.itemid);
+    changes.push_back(std::move(change));
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifdef PYBIND11_BUILD
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <pybind11/chrono.h>
+
+#include "MemoryShellBackend.h"
+
+namespace py = pybind11;
+using namespace DcUtil;
+
+void InitMemoryShellBackend_pybind11(py::module& m)
+{
+    py::class_<ShellCallLatency>(m, "ShellCallLatency")
+        .def(py::init<>())
+        .def_readwrite("fixed", &ShellCallLatency::fixed)
+        .def_readwrite("perItem", &ShellCallLatency::perItem)
+        .def_readwrite("perItemSquared", &ShellCallLatency::perItemSquared);
+
+    py::class_<MemoryShellBackend, ShellBackend, std::shared_ptr<MemoryShellBackend>>(m, "MemoryShellBackend")
+        .def(py::init<>())
+        .def("addItem", &MemoryShellBackend::addItem, "Add an item to the end of the desktop. Returns its ID.")
+        .def("removeItem", &MemoryShellBackend::removeItem, "Remove an item.")
+        .def("renameItem", &MemoryShellBackend::renameItem, "Change the display name of an item.")
+        .def("touchItem", &MemoryShellBackend::touchItem, "Simulate editing the file behind an item, changing its key.")
+        .def("moveItem", &MemoryShellBackend::moveItem, "Move an item directly, as the user would.")
+        .def("selectItem", &MemoryShellBackend::selectItem, "Select or deselect an item.")
+        .def("positionOf", &MemoryShellBackend::positionOf, "Get the position of an item.")
+        .def("itemCount", &MemoryShellBackend::itemCount, "Number of items on the desktop.")
+        .def("clear", &MemoryShellBackend::clear, "Remove every item.")
+        .def("setLatency", &MemoryShellBackend::setLatency, "Set the simulated latency of a type of call.")
+        .def("latency", &MemoryShellBackend::latency, "Get the simulated latency of a type of call.")
+        .def("callCount", &MemoryShellBackend::callCount, "Number of calls of a type made.")
+        .def("resetCallCounts", &MemoryShellBackend::resetCallCounts, "Set the number of calls of every type back to 0.")
+        .def("setDisplay", &MemoryShellBackend::setDisplay, "Set the simulated resolution, monitor count and DPI.")
+        .def("setSpacing", &MemoryShellBackend::setSpacing, "Set the simulated icon spacing.")
+        .def("setFolderFlags", &MemoryShellBackend::setFolderFlags, "Set the simulated folder flags from a FolderFlags.")
+        .def("setCursorPosition", &MemoryShellBackend::setCursorPosition, "Set the simulated cursor position.")
+        .def("refreshCount", &MemoryShellBackend::refreshCount, "Number of times refresh has been called.");
+}
+
+#endif
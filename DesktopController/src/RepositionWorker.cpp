@@ -0,0 +1,210 @@
+#include "DesktopController.h"
+#include "RepositionWorker.h"
+
+#include <unordered_set>
+
+#ifdef _WIN32
+#include "ComShellBackend.h"
+#endif
+
+using namespace std;
+using namespace std::chrono;
+using namespace DcUtil;
+
+#ifdef _WIN32
+RepositionWorker::RepositionWorker(double ticksPerSecond)
+    : RepositionWorker([] { return make_shared<ComShellBackend>(); }, ticksPerSecond)
+{
+}
+#endif
+
+RepositionWorker::RepositionWorker(BackendFactory makeBackend, double ticksPerSecond)
+    : batchInFlight(false)
+    , flushRequested(false)
+    , stopping(false)
+{
+    if (ticksPerSecond <= 0.0)
+        throw runtime_error("ticksPerSecond must be more than 0");
+    if (!makeBackend)
+        throw runtime_error("Invalid backend factory in RepositionWorker");
+
+    tickInterval = duration_cast<steady_clock::duration>(duration<double>(1.0 / ticksPerSecond));
+
+    // The worker thread constructs its own backend and DesktopController. If that fails, the exception is rethrown here.
+    promise<void> started;
+    future<void> startedFuture = started.get_future();
+    thread = std::thread(&RepositionWorker::run, this, std::move(makeBackend), std::move(started));
+
+    try
+    {
+        startedFuture.get();
+    }
+    catch (...)
+    {
+        thread.join();
+        throw;
+    }
+}
+
+RepositionWorker::~RepositionWorker()
+{
+    {
+        lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    if (thread.joinable())
+        thread.join();
+}
+
+future<void> RepositionWorker::reposition(const DesktopIcon& icon, const Vec2<int>& point)
+{
+    Waiter waiter = make_shared<promise<void>>();
+    future<void> result = waiter->get_future();
+
+    {
+        lock_guard<std::mutex> lock(mutex);
+        enqueue(icon, point, waiter);
+    }
+    wake.notify_all();
+
+    return result;
+}
+
+future<void> RepositionWorker::repositionIcons(const vector<DesktopIcon*>& icons, const vector<Vec2<int>>& points)
+{
+    if (icons.size() != points.size())
+        throw runtime_error("Argument size mismatch in RepositionWorker::repositionIcons");
+
+    // One promise is shared by every icon in the call.
+    Waiter waiter = make_shared<promise<void>>();
+    future<void> result = waiter->get_future();
+
+    if (icons.empty())
+    {
+        waiter->set_value();
+        return result;
+    }
+
+    {
+        // Queued under one lock so the icons are always submitted in the same batch.
+        lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < icons.size(); ++i)
+            enqueue(*icons[i], points[i], waiter);
+    }
+    wake.notify_all();
+
+    return result;
+}
+
+void RepositionWorker::enqueue(const DesktopIcon& icon, const Vec2<int>& point, const Waiter& waiter)
+{
+    Request& request = pending[icon.key()];
+
+    if (request.itemid.empty())
+        request.itemid = icon.getItemID();
+
+    // Latest wins. Earlier waiters complete with this request.
+    request.point = point;
+    request.waiters.push_back(waiter);
+}
+
+void RepositionWorker::flush()
+{
+    unique_lock<std::mutex> lock(mutex);
+
+    // With nothing pending, only a batch in flight (if any) is waited for. Setting flushRequested
+    // then would make the next batch skip its coalescing delay.
+    if (!pending.empty())
+    {
+        flushRequested = true;
+        wake.notify_all();
+    }
+    applied.wait(lock, [this] { return pending.empty() && !batchInFlight; });
+}
+
+size_t RepositionWorker::pendingCount() const
+{
+    lock_guard<std::mutex> lock(mutex);
+    return pending.size();
+}
+
+void RepositionWorker::run(BackendFactory makeBackend, promise<void> started)
+{
+    // Destroyed when run() returns, so a ComShellBackend uninitialises COM on the thread which initialised it.
+    unique_ptr<DesktopController> dc;
+    try
+    {
+        dc = make_unique<DesktopController>(makeBackend());
+    }
+    catch (...)
+    {
+        started.set_exception(current_exception());
+        return;
+    }
+    started.set_value();
+
+    unique_lock<std::mutex> lock(mutex);
+
+    // The first batch is submitted as soon as a request arrives.
+    auto nextTick = steady_clock::now();
+
+    for (;;)
+    {
+        wake.wait(lock, [this] { return stopping || !pending.empty(); });
+        if (pending.empty())
+            break;
+
+        // Let requests coalesce until the next tick, unless a flush or shutdown is waiting on them.
+        wake.wait_until(lock, nextTick, [this] { return stopping || flushRequested; });
+
+        unordered_map<uint64_t, Request> batch;
+        batch.swap(pending);
+        flushRequested = false;
+        batchInFlight = true;
+        lock.unlock();
+
+        vector<ItemIdView> itemids;
+        vector<Vec2<int>> points;
+        itemids.reserve(batch.size());
+        points.reserve(batch.size());
+        for (auto& request : batch)
+        {
+            itemids.push_back(request.second.itemid);
+            points.push_back(request.second.point);
+        }
+
+        exception_ptr error;
+        try
+        {
+            dc->positionItems(itemids.size(), itemids.data(), points.data());
+        }
+        catch (...)
+        {
+            error = current_exception();
+        }
+
+        nextTick = steady_clock::now() + tickInterval;
+
+        // A promise may be shared by several requests (repositionIcons), so each is completed once.
+        unordered_set<promise<void>*> completed;
+        for (auto& request : batch)
+        {
+            for (auto& waiter : request.second.waiters)
+            {
+                if (!completed.insert(waiter.get()).second)
+                    continue;
+
+                if (error)
+                    waiter->set_exception(error);
+                else
+                    waiter->set_value();
+            }
+        }
+
+        lock.lock();
+        batchInFlight = false;
+        applied.notify_all();
+    }
+}
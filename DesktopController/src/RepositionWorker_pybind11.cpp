@@ -0,0 +1,73 @@
+#ifdef PYBIND11_BUILD
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <pybind11/functional.h>
+
+#include <future>
+#include <chrono>
+
+#include "DesktopController.h"
+#include "RepositionWorker.h"
+
+namespace py = pybind11;
+using namespace DcUtil;
+
+void InitRepositionWorker_pybind11(py::module& m)
+{
+    // Requests return a shared_future so Python can wait on it more than once.
+    py::class_<std::shared_future<void>>(m, "RepositionFuture")
+        .def("wait", 
+            [](const std::shared_future<void>& future, py::object timeout)
+            {
+                if (timeout.is_none())
+                {
+                    py::gil_scoped_release release;
+                    future.wait();
+                    return true;
+                }
+
+                auto duration = std::chrono::duration<double>(timeout.cast<double>());
+                py::gil_scoped_release release;
+                return future.wait_for(duration) == std::future_status::ready;
+            }, 
+            py::arg("timeout") = py::none(),
+            "Wait until the request has been applied, or until timeout seconds have passed. Returns True if the request has been applied.")
+        .def("done", 
+            [](const std::shared_future<void>& future)
+            {
+                return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+            }, 
+            "Returns True if the request has been applied.")
+        .def("result", 
+            [](const std::shared_future<void>& future)
+            {
+                future.get();
+            }, 
+            py::call_guard<py::gil_scoped_release>(), 
+            "Wait until the request has been applied. Raises the exception thrown if applying it failed.");
+
+    py::class_<RepositionWorker>(m, "RepositionWorker")
+#ifdef _WIN32
+        .def(py::init<double>(), py::arg("ticksPerSecond") = 25.0)
+#endif
+        .def(py::init<RepositionWorker::BackendFactory, double>(), py::arg("makeBackend"), py::arg("ticksPerSecond") = 25.0,
+            py::call_guard<py::gil_scoped_release>(),   // makeBackend is called on the worker thread, which takes the GIL.
+            "Start a worker which moves icons through the backend returned by makeBackend, e.g. a MemoryShellBackend.")
+        .def("reposition", 
+            [](RepositionWorker& worker, const DesktopIcon& icon, const Vec2<int>& point)
+            {
+                return worker.reposition(icon, point).share();
+            }, 
+            "Queue a new position for an icon. Returns a RepositionFuture.")
+        .def("repositionIcons", 
+            [](RepositionWorker& worker, const std::vector<DesktopIcon*>& icons, const std::vector<Vec2<int>>& points)
+            {
+                return worker.repositionIcons(icons, points).share();
+            }, 
+            "Queue new positions for several icons. Returns a RepositionFuture.")
+        .def("flush", &RepositionWorker::flush, py::call_guard<py::gil_scoped_release>(), 
+            "Submit pending requests immediately and wait until they've been applied.")
+        .def("pendingCount", &RepositionWorker::pendingCount, "Number of icons waiting to be repositioned.");
+}
+
+#endif
@@ -0,0 +1,28 @@
+#include "ShellBackend.h"
+
+#include <cstdio>
+
+using namespace std;
+using namespace DcUtil;
+
+namespace
+{
+    string statusToMessage(ShellStatus status)
+    {
+#ifdef _WIN32
+        string message = errorIdToMessage(static_cast<unsigned long>(status));
+        if (!message.empty())
+            return message;
+#endif
+
+        char code[16];
+        snprintf(code, sizeof(code), "0x%08X", static_cast<unsigned int>(status));
+        return string("Error ") + code;
+    }
+}
+
+ShellError::ShellError(const string& function, ShellStatus status)
+    : runtime_error(function + " failed: " + statusToMessage(status))
+    , code(status)
+{
+}
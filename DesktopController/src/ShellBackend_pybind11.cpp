@@ -0,0 +1,30 @@
+#ifdef PYBIND11_BUILD
+#include <pybind11/pybind11.h>
+
+#include "ShellBackend.h"
+#ifdef _WIN32
+#include "ComShellBackend.h"
+#endif
+
+namespace py = pybind11;
+
+void InitShellBackend_pybind11(py::module& m)
+{
+    // Raised as a RuntimeError subclass, so existing handlers still catch it.
+    py::register_exception<ShellError>(m, "ShellError", PyExc_RuntimeError);
+
+    py::class_<FolderFlags>(m, "FolderFlags")
+        .def(py::init<>())
+        .def_readwrite("autoArrange", &FolderFlags::autoArrange)
+        .def_readwrite("snapToGrid", &FolderFlags::snapToGrid);
+
+    // Backends are held by shared_ptr so they can be passed to the DesktopController constructor.
+    py::class_<ShellBackend, std::shared_ptr<ShellBackend>>(m, "ShellBackend");
+
+#ifdef _WIN32
+    py::class_<ComShellBackend, ShellBackend, std::shared_ptr<ComShellBackend>>(m, "ComShellBackend")
+        .def(py::init<>());
+#endif
+}
+
+#endif
@@ -0,0 +1,168 @@
+#include "ShellCallMetrics.h"
+
+#include <atomic>
+#include <algorithm>
+#include <stdexcept>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace std;
+
+#ifdef ENABLE_SHELL_CALL_METRICS
+namespace
+{
+    const unsigned subBucketBits = 4;
+    const uint64_t subBucketCount = 1 << subBucketBits;
+
+    // Values below subBucketCount get a bucket each. Every higher power of 2 (up to 2^63) 
+    // is split in to subBucketCount buckets.
+    const size_t bucketCount = subBucketCount + (64 - subBucketBits) * subBucketCount;
+
+    unsigned highestBit(uint64_t value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return index;
+#else
+        return 63 - __builtin_clzll(value);
+#endif
+    }
+
+    size_t bucketIndex(uint64_t value)
+    {
+        if (value < subBucketCount)
+            return static_cast<size_t>(value);
+
+        // The bits below the highest set bit select the sub-bucket.
+        unsigned shift = highestBit(value) - subBucketBits;
+        uint64_t subBucket = (value >> shift) - subBucketCount;
+        return static_cast<size_t>(subBucketCount + shift * subBucketCount + subBucket);
+    }
+
+    // Highest value which falls in the given bucket.
+    uint64_t bucketUpperBound(size_t index)
+    {
+        if (index < subBucketCount)
+            return index;
+
+        unsigned shift = static_cast<unsigned>((index - subBucketCount) / subBucketCount);
+        uint64_t subBucket = (index - subBucketCount) % subBucketCount;
+        uint64_t lower = (subBucketCount + subBucket) << shift;
+        return lower + ((uint64_t(1) << shift) - 1);
+    }
+
+    struct Histogram
+    {
+        atomic<uint64_t> count{ 0 };
+        atomic<uint64_t> total{ 0 };
+        atomic<uint64_t> minimum{ UINT64_MAX };
+        atomic<uint64_t> maximum{ 0 };
+        atomic<uint64_t> buckets[bucketCount];
+    };
+
+    // Zero initialised as it has static storage duration.
+    Histogram histograms[static_cast<size_t>(ShellCall::Count)];
+
+    Histogram& histogramFor(ShellCall call)
+    {
+        size_t index = static_cast<size_t>(call);
+        if (index >= static_cast<size_t>(ShellCall::Count))
+            throw runtime_error("Invalid ShellCall");
+
+        return histograms[index];
+    }
+}
+#endif
+
+double ShellCallStats::meanNanoseconds() const
+{
+    return (count == 0 ? 0.0 : static_cast<double>(totalNanoseconds) / count);
+}
+
+uint64_t ShellCallStats::percentileNanoseconds(double percentile) const
+{
+    uint64_t bucketTotal = 0;
+    for (auto& bucket : buckets)
+        bucketTotal += bucket.second;
+
+    if (bucketTotal == 0)
+        return 0;
+
+    percentile = min(max(percentile, 0.0), 100.0);
+    uint64_t rank = max<uint64_t>(1, static_cast<uint64_t>(percentile / 100.0 * bucketTotal + 0.5));
+
+    uint64_t seen = 0;
+    for (auto& bucket : buckets)
+    {
+        seen += bucket.second;
+        if (seen >= rank)
+            return min(bucket.first, maxNanoseconds);
+    }
+
+    return maxNanoseconds;
+}
+
+void recordShellCall(ShellCall call, uint64_t nanoseconds)
+{
+#ifdef ENABLE_SHELL_CALL_METRICS
+    Histogram& h = histogramFor(call);
+
+    h.count.fetch_add(1, memory_order_relaxed);
+    h.total.fetch_add(nanoseconds, memory_order_relaxed);
+    h.buckets[bucketIndex(nanoseconds)].fetch_add(1, memory_order_relaxed);
+
+    uint64_t current = h.minimum.load(memory_order_relaxed);
+    while (nanoseconds < current && !h.minimum.compare_exchange_weak(current, nanoseconds, memory_order_relaxed)) {}
+
+    current = h.maximum.load(memory_order_relaxed);
+    while (nanoseconds > current && !h.maximum.compare_exchange_weak(current, nanoseconds, memory_order_relaxed)) {}
+#else
+    (void)call;
+    (void)nanoseconds;
+#endif
+}
+
+ShellCallStats shellCallStats(ShellCall call)
+{
+    ShellCallStats stats;
+
+#ifdef ENABLE_SHELL_CALL_METRICS
+    Histogram& h = histogramFor(call);
+
+    stats.count = h.count.load(memory_order_relaxed);
+    stats.totalNanoseconds = h.total.load(memory_order_relaxed);
+    stats.maxNanoseconds = h.maximum.load(memory_order_relaxed);
+
+    uint64_t minValue = h.minimum.load(memory_order_relaxed);
+    stats.minNanoseconds = (minValue == UINT64_MAX ? 0 : minValue);
+
+    for (size_t i = 0; i < bucketCount; ++i)
+    {
+        uint64_t n = h.buckets[i].load(memory_order_relaxed);
+        if (n != 0)
+            stats.buckets.emplace_back(bucketUpperBound(i), n);
+    }
+#else
+    (void)call;
+#endif
+
+    return stats;
+}
+
+void resetShellCallStats()
+{
+#ifdef ENABLE_SHELL_CALL_METRICS
+    for (auto& h : histograms)
+    {
+        h.count.store(0, memory_order_relaxed);
+        h.total.store(0, memory_order_relaxed);
+        h.minimum.store(UINT64_MAX, memory_order_relaxed);
+        h.maximum.store(0, memory_order_relaxed);
+
+        for (auto& bucket : h.buckets)
+            bucket.store(0, memory_order_relaxed);
+    }
+#endif
+}
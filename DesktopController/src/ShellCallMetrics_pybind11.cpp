@@ -0,0 +1,31 @@
+#ifdef PYBIND11_BUILD
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "ShellCallMetrics.h"
+
+namespace py = pybind11;
+
+void InitShellCallMetrics_pybind11(py::module& m)
+{
+    py::enum_<ShellCall>(m, "ShellCall")
+        .value("Items", ShellCall::Items)
+        .value("Next", ShellCall::Next)
+        .value("GetItemPosition", ShellCall::GetItemPosition)
+        .value("SelectAndPositionItems", ShellCall::SelectAndPositionItems)
+        .value("GetDisplayNameOf", ShellCall::GetDisplayNameOf);
+
+    py::class_<ShellCallStats>(m, "ShellCallStats")
+        .def_readonly("count", &ShellCallStats::count)
+        .def_readonly("totalNanoseconds", &ShellCallStats::totalNanoseconds)
+        .def_readonly("minNanoseconds", &ShellCallStats::minNanoseconds)
+        .def_readonly("maxNanoseconds", &ShellCallStats::maxNanoseconds)
+        .def_readonly("buckets", &ShellCallStats::buckets)
+        .def("meanNanoseconds", &ShellCallStats::meanNanoseconds, "Mean latency in nanoseconds.")
+        .def("percentileNanoseconds", &ShellCallStats::percentileNanoseconds, "Latency in nanoseconds which the given percentage (0-100) of calls took no longer than.");
+
+    m.def("shellCallStats", &shellCallStats, "Get the latency statistics recorded for a type of Shell call.");
+    m.def("resetShellCallStats", &resetShellCallStats, "Discard all recorded Shell call statistics.");
+}
+
+#endif
@@ -0,0 +1,572 @@
+#include "SlotAssignment.h"
+
+#include <cmath>
+#include <limits>
+#include <cstdlib>
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+using namespace std;
+using namespace DcUtil;
+
+const size_t SlotAssignment::unassigned;
+
+namespace
+{
+    // Number of objects added to a person's candidates at a time, starting with their nearest.
+    const size_t nearestCount = 8;
+
+    // Distance between two points rounded to whole pixels.
+    int64_t distance(const Vec2<int>& a, const Vec2<int>& b)
+    {
+        double dx = static_cast<double>(a.x) - b.x;
+        double dy = static_cast<double>(a.y) - b.y;
+        return static_cast<int64_t>(sqrt(dx * dx + dy * dy) + 0.5);
+    }
+
+    // An object and the distance to it.
+    struct Candidate
+    {
+        int64_t cost;
+        size_t object;
+    };
+
+    // Points bucketed in to square cells, to find the points worth the most from a position by value,
+    // -distance * scale - weight, without measuring the distance to every point. Above the cells is a
+    // pyramid of levels, each with a quarter as many blocks as the one below, holding the lowest weight in
+    // each block. A search visits blocks best first by the most a point in them could be worth, from their
+    // nearest edge and lowest weight, and stops once no block left could beat the worst point found. The
+    // lowest weights are only updated when a cell is searched, so they stay lower bounds as long as weights
+    // only rise between calls to resetWeights().
+    class PointGrid
+    {
+    public:
+        explicit PointGrid(const vector<Vec2<int>>& pointsArg)
+            : points(pointsArg)
+        {
+            origin = points[0];
+            Vec2<int> high = points[0];
+            for (const Vec2<int>& pt : points)
+            {
+                origin = Vec2<int>(min(origin.x, pt.x), min(origin.y, pt.y));
+                high = Vec2<int>(max(high.x, pt.x), max(high.y, pt.y));
+            }
+
+            const double width = static_cast<double>(high.x) - origin.x + 1;
+            const double height = static_cast<double>(high.y) - origin.y + 1;
+            cellSize = max<int64_t>(static_cast<int64_t>(ceil(sqrt(width * height * pointsPerCell / points.size()))), 1);
+
+            Level cells;
+            cells.columns = static_cast<int>((static_cast<int64_t>(high.x) - origin.x) / cellSize) + 1;
+            cells.rows = static_cast<int>((static_cast<int64_t>(high.y) - origin.y) / cellSize) + 1;
+            levels.push_back(cells);
+            while (levels.back().columns > 1 || levels.back().rows > 1)
+            {
+                Level above;
+                above.columns = (levels.back().columns + 1) / 2;
+                above.rows = (levels.back().rows + 1) / 2;
+                levels.push_back(above);
+            }
+            for (Level& level : levels)
+                level.minWeight.assign(static_cast<size_t>(level.columns) * level.rows, empty);
+
+            // Sort point indices by cell, with cellStart[c] the first of cell c.
+            const size_t cellCount = levels[0].minWeight.size();
+            cellStart.assign(cellCount + 1, 0);
+            for (const Vec2<int>& pt : points)
+                ++cellStart[cellOf(pt) + 1];
+            for (size_t c = 0; c < cellCount; ++c)
+                cellStart[c + 1] += cellStart[c];
+
+            vector<size_t> next(cellStart.begin(), cellStart.end() - 1);
+            cellPoints.resize(points.size());
+            for (size_t j = 0; j < points.size(); ++j)
+                cellPoints[next[cellOf(points[j])]++] = j;
+        }
+
+        // Recomputes the lowest weights, after weights have fallen.
+        void resetWeights(const vector<int64_t>& weights)
+        {
+            Level& cells = levels[0];
+            for (size_t c = 0; c < cells.minWeight.size(); ++c)
+            {
+                int64_t lowest = empty;
+                for (size_t k = cellStart[c]; k < cellStart[c + 1]; ++k)
+                    lowest = min(lowest, weights[cellPoints[k]]);
+                cells.minWeight[c] = lowest;
+            }
+
+            for (size_t l = 1; l < levels.size(); ++l)
+            {
+                for (int y = 0; y < levels[l].rows; ++y)
+                {
+                    for (int x = 0; x < levels[l].columns; ++x)
+                        levels[l].minWeight[static_cast<size_t>(y) * levels[l].columns + x] = lowestBelow(l, x, y);
+                }
+            }
+        }
+
+        // Finds the count points worth the most from pt, leaving out those for which skip(point) is true, as
+        // a min heap of (value, point) in best. Returns an upper bound on the value of every other point
+        // which isn't left out, or none if there aren't any.
+        template <typename Skip>
+        int64_t findBest(const Vec2<int>& pt, int64_t scale, const vector<int64_t>& weights, const Skip& skip,
+            size_t count, vector<pair<int64_t, size_t>>& best)
+        {
+            const greater<pair<int64_t, size_t>> byValue;
+            auto byBound = [](const Block& a, const Block& b) { return a.bound < b.bound; };
+            auto worst = [&] { return (best.size() < count ? none : best.front().first); };
+
+            int64_t rest = none;
+            best.clear();
+            queue.clear();
+            queue.push_back({ numeric_limits<int64_t>::max(), levels.size() - 1, 0, 0 });
+
+            while (!queue.empty())
+            {
+                pop_heap(queue.begin(), queue.end(), byBound);
+                const Block block = queue.back();
+                queue.pop_back();
+
+                // Every block left is worth no more than this one.
+                if (block.bound <= worst())
+                {
+                    rest = max(rest, block.bound);
+                    break;
+                }
+
+                if (block.level == 0)
+                {
+                    const size_t c = static_cast<size_t>(block.y) * levels[0].columns + block.x;
+                    int64_t lowest = empty;
+                    for (size_t k = cellStart[c]; k < cellStart[c + 1]; ++k)
+                    {
+                        const size_t j = cellPoints[k];
+                        lowest = min(lowest, weights[j]);
+                        if (skip(j))
+                            continue;
+
+                        const pair<int64_t, size_t> value(-distance(pt, points[j]) * scale - weights[j], j);
+                        if (best.size() < count)
+                        {
+                            best.push_back(value);
+                            push_heap(best.begin(), best.end(), byValue);
+                        }
+                        else if (value > best.front())
+                        {
+                            rest = max(rest, best.front().first);
+                            pop_heap(best.begin(), best.end(), byValue);
+                            best.back() = value;
+                            push_heap(best.begin(), best.end(), byValue);
+                        }
+                        else
+                        {
+                            rest = max(rest, value.first);
+                        }
+                    }
+
+                    updateLowest(block.x, block.y, lowest);
+                    continue;
+                }
+
+                const Level& below = levels[block.level - 1];
+                const int64_t size = cellSize << (block.level - 1);
+                for (int y = block.y * 2; y < min(block.y * 2 + 2, below.rows); ++y)
+                {
+                    for (int x = block.x * 2; x < min(block.x * 2 + 2, below.columns); ++x)
+                    {
+                        const int64_t lowest = below.minWeight[static_cast<size_t>(y) * below.columns + x];
+                        if (lowest == empty)
+                            continue;
+
+                        // Distances are rounded, so they're at least the whole pixels to the nearest edge of the block.
+                        const int64_t left = origin.x + x * size;
+                        const int64_t top = origin.y + y * size;
+                        const int64_t dx = max<int64_t>(max<int64_t>(left - pt.x, pt.x - (left + size - 1)), 0);
+                        const int64_t dy = max<int64_t>(max<int64_t>(top - pt.y, pt.y - (top + size - 1)), 0);
+                        const int64_t edge = static_cast<int64_t>(sqrt(static_cast<double>(dx * dx + dy * dy)));
+
+                        const int64_t bound = -edge * scale - lowest;
+                        if (bound <= worst())
+                        {
+                            rest = max(rest, bound);
+                        }
+                        else
+                        {
+                            queue.push_back({ bound, block.level - 1, x, y });
+                            push_heap(queue.begin(), queue.end(), byBound);
+                        }
+                    }
+                }
+            }
+
+            return rest;
+        }
+
+    private:
+        // Average number of points in each cell.
+        static const int pointsPerCell = 8;
+
+        // Lowest weight of a block with no points.
+        static const int64_t empty = numeric_limits<int64_t>::max();
+
+        struct Level
+        {
+            int columns;
+            int rows;
+            vector<int64_t> minWeight;
+        };
+
+        struct Block
+        {
+            int64_t bound;
+            size_t level;
+            int x;
+            int y;
+        };
+
+        size_t cellOf(const Vec2<int>& pt) const
+        {
+            size_t x = static_cast<size_t>((static_cast<int64_t>(pt.x) - origin.x) / cellSize);
+            size_t y = static_cast<size_t>((static_cast<int64_t>(pt.y) - origin.y) / cellSize);
+            return y * levels[0].columns + x;
+        }
+
+        // Lowest weight of the blocks below block (x, y) of level l.
+        int64_t lowestBelow(size_t l, int x, int y) const
+        {
+            const Level& below = levels[l - 1];
+            int64_t lowest = empty;
+            for (int by = y * 2; by < min(y * 2 + 2, below.rows); ++by)
+            {
+                for (int bx = x * 2; bx < min(x * 2 + 2, below.columns); ++bx)
+                    lowest = min(lowest, below.minWeight[static_cast<size_t>(by) * below.columns + bx]);
+            }
+            return lowest;
+        }
+
+        // Sets the lowest weight of cell (x, y) and passes it up the pyramid until a block's doesn't change.
+        void updateLowest(int x, int y, int64_t lowest)
+        {
+            levels[0].minWeight[static_cast<size_t>(y) * levels[0].columns + x] = lowest;
+            for (size_t l = 1; l < levels.size(); ++l)
+            {
+                x /= 2;
+                y /= 2;
+                int64_t& blockLowest = levels[l].minWeight[static_cast<size_t>(y) * levels[l].columns + x];
+                const int64_t updated = lowestBelow(l, x, y);
+                if (updated == blockLowest)
+                    break;
+                blockLowest = updated;
+            }
+        }
+
+        static const int64_t none = numeric_limits<int64_t>::min();
+
+        const vector<Vec2<int>>& points;
+        Vec2<int> origin;
+        int64_t cellSize;
+        vector<Level> levels;           // Cells first, then each level of the pyramid up to a single block.
+        vector<size_t> cellStart;
+        vector<size_t> cellPoints;
+        vector<Block> queue;            // Heap of blocks left to search, kept to reuse its memory.
+    };
+
+    const int PointGrid::pointsPerCell;
+    const int64_t PointGrid::empty;
+    const int64_t PointGrid::none;
+
+    // Solves an assignment problem with at least as many objects as persons (persons <= objects) with the
+    // auction algorithm, minimizing the total distance between each person and their object. maxCost is at
+    // least the largest distance. Returns the object assigned to each person.
+    //
+    // Costs are multiplied by persons + 1 so that a final epsilon of 1 gives an exactly optimal assignment
+    // for integer costs. Each phase divides epsilon by scaleFactor and keeps the prices of the 
+    // previous phase, which is what makes the algorithm fast in practice.
+    //
+    // Each person bids from a list of candidate objects and keeps an upper bound on the value of every
+    // object outside it. While the best candidate is worth at least the bound, the bid is the one a scan of
+    // every object would make, except that the bound is used as the second best value if it's higher, which
+    // lowers the bid but keeps epsilon complementary slackness. Otherwise the nearestCount objects outside
+    // the list worth the most are found in a PointGrid of the objects weighted by their prices and added to
+    // it, and the bound becomes the value of the best of the rest. Prices only rise during the forward
+    // auction, so the bound stays valid until the reverse auction lowers some, when it's raised to cover
+    // them. Lists start empty, so each person's first candidates are their nearest objects, and only grow
+    // with objects which might be worth more to them. Bids usually cost O(candidates) rather than
+    // O(objects), and memory is O(persons * candidates) rather than O(persons * objects).
+    //
+    // Once every person has an object, objects left over which are priced above the cheapest assigned object
+    // bid for persons in reverse, lowering their prices (Bertsekas and Castanon's forward/reverse auction for
+    // asymmetric problems). Without this, an object bid up in an earlier phase could be left unassigned by 
+    // the final phase despite being the better choice for some person. Reverse bids scan every person.
+    vector<size_t> auction(const vector<Vec2<int>>& personPoints, const vector<Vec2<int>>& objectPoints, int64_t maxCost)
+    {
+        const size_t persons = personPoints.size();
+        const size_t objects = objectPoints.size();
+        vector<size_t> ownerOf(objects, SlotAssignment::unassigned);
+        vector<size_t> objectOf(persons, SlotAssignment::unassigned);
+
+        if (objects == 1)
+        {
+            objectOf[0] = 0;
+            return objectOf;
+        }
+
+        const int64_t scale = static_cast<int64_t>(persons) + 1;
+        const int64_t scaleFactor = 5;
+        const int64_t none = numeric_limits<int64_t>::min();
+
+        auto cost = [&](size_t i, size_t j) -> int64_t { return distance(personPoints[i], objectPoints[j]); };
+        auto benefit = [&](size_t i, size_t j) -> int64_t { return -cost(i, j) * scale; };
+
+        vector<int64_t> prices(objects, 0);
+        vector<int64_t> profits(persons, 0);    // Benefit minus price of each person's object.
+        vector<size_t> unassignedPersons;
+        vector<size_t> overpricedObjects;
+        vector<size_t> loweredObjects;          // Objects whose prices the reverse auction set, each once.
+        vector<bool> lowered(objects, false);
+        unassignedPersons.reserve(persons);
+
+        // The objects each person bids from, and an upper bound on the value of every other object, or
+        // unknown until they've been scanned.
+        const int64_t unknown = numeric_limits<int64_t>::max();
+        vector<vector<Candidate>> candidates(persons);
+        vector<int64_t> outsideValue(persons, unknown);
+
+        // Adds the nearestCount objects outside the candidates of person i which are worth the most to them,
+        // and sets the bound to the value of the best of the rest.
+        PointGrid objectGrid(objectPoints);
+        vector<size_t> candidateOf(objects, SlotAssignment::unassigned);
+        vector<pair<int64_t, size_t>> best;
+        auto addBestOutside = [&](size_t i)
+        {
+            for (const Candidate& candidate : candidates[i])
+                candidateOf[candidate.object] = i;
+
+            outsideValue[i] = objectGrid.findBest(personPoints[i], scale, prices,
+                [&](size_t j) { return candidateOf[j] == i; }, nearestCount, best);
+
+            for (const auto& value : best)
+                candidates[i].push_back({ cost(i, value.second), value.second });
+        };
+
+        int64_t epsilon = max<int64_t>(maxCost * scale / scaleFactor, 1);
+
+        for (;;)
+        {
+            fill(ownerOf.begin(), ownerOf.end(), SlotAssignment::unassigned);
+            fill(objectOf.begin(), objectOf.end(), SlotAssignment::unassigned);
+
+            unassignedPersons.clear();
+            for (size_t i = persons; i-- > 0; )
+                unassignedPersons.push_back(i);
+
+            objectGrid.resetWeights(prices);
+
+            // Forward auction: persons bid for objects until every person has one.
+            while (!unassignedPersons.empty())
+            {
+                size_t person = unassignedPersons.back();
+                unassignedPersons.pop_back();
+
+                // Find the best and second best objects by value (benefit minus price).
+                int64_t bestValue = none;
+                int64_t secondValue = none;
+                size_t bestObject = 0;
+
+                for (;;)
+                {
+                    bestValue = none;
+                    secondValue = none;
+                    for (const Candidate& candidate : candidates[person])
+                    {
+                        int64_t value = -candidate.cost * scale - prices[candidate.object];
+                        if (value > bestValue)
+                        {
+                            secondValue = bestValue;
+                            bestValue = value;
+                            bestObject = candidate.object;
+                        }
+                        else if (value > secondValue)
+                        {
+                            secondValue = value;
+                        }
+                    }
+
+                    if (bestValue >= outsideValue[person])
+                    {
+                        secondValue = max(secondValue, outsideValue[person]);
+                        break;
+                    }
+
+                    addBestOutside(person);
+                }
+
+                // Bid up the best object by the margin over the second best, plus epsilon.
+                prices[bestObject] += bestValue - secondValue + epsilon;
+                profits[person] = secondValue - epsilon;
+
+                size_t previousOwner = ownerOf[bestObject];
+                if (previousOwner != SlotAssignment::unassigned)
+                {
+                    objectOf[previousOwner] = SlotAssignment::unassigned;
+                    unassignedPersons.push_back(previousOwner);
+                }
+
+                ownerOf[bestObject] = person;
+                objectOf[person] = bestObject;
+            }
+
+            // Reverse auction: bring every unassigned object down to the price of the cheapest assigned one.
+            int64_t floorPrice = numeric_limits<int64_t>::max();
+            overpricedObjects.clear();
+            for (size_t j = 0; j < objects; ++j)
+            {
+                if (ownerOf[j] != SlotAssignment::unassigned)
+                    floorPrice = min(floorPrice, prices[j]);
+            }
+            for (size_t j = 0; j < objects; ++j)
+            {
+                if (ownerOf[j] == SlotAssignment::unassigned && prices[j] > floorPrice)
+                    overpricedObjects.push_back(j);
+            }
+
+            while (!overpricedObjects.empty())
+            {
+                size_t object = overpricedObjects.back();
+                overpricedObjects.pop_back();
+
+                // Find the best and second best persons by value (benefit minus profit).
+                int64_t bestValue = none;
+                int64_t secondValue = none;
+                size_t bestPerson = 0;
+
+                const Vec2<int>& pt = objectPoints[object];
+                for (size_t i = 0; i < persons; ++i)
+                {
+                    // Distances are at least the larger offset, which rules most persons out more cheaply.
+                    const int64_t offset = max(abs(static_cast<int64_t>(personPoints[i].x) - pt.x), abs(static_cast<int64_t>(personPoints[i].y) - pt.y));
+                    if (secondValue != none && -offset * scale - profits[i] <= secondValue)
+                        continue;
+
+                    int64_t value = benefit(i, object) - profits[i];
+                    if (value > bestValue)
+                    {
+                        secondValue = bestValue;
+                        bestValue = value;
+                        bestPerson = i;
+                    }
+                    else if (value > secondValue)
+                    {
+                        secondValue = value;
+                    }
+                }
+
+                if (!lowered[object])
+                {
+                    lowered[object] = true;
+                    loweredObjects.push_back(object);
+                }
+
+                // No person would gain enough by switching, so the object stays unassigned at the floorPrice price.
+                if (bestValue - epsilon <= floorPrice)
+                {
+                    prices[object] = floorPrice;
+                    continue;
+                }
+
+                prices[object] = (secondValue == none ? floorPrice : max(floorPrice, secondValue - epsilon));
+                profits[bestPerson] = benefit(bestPerson, object) - prices[object];
+
+                size_t previousObject = objectOf[bestPerson];
+                ownerOf[previousObject] = SlotAssignment::unassigned;
+                if (prices[previousObject] > floorPrice)
+                    overpricedObjects.push_back(previousObject);
+
+                ownerOf[object] = bestPerson;
+                objectOf[bestPerson] = object;
+            }
+
+            // Objects whose prices were lowered may now be worth more than the bounds. Counting candidates
+            // among them only loosens the bounds.
+            for (size_t i = 0; i < persons && !loweredObjects.empty(); ++i)
+            {
+                if (outsideValue[i] == unknown || outsideValue[i] == none)
+                    continue;
+
+                const Vec2<int>& pt = personPoints[i];
+                for (size_t j : loweredObjects)
+                {
+                    const int64_t offset = max(abs(static_cast<int64_t>(objectPoints[j].x) - pt.x), abs(static_cast<int64_t>(objectPoints[j].y) - pt.y));
+                    if (-offset * scale - prices[j] > outsideValue[i])
+                        outsideValue[i] = max(outsideValue[i], benefit(i, j) - prices[j]);
+                }
+            }
+
+            for (size_t j : loweredObjects)
+                lowered[j] = false;
+            loweredObjects.clear();
+
+            if (epsilon == 1)
+                break;
+
+            epsilon = max<int64_t>(epsilon / scaleFactor, 1);
+        }
+
+        return objectOf;
+    }
+}
+
+SlotAssignment assignSlots(const vector<Vec2<int>>& positions, const vector<Vec2<int>>& slots)
+{
+    SlotAssignment result;
+    result.slotOf.assign(positions.size(), SlotAssignment::unassigned);
+
+    if (positions.empty() || slots.empty())
+        return result;
+
+    // The smaller side bids, so that surplus slots (or, with fewer slots than icons, surplus icons) cost nothing.
+    // Distance is symmetric, so the roles only differ in how the result is read back.
+    const bool iconsBid = (positions.size() <= slots.size());
+    const vector<Vec2<int>>& persons = (iconsBid ? positions : slots);
+    const vector<Vec2<int>>& objects = (iconsBid ? slots : positions);
+    const size_t m = persons.size();
+
+    // The diagonal of the box around every point is at least the largest distance, without measuring every pair.
+    Vec2<int> low = persons[0];
+    Vec2<int> high = persons[0];
+    for (const vector<Vec2<int>>* side : { &persons, &objects })
+    {
+        for (const Vec2<int>& pt : *side)
+        {
+            low = Vec2<int>(min(low.x, pt.x), min(low.y, pt.y));
+            high = Vec2<int>(max(high.x, pt.x), max(high.y, pt.y));
+        }
+    }
+    const int64_t maxCost = max<int64_t>(distance(low, high), 1);
+
+    vector<size_t> objectOf = auction(persons, objects, maxCost);
+
+    for (size_t i = 0; i < m; ++i)
+    {
+        if (iconsBid)
+            result.slotOf[i] = objectOf[i];
+        else
+            result.slotOf[objectOf[i]] = i;
+    }
+
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        size_t slot = result.slotOf[i];
+        if (slot == SlotAssignment::unassigned)
+            continue;
+
+        result.totalDistance += distance(positions[i], slots[slot]);
+
+        if (positions[i].x != slots[slot].x || positions[i].y != slots[slot].y)
+            result.moved.push_back(i);
+    }
+
+    return result;
+}
@@ -0,0 +1,20 @@
+#ifdef PYBIND11_BUILD
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "SlotAssignment.h"
+
+namespace py = pybind11;
+
+void InitSlotAssignment_pybind11(py::module& m)
+{
+    py::class_<SlotAssignment>(m, "SlotAssignment")
+        .def_readonly("slotOf", &SlotAssignment::slotOf)
+        .def_readonly("moved", &SlotAssignment::moved)
+        .def_readonly("totalDistance", &SlotAssignment::totalDistance)
+        .def_readonly_static("unassigned", &SlotAssignment::unassigned);
+
+    m.def("assignSlots", &assignSlots, "Assign icons to slots so that the total distance moved is as small as possible.");
+}
+
+#endif
@@ -3,17 +3,202 @@
 #include <random>
 #include <memory>
 #include <cstdarg>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
+#ifdef _WIN32
+// Avoid std::min/std::max collision with min/max macros defined by Windows.h inclusion.
+#define NOMINMAX
+#include <Windows.h>
 #include <shlobj.h>
+#endif
 
 using namespace std;
 
+namespace
+{
+    const char32_t replacementCharacter = 0xFFFD;
+
+    // Calls f with each Unicode code point of s, decoding surrogate pairs where wchar_t is 2 bytes.
+    template <typename F>
+    void forEachCodePoint(const wstring& s, F&& f)
+    {
+        for (size_t i = 0; i < s.size(); ++i)
+        {
+            char32_t c = static_cast<char32_t>(s[i]);
+
+            if (sizeof(wchar_t) == 2 && c >= 0xD800 && c <= 0xDFFF)
+            {
+                char32_t low = (i + 1 < s.size() ? static_cast<char32_t>(s[i + 1]) : 0);
+                if (c <= 0xDBFF && low >= 0xDC00 && low <= 0xDFFF)
+                {
+                    c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+                    ++i;
+                }
+                else
+                {
+                    c = replacementCharacter;
+                }
+            }
+            else if (c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF))
+            {
+                c = replacementCharacter;
+            }
+
+            f(c);
+        }
+    }
+}
+
 namespace DcUtil
 {
     string wstringToOem(const wstring& s)
     {
+#ifdef _WIN32
         auto buf = make_unique<char[]>(s.length() + 1);
         CharToOemW(s.c_str(), buf.get());
         return string(buf.get());
+#else
+        return wstringToUtf8(s);
+#endif
+    }
+
+    string wstringToUtf8(const wstring& s)
+    {
+        string result;
+        result.reserve(s.size());
+
+        forEachCodePoint(s, [&](char32_t c)
+            {
+                if (c < 0x80)
+                {
+                    result.push_back(static_cast<char>(c));
+                }
+                else if (c < 0x800)
+                {
+                    result.push_back(static_cast<char>(0xC0 | (c >> 6)));
+                    result.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+                }
+                else if (c < 0x10000)
+                {
+                    result.push_back(static_cast<char>(0xE0 | (c >> 12)));
+                    result.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+                    result.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+                }
+                else
+                {
+                    result.push_back(static_cast<char>(0xF0 | (c >> 18)));
+                    result.push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3F)));
+                    result.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+                    result.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+                }
+            });
+
+        return result;
+    }
+
+    u16string wstringToUtf16(const wstring& s)
+    {
+        if (sizeof(wchar_t) == 2)
+            return u16string(s.begin(), s.end());
+
+        u16string result;
+        result.reserve(s.size());
+
+        forEachCodePoint(s, [&](char32_t c)
+            {
+                if (c < 0x10000)
+                {
+                    result.push_back(static_cast<char16_t>(c));
+                }
+                else
+                {
+                    c -= 0x10000;
+                    result.push_back(static_cast<char16_t>(0xD800 + (c >> 10)));
+                    result.push_back(static_cast<char16_t>(0xDC00 + (c & 0x3FF)));
+                }
+            });
+
+        return result;
+    }
+
+    wstring utf16ToWstring(const char16_t* s, size_t length)
+    {
+        if (sizeof(wchar_t) == 2)
+            return wstring(s, s + length);
+
+        wstring result;
+        result.reserve(length);
+
+        for (size_t i = 0; i < length; ++i)
+        {
+            char32_t c = s[i];
+            if (c >= 0xD800 && c <= 0xDBFF && i + 1 < length && s[i + 1] >= 0xDC00 && s[i + 1] <= 0xDFFF)
+            {
+                c = 0x10000 + ((c - 0xD800) << 10) + (s[i + 1] - 0xDC00);
+                ++i;
+            }
+            else if (c >= 0xD800 && c <= 0xDFFF)
+            {
+                c = replacementCharacter;
+            }
+
+            result.push_back(static_cast<wchar_t>(c));
+        }
+
+        return result;
+    }
+
+    bool ItemIdView::operator==(const ItemIdView& other) const
+    {
+        return length == other.length && (length == 0 || memcmp(bytes, other.bytes, length) == 0);
+    }
+
+    uint64_t hashBytes(const void* data, size_t size)
+    {
+        const uint64_t offsetBasis = 14695981039346656037ULL;
+        const uint64_t prime = 1099511628211ULL;
+
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        uint64_t hash = offsetBasis;
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= prime;
+        }
+
+        return hash;
+    }
+
+    uint64_t itemIdKey(ItemIdView itemid)
+    {
+        return hashBytes(itemid.data(), itemid.size());
+    }
+
+#ifdef _WIN32
+    string errorIdToMessage(unsigned long id)
+    {
+        LPSTR buffer = nullptr;
+        size_t size = FormatMessageA(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
+            NULL, id, MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), (LPSTR)&buffer, 0, NULL);
+
+        if (!buffer)
+            return string();
+
+        string message(buffer, size);
+        LocalFree(buffer);
+
+        message.erase(std::remove(message.begin(), message.end(), '\n'), message.end());
+
+        return message;
+    }
+
+    void throwLastError(const string& function)
+    {
+        DWORD error = GetLastError();
+        throw runtime_error(function + " failed: (" + to_string(error) + ") " + errorIdToMessage(error));
     }
 
     wstring desktopDirectory()
@@ -24,6 +209,7 @@ namespace DcUtil
         else
             return L"ERROR";
     }
+#endif
 }
 
 // Utilities binding.
@@ -23,7 +23,9 @@ void InitUtil_pybind11(py::module& m)
 
     m.def("wstringToOem", &wstringToOem, "Convert a string of wide characters to an OEM code page.");
     //m.def("randomInt", &randomInt, "Return a random integer in the range min-max (inclusive).");
+#ifdef _WIN32
     m.def("desktopDirectory", &desktopDirectory, "Find the location of the user's desktop directory.");
+#endif
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,285 @@
+#include "Test.h"
+
+using namespace std;
+using namespace DcUtil;
+
+TEST(desktopControllerFindsAndMovesIcons)
+{
+    auto backend = makeDesktop({ L"Notes.txt", L"Report.docx", L"Photo.jpg" });
+    DesktopController dc(backend);
+
+    auto icon = dc.iconByName(L"Report.docx");
+    CHECK(icon != nullptr);
+    CHECK(!dc.iconByName(L"Missing.txt"));
+
+    if (icon)
+    {
+        CHECK(icon->displayName() == L"Report.docx");
+        CHECK(icon->position() == Vec2<int>(0, 100));
+
+        icon->reposition(Vec2<int>(300, 400));
+        CHECK(backend->positionOf(2) == Vec2<int>(300, 400));
+    }
+
+    CHECK(dc.repositionByName({ { L"Photo.jpg", Vec2<int>(10, 20) } }) == 1);
+    CHECK(backend->positionOf(3) == Vec2<int>(10, 20));
+}
+
+TEST(desktopControllerEnumerationOptions)
+{
+    auto backend = makeDesktop({ L"Notes.txt", L"notes.old.TXT", L"Report.docx", L"archive.tar.gz", L"Makefile" });
+    backend->selectItem(3, true);
+    DesktopController dc(backend);
+
+    auto count = [&](const EnumerationOptions& options)
+    {
+        return dc.enumerateIconsWhere(options, [](const DesktopIcon*) { return true; });
+    };
+
+    EnumerationOptions all;
+    CHECK(count(all) == 5);
+
+    EnumerationOptions selected;
+    selected.selectedOnly = true;
+    CHECK(count(selected) == 1);
+
+    // Extensions and prefixes are compared ignoring case, and only the last extension counts.
+    EnumerationOptions text;
+    text.extension = L"txt";
+    CHECK(count(text) == 2);
+
+    EnumerationOptions gz;
+    gz.extension = L".gz";
+    CHECK(count(gz) == 1);
+
+    EnumerationOptions tar;
+    tar.extension = L"tar";
+    CHECK(count(tar) == 0);
+
+    EnumerationOptions prefix;
+    prefix.namePrefix = L"NOTES";
+    CHECK(count(prefix) == 2);
+}
+
+TEST(desktopControllerDisplayQueries)
+{
+    auto backend = makeDesktop({ L"a.txt" });
+    backend->setDisplay(Vec2<int>(2560, 1440), 2, 144);
+    backend->setSpacing(Vec2<int>(90, 110));
+    backend->setCursorPosition(Vec2<int>(12, 34));
+    DesktopController dc(backend);
+
+    DisplayConfiguration config = dc.displayConfiguration();
+    CHECK(config.resolution == Vec2<int>(2560, 1440));
+    CHECK(config.monitorCount == 2);
+    CHECK(config.dpi == 144);
+    CHECK(dc.iconSpacing() == Vec2<int>(90, 110));
+    CHECK(dc.cursorPosition() == Vec2<int>(12, 34));
+    CHECK(!dc.folderFlags().snapToGrid);
+}
+
+namespace
+{
+    // Subscribes to a controller's changes and records each one it's passed.
+    struct ChangeRecorder
+    {
+        explicit ChangeRecorder(DesktopController& dc)
+        {
+            dc.subscribeChanges([this](const DesktopChange& change) { changes.push_back(change); });
+        }
+
+        vector<DesktopChange> changes;
+    };
+}
+
+TEST(desktopControllerProcessesAddedIcons)
+{
+    auto backend = makeDesktop({ L"a.txt", L"b.txt" });
+    DesktopController dc(backend);
+    ChangeRecorder recorder(dc);
+
+    // The miss is remembered, so the name is only found again once the addition is processed.
+    CHECK(!dc.iconByName(L"c.txt"));
+    backend->addItem(L"c.txt", Vec2<int>(0, 200));
+
+    CHECK(dc.processChanges() == 1);
+    CHECK(recorder.changes.size() == 1 && recorder.changes[0].type == DesktopChangeType::Added);
+    CHECK(recorder.changes.size() == 1 && recorder.changes[0].name == L"c.txt");
+    CHECK(dc.iconByName(L"c.txt") != nullptr);
+    CHECK(dc.processChanges() == 0);
+}
+
+TEST(desktopControllerProcessesRemovedIcons)
+{
+    auto backend = makeDesktop({ L"a.txt", L"b.txt" });
+    DesktopController dc(backend);
+    ChangeRecorder recorder(dc);
+
+    CHECK(dc.iconByName(L"b.txt") != nullptr);
+    backend->removeItem(2);
+
+    // The backend can't name the removed item, so its name comes from the index entry with its item ID.
+    CHECK(dc.processChanges() == 1);
+    CHECK(recorder.changes.size() == 1 && recorder.changes[0].type == DesktopChangeType::Removed);
+    CHECK(recorder.changes.size() == 1 && recorder.changes[0].name == L"b.txt");
+    CHECK(!dc.iconByName(L"b.txt"));
+    CHECK(dc.iconByName(L"a.txt") != nullptr);
+}
+
+TEST(desktopControllerProcessesRenamedIcons)
+{
+    auto backend = makeDesktop({ L"a.txt", L"b.txt" });
+    DesktopController dc(backend);
+    ChangeRecorder recorder(dc);
+
+    auto icon = dc.iconByName(L"a.txt");
+    CHECK(icon != nullptr);
+    CHECK(!dc.iconByName(L"z.txt"));
+    backend->renameItem(1, L"z.txt");
+
+    CHECK(dc.processChanges() == 1);
+    CHECK(recorder.changes.size() == 1 && recorder.changes[0].type == DesktopChangeType::Renamed);
+    CHECK(recorder.changes.size() == 1 && recorder.changes[0].name == L"a.txt");
+    CHECK(recorder.changes.size() == 1 && recorder.changes[0].newName == L"z.txt");
+    CHECK(!dc.iconByName(L"a.txt"));
+
+    auto renamed = dc.iconByName(L"z.txt");
+    CHECK(renamed != nullptr);
+    if (renamed)
+    {
+        CHECK(renamed->position() == Vec2<int>(0, 0));
+        CHECK(dc.applyLayout({ renamed.get() }, { Vec2<int>(300, 0) }) == 0);
+        CHECK(backend->positionOf(1) == Vec2<int>(300, 0));
+    }
+}
+
+TEST(desktopControllerProcessesMovedIcons)
+{
+    auto backend = makeDesktop({ L"a.txt", L"b.txt" });
+    DesktopController dc(backend);
+    ChangeRecorder recorder(dc);
+
+    auto icons = dc.allIcons();
+    vector<DesktopIcon*> layout = { icons[0].get(), icons[1].get() };
+    vector<Vec2<int>> points = { Vec2<int>(300, 0), Vec2<int>(300, 100) };
+    CHECK(dc.applyLayout(layout, points) == 0);
+
+    // Until the user's move is processed, the icon is skipped since its target hasn't changed.
+    backend->moveItem(1, Vec2<int>(600, 600));
+    CHECK(dc.applyLayout(layout, points) == 2);
+    CHECK(backend->positionOf(1) == Vec2<int>(600, 600));
+
+    CHECK(dc.processChanges() == 1);
+    CHECK(recorder.changes.size() == 1 && recorder.changes[0].type == DesktopChangeType::Moved);
+    CHECK(recorder.changes.size() == 1 && recorder.changes[0].name == L"a.txt");
+    CHECK(dc.applyLayout(layout, points) == 1);
+    CHECK(backend->positionOf(1) == Vec2<int>(300, 0));
+
+    // Moves don't affect the name index.
+    CHECK(dc.iconByName(L"a.txt") != nullptr);
+}
+
+TEST(desktopControllerProcessesUpdatedDesktop)
+{
+    auto backend = makeDesktop({ L"a.txt", L"b.txt" });
+    DesktopController dc(backend);
+    ChangeRecorder recorder(dc);
+
+    CHECK(dc.iconByName(L"a.txt") != nullptr);
+    backend->clear();
+    backend->addItem(L"c.txt", Vec2<int>(0, 0));
+
+    CHECK(dc.processChanges() == 2);
+    CHECK(recorder.changes.size() == 2 && recorder.changes[0].type == DesktopChangeType::Updated);
+    CHECK(recorder.changes.size() == 2 && recorder.changes[1].type == DesktopChangeType::Added);
+    CHECK(!dc.iconByName(L"a.txt"));
+    CHECK(dc.iconByName(L"c.txt") != nullptr);
+}
+
+TEST(desktopControllerUnsubscribeDiscardsChanges)
+{
+    auto backend = makeDesktop({ L"a.txt" });
+    DesktopController dc(backend);
+
+    size_t calls = 0;
+    int first = dc.subscribeChanges([&](const DesktopChange&) { ++calls; });
+    int second = dc.subscribeChanges([&](const DesktopChange&) { ++calls; });
+
+    // Every callback is passed each change.
+    backend->addItem(L"b.txt", Vec2<int>(0, 100));
+    CHECK(dc.processChanges() == 1);
+    CHECK(calls == 2);
+
+    // Changes are queued as long as any callback remains, and discarded once none does.
+    dc.unsubscribeChanges(first);
+    backend->addItem(L"c.txt", Vec2<int>(0, 200));
+    dc.unsubscribeChanges(second);
+    backend->addItem(L"d.txt", Vec2<int>(0, 300));
+
+    dc.subscribeChanges([&](const DesktopChange&) { ++calls; });
+    CHECK(dc.processChanges() == 0);
+    CHECK(calls == 2);
+
+    CHECK_THROWS(runtime_error, dc.subscribeChanges(function<void(const DesktopChange&)>()));
+}
+
+// A hit in the name index is checked by its item ID, without fetching the name, and only a stale item ID
+// rebuilds the index.
+TEST(desktopControllerVerifiesIndexedNamesByItemId)
+{
+    auto backend = makeDesktop({ L"a.txt", L"b.txt", L"c.txt" });
+    DesktopController dc(backend);
+    CHECK(dc.iconByName(L"b.txt") != nullptr);
+
+    backend->resetCallCounts();
+    CHECK(dc.iconByName(L"b.txt") != nullptr);
+    CHECK(backend->callCount(ShellCall::GetItemPosition) == 1);
+    CHECK(backend->callCount(ShellCall::GetDisplayNameOf) == 0);
+    CHECK(backend->callCount(ShellCall::Items) == 0);
+
+    // Renaming changes the item ID, so the entry no longer matches and the index is rebuilt.
+    backend->renameItem(2, L"z.txt");
+    backend->resetCallCounts();
+    CHECK(!dc.iconByName(L"b.txt"));
+    CHECK(backend->callCount(ShellCall::Items) == 1);
+    CHECK(dc.iconByName(L"z.txt") != nullptr);
+    CHECK(backend->callCount(ShellCall::Items) == 1);
+}
+
+// The chunk size a chunked reposition settles on is only reused by calls with the same limits.
+TEST(desktopControllerChunkSizeHintFollowsOptions)
+{
+    vector<wstring> names;
+    for (int i = 0; i < 200; ++i)
+        names.push_back(to_wstring(i) + L".txt");
+    auto backend = makeDesktop(names);
+    DesktopController dc(backend);
+
+    auto all = dc.allIcons();
+    vector<DesktopIcon*> icons;
+    vector<Vec2<int>> points;
+    for (auto& icon : all)
+    {
+        icons.push_back(icon.get());
+        points.push_back(icon->position() + Vec2<int>(10, 0));
+    }
+
+    ChunkingOptions fixed;
+    fixed.minChunkSize = 64;
+    fixed.maxChunkSize = 64;
+    auto report = dc.repositionIconsChunked(icons, points, fixed);
+    CHECK(!report.chunks.empty() && report.chunks[0].count == 64);
+
+    report = dc.repositionIconsChunked(icons, points, fixed);
+    CHECK(!report.chunks.empty() && report.chunks[0].count == 64);
+
+    // Other limits start from the default size rather than from the size found under fixed.
+    ChunkingOptions adaptive;
+    report = dc.repositionIconsChunked(icons, points, adaptive);
+    CHECK(!report.chunks.empty() && report.chunks[0].count == AdaptiveChunker::defaultChunkSize);
+
+    ChunkingOptions shortStall;
+    shortStall.maxStall = chrono::milliseconds(5);
+    report = dc.repositionIconsChunked(icons, points, shortStall);
+    CHECK(!report.chunks.empty() && report.chunks[0].count == AdaptiveChunker::defaultChunkSize);
+}
@@ -0,0 +1,138 @@
+#include "Test.h"
+#include "DesktopSnapshot.h"
+#include "IconSearchIndex.h"
+
+using namespace std;
+using namespace DcUtil;
+
+namespace
+{
+    // Counts the records of a diff of each type.
+    vector<size_t> countTypes(const vector<SnapshotChange>& changes)
+    {
+        vector<size_t> counts(4, 0);
+        for (const SnapshotChange& change : changes)
+            ++counts[static_cast<size_t>(change.type)];
+        return counts;
+    }
+
+    size_t count(const vector<SnapshotChange>& changes, SnapshotChangeType type)
+    {
+        return countTypes(changes)[static_cast<size_t>(type)];
+    }
+}
+
+// Icons keep their key when moved, and an edited icon whose key changed is matched by its name.
+TEST(diffSnapshotsMatchesByKeyThenName)
+{
+    auto backend = makeDesktop({ L"a.txt", L"b.txt", L"c.txt" });
+    DesktopController dc(backend);
+    DesktopSnapshot before = dc.snapshot();
+
+    backend->moveItem(1, Vec2<int>(500, 500));
+    backend->touchItem(2);
+    backend->touchItem(3);
+    backend->moveItem(3, Vec2<int>(600, 600));
+    DesktopSnapshot after = dc.snapshot();
+
+    auto changes = diffSnapshots(before, after);
+    CHECK(changes.size() == 2);
+    CHECK(count(changes, SnapshotChangeType::Moved) == 2);
+    if (changes.size() == 2)
+    {
+        CHECK(changes[0].beforeIndex == 0 && changes[0].afterIndex == 0);
+        CHECK(changes[1].beforeIndex == 2 && changes[1].afterIndex == 2);
+    }
+
+    CHECK(diffSnapshots(after, after).empty());
+}
+
+// Renaming changes the item ID, so the icon can't be matched by key or name. It's never paired by position.
+TEST(diffSnapshotsRenameInPlace)
+{
+    auto backend = makeDesktop({ L"a.txt", L"b.txt", L"c.txt" });
+    DesktopController dc(backend);
+    DesktopSnapshot before = dc.snapshot();
+
+    backend->renameItem(2, L"z.txt");
+    DesktopSnapshot after = dc.snapshot();
+
+    auto changes = diffSnapshots(before, after);
+    CHECK(changes.size() == 2);
+    CHECK(count(changes, SnapshotChangeType::Renamed) == 0);
+    if (changes.size() == 2)
+    {
+        CHECK(changes[0].type == SnapshotChangeType::Removed && changes[0].beforeIndex == 1);
+        CHECK(changes[1].type == SnapshotChangeType::Added && changes[1].afterIndex == 1);
+    }
+}
+
+TEST(diffSnapshotsDeleteThenCreateAtSameSlot)
+{
+    auto backend = makeDesktop({ L"a.txt", L"b.txt", L"c.txt" });
+    DesktopController dc(backend);
+    DesktopSnapshot before = dc.snapshot();
+
+    backend->removeItem(2);
+    backend->addItem(L"new.txt", Vec2<int>(0, 100));
+    DesktopSnapshot after = dc.snapshot();
+
+    auto changes = diffSnapshots(before, after);
+    CHECK(changes.size() == 2);
+    CHECK(count(changes, SnapshotChangeType::Renamed) == 0);
+    if (changes.size() == 2)
+    {
+        CHECK(changes[0].type == SnapshotChangeType::Removed && changes[0].beforeIndex == 1);
+        CHECK(changes[1].type == SnapshotChangeType::Added && changes[1].afterIndex == 2);
+    }
+}
+
+// A display name which changes while the item ID doesn't is reported as Renamed, even if the icon moved too.
+TEST(diffSnapshotsRenamedKeepsKey)
+{
+    const ItemId first = { 1, 2, 3, 4 };
+    const ItemId second = { 5, 6, 7, 8 };
+
+    DesktopSnapshot before;
+    before.append(first, L"Recycle Bin", Vec2<int>(0, 0));
+    before.append(second, L"This PC", Vec2<int>(0, 100));
+
+    DesktopSnapshot after;
+    after.append(first, L"Papierkorb", Vec2<int>(0, 0));
+    after.append(second, L"Dieser PC", Vec2<int>(0, 300));
+
+    auto changes = diffSnapshots(before, after);
+    CHECK(changes.size() == 2);
+    CHECK(count(changes, SnapshotChangeType::Renamed) == 2);
+}
+
+// IconSearchIndex::update() re-keys edited icons the same way diffSnapshots() pairs them, including when
+// several icons share a name and only some of their keys changed.
+TEST(iconSearchIndexUpdateRekeysDuplicateNames)
+{
+    const ItemId unchanged = { 1, 1, 1, 1 };
+    const ItemId edited = { 2, 2, 2, 2 };
+    const ItemId editedAfter = { 3, 3, 3, 3 };
+
+    DesktopSnapshot before;
+    before.append(unchanged, L"dup.txt", Vec2<int>(0, 0));
+    before.append(edited, L"dup.txt", Vec2<int>(0, 100));
+
+    // The edited icon is enumerated first now, so it's paired with the first icon of that name whose key changed.
+    DesktopSnapshot after;
+    after.append(editedAfter, L"dup.txt", Vec2<int>(0, 100));
+    after.append(unchanged, L"dup.txt", Vec2<int>(0, 0));
+
+    auto changes = diffSnapshots(before, after);
+    CHECK(changes.empty());
+
+    IconSearchIndex index;
+    index.assign(before);
+    index.update(before, after, changes);
+    CHECK(index.size() == 2);
+
+    auto results = index.prefix(L"dup");
+    CHECK(results.size() == 2);
+    for (auto& result : results)
+        CHECK(result.key == itemIdKey(unchanged) || result.key == itemIdKey(editedAfter));
+}
@@ -0,0 +1,14 @@
+#include "Test.h"
+#include "IconSearchIndex.h"
+
+using namespace std;
+using namespace DcUtil;
+
+// Case and accents are ignored, on Windows through the NLS functions and elsewhere through a table.
+TEST(iconSearchIndexNormalize)
+{
+    CHECK(IconSearchIndex::normalize(L"RÉSUMÉ.pdf") == L"resume.pdf");
+    CHECK(IconSearchIndex::normalize(L"Łódź") == L"łodz");
+    CHECK(IconSearchIndex::normalize(L"Café") == L"cafe");
+    CHECK(IconSearchIndex::normalize(L"") == L"");
+}
@@ -0,0 +1,100 @@
+#include "Test.h"
+#include "LayoutFile.h"
+
+#include <cstdio>
+
+using namespace std;
+using namespace DcUtil;
+
+namespace
+{
+    wstring layoutPath()
+    {
+        const string path = "DesktopControllerTest.layout";
+        return wstring(path.begin(), path.end());
+    }
+}
+
+// Names are stored as UTF-16 whatever the size of wchar_t, including characters outside the Basic
+// Multilingual Plane which take two code units.
+TEST(layoutFileRoundTrip)
+{
+    const vector<wstring> names = { L"Notes.txt", L"Résumé.pdf", L"Rocket \U0001F680.lnk", L"" };
+    const vector<Vec2<int>> positions = { Vec2<int>(0, 0), Vec2<int>(75, 100), Vec2<int>(-10, 2000), Vec2<int>(1, 2) };
+    const wstring path = layoutPath();
+
+    writeLayoutFile(path, names, positions);
+    {
+        LayoutFileView layout(path);
+        CHECK(layout.size() == names.size());
+        for (size_t i = 0; i < names.size() && i < layout.size(); ++i)
+        {
+            CHECK(layout.name(i) == names[i]);
+            CHECK(layout.nameEquals(i, names[i]));
+            CHECK(layout.position(i) == positions[i]);
+            CHECK(layout.entry(i).nameHash == layoutNameHash(names[i]));
+        }
+
+        // The rocket is a surrogate pair in the file.
+        CHECK(layout.entry(2).nameLength == 13);
+        CHECK(!layout.nameEquals(0, L"Notes.txt "));
+    }
+    remove(wstringToUtf8(path).c_str());
+}
+
+TEST(layoutFileRestore)
+{
+    auto backend = makeDesktop({ L"a.txt", L"b.txt", L"c.txt" });
+    DesktopController dc(backend);
+    const wstring path = layoutPath();
+
+    writeLayoutFile(path, { L"c.txt", L"a.txt", L"gone.txt" }, { Vec2<int>(500, 0), Vec2<int>(600, 0), Vec2<int>(700, 0) });
+    {
+        LayoutFileView layout(path);
+        CHECK(dc.restoreLayout(layout) == 2);
+    }
+    remove(wstringToUtf8(path).c_str());
+
+    CHECK(backend->positionOf(1) == Vec2<int>(600, 0));
+    CHECK(backend->positionOf(2) == Vec2<int>(0, 100));
+    CHECK(backend->positionOf(3) == Vec2<int>(500, 0));
+}
+
+// Only the first entry with each name is applied, and enumeration stops once every distinct name has
+// been matched, however many entries share a name.
+TEST(layoutFileRestoreDuplicateNames)
+{
+    auto backend = makeDesktop({ L"a.txt", L"b.txt", L"c.txt", L"d.txt" });
+    DesktopController dc(backend);
+    const wstring path = layoutPath();
+
+    writeLayoutFile(path, 
+        { L"a.txt", L"b.txt", L"a.txt", L"b.txt" }, 
+        { Vec2<int>(500, 0), Vec2<int>(600, 0), Vec2<int>(700, 0), Vec2<int>(800, 0) });
+    {
+        LayoutFileView layout(path);
+        backend->resetCallCounts();
+        CHECK(dc.restoreLayout(layout) == 2);
+        CHECK(backend->callCount(ShellCall::GetDisplayNameOf) == 2);
+    }
+    remove(wstringToUtf8(path).c_str());
+
+    CHECK(backend->positionOf(1) == Vec2<int>(500, 0));
+    CHECK(backend->positionOf(2) == Vec2<int>(600, 0));
+}
+
+TEST(layoutFileRejectsInvalidFiles)
+{
+    CHECK_THROWS(runtime_error, LayoutFileView missing(L"DesktopControllerTest.missing"));
+
+    const wstring path = layoutPath();
+    FILE* file = fopen(wstringToUtf8(path).c_str(), "wb");
+    CHECK(file != nullptr);
+    if (file)
+    {
+        fputs("not a layout file", file);
+        fclose(file);
+    }
+    CHECK_THROWS(runtime_error, LayoutFileView invalid(path));
+    remove(wstringToUtf8(path).c_str());
+}
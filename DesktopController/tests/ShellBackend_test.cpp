@@ -0,0 +1,164 @@
+#include "Test.h"
+
+using namespace std;
+using namespace DcUtil;
+
+// Item IDs are opaque byte strings owned by the caller. Each one round trips through the backend.
+TEST(shellBackendItemIdsRoundTrip)
+{
+    auto backend = makeDesktop({ L"a.txt", L"b.txt", L"c.txt" });
+    ShellBackend& shell = *backend;
+
+    unique_ptr<ShellItemEnumerator> items;
+    CHECK(shell.items(ShellItemSet::All, items) == shellOk);
+    CHECK(items != nullptr);
+
+    // Fewer items than requested are returned with shellFalse.
+    vector<ItemId> itemids(5);
+    size_t fetched = 0;
+    CHECK(items->next(itemids.data(), itemids.size(), fetched) == shellFalse);
+    CHECK(fetched == 3);
+
+    wstring name;
+    CHECK(shell.displayName(itemids[1], ShellNameKind::Display, name) == shellOk);
+    CHECK(name == L"b.txt");
+
+    Vec2<int> position;
+    CHECK(shell.itemPosition(itemids[2], position) == shellOk);
+    CHECK(position == Vec2<int>(0, 200));
+
+    // Copies are equal and have the same key, so they refer to the same item.
+    ItemId copy = ItemIdView(itemids[1]).copy();
+    CHECK(ItemIdView(copy) == ItemIdView(itemids[1]));
+    CHECK(ItemIdView(copy) != ItemIdView(itemids[0]));
+    CHECK(itemIdKey(copy) == itemIdKey(itemids[1]));
+    CHECK(itemIdKey(copy) != itemIdKey(itemids[0]));
+
+    // An empty or truncated item ID doesn't refer to an item.
+    CHECK(shell.itemPosition(ItemId(), position) == shellInvalidArgument);
+    CHECK(shell.itemPosition(ItemIdView(copy.data(), copy.size() - 1), position) == shellInvalidArgument);
+}
+
+TEST(shellBackendSelection)
+{
+    auto backend = makeDesktop({ L"a.txt", L"b.txt", L"c.txt" });
+    backend->selectItem(2, true);
+
+    unique_ptr<ShellItemEnumerator> items;
+    CHECK(backend->items(ShellItemSet::Selection, items) == shellOk);
+
+    ItemId itemid;
+    size_t fetched = 0;
+    CHECK(items != nullptr && items->next(&itemid, 1, fetched) == shellOk);
+    CHECK(fetched == 1);
+
+    wstring name;
+    backend->displayName(itemid, ShellNameKind::Display, name);
+    CHECK(name == L"b.txt");
+}
+
+TEST(shellBackendPositionItemsFollowsFolderFlags)
+{
+    auto backend = makeDesktop({ L"a.txt" });
+
+    unique_ptr<ShellItemEnumerator> items;
+    backend->items(ShellItemSet::All, items);
+    ItemId itemid;
+    size_t fetched = 0;
+    items->next(&itemid, 1, fetched);
+
+    const ItemIdView view(itemid);
+    const Vec2<int> point(80, 140);
+
+    CHECK(backend->positionItems(1, &view, &point) == shellOk);
+    CHECK(backend->positionOf(1) == point);
+
+    FolderFlags flags;
+    flags.snapToGrid = true;
+    backend->setFolderFlags(flags);
+    CHECK(backend->positionItems(1, &view, &point) == shellOk);
+    CHECK(backend->positionOf(1) == Vec2<int>(75, 100));
+
+    // Auto arrange ignores the position.
+    flags.autoArrange = true;
+    backend->setFolderFlags(flags);
+    const Vec2<int> elsewhere(900, 900);
+    CHECK(backend->positionItems(1, &view, &elsewhere) == shellOk);
+    CHECK(backend->positionOf(1) == Vec2<int>(75, 100));
+
+    FolderFlags read;
+    CHECK(backend->folderFlags(read) == shellOk);
+    CHECK(read.snapToGrid && read.autoArrange);
+}
+
+TEST(shellErrorCarriesStatus)
+{
+    try
+    {
+        throw ShellError("GetItemPosition", shellInvalidArgument);
+    }
+    catch (const ShellError& e)
+    {
+        CHECK(e.status() == shellInvalidArgument);
+        CHECK(string(e.what()).find("GetItemPosition failed") == 0);
+    }
+
+    CHECK(shellSucceeded(shellOk));
+    CHECK(shellSucceeded(shellFalse));
+    CHECK(!shellSucceeded(shellFailure));
+}
+
+// Changes are queued only while subscribed, and removed and renamed items are identified by their old item ID.
+TEST(memoryShellBackendQueuesChanges)
+{
+    auto backend = makeDesktop({ L"a.txt", L"b.txt", L"c.txt" });
+    backend->addItem(L"ignored.txt", Vec2<int>(0, 300));
+
+    vector<ShellChange> changes;
+    auto record = [&](const ShellChange& change) { changes.push_back(change); };
+    CHECK(backend->pollChanges(record) == 0);
+
+    ItemId a, b;
+    backend->createItemID(1, a);
+    backend->createItemID(2, b);
+
+    backend->subscribeChanges();
+    backend->renameItem(1, L"z.txt");
+    backend->removeItem(2);
+    backend->moveItem(3, Vec2<int>(500, 500));
+    backend->touchItem(3);
+    uint32_t added = backend->addItem(L"d.txt", Vec2<int>(0, 400));
+
+    CHECK(backend->pollChanges(record) == 4);
+    CHECK(changes.size() == 4);
+    if (changes.size() == 4)
+    {
+        CHECK(changes[0].type == DesktopChangeType::Renamed);
+        CHECK(ItemIdView(changes[0].itemid) == ItemIdView(a));
+        CHECK(changes[0].name.empty() && changes[0].newName == L"z.txt");
+
+        CHECK(changes[1].type == DesktopChangeType::Removed);
+        CHECK(ItemIdView(changes[1].itemid) == ItemIdView(b));
+        CHECK(changes[1].name.empty());
+
+        CHECK(changes[2].type == DesktopChangeType::Moved);
+        CHECK(changes[2].name == L"c.txt");
+
+        ItemId d;
+        backend->createItemID(added, d);
+        CHECK(changes[3].type == DesktopChangeType::Added);
+        CHECK(ItemIdView(changes[3].itemid) == ItemIdView(d));
+        CHECK(changes[3].name == L"d.txt");
+    }
+
+    // The old item IDs no longer refer to an item.
+    Vec2<int> position;
+    CHECK(backend->itemPosition(a, position) != shellOk);
+    CHECK(backend->itemPosition(b, position) != shellOk);
+
+    backend->clear();
+    backend->unsubscribeChanges();
+    backend->addItem(L"e.txt", Vec2<int>(0, 0));
+    backend->subscribeChanges();
+    CHECK(backend->pollChanges(record) == 0);
+}
@@ -0,0 +1,171 @@
+#include "Test.h"
+#include "SlotAssignment.h"
+
+#include <cmath>
+#include <random>
+#include <limits>
+
+using namespace std;
+using namespace DcUtil;
+
+namespace
+{
+    int64_t roundedDistance(const Vec2<int>& a, const Vec2<int>& b)
+    {
+        double dx = static_cast<double>(a.x) - b.x;
+        double dy = static_cast<double>(a.y) - b.y;
+        return llround(sqrt(dx * dx + dy * dy));
+    }
+
+    // Smallest total distance of an assignment, from the Hungarian algorithm, for comparison with assignSlots().
+    int64_t minimumTotalDistance(const vector<Vec2<int>>& positions, const vector<Vec2<int>>& slots)
+    {
+        // Rows are the smaller side. Indices are 1 based, with 0 as a sentinel column.
+        const bool rowsAreIcons = (positions.size() <= slots.size());
+        const vector<Vec2<int>>& rows = (rowsAreIcons ? positions : slots);
+        const vector<Vec2<int>>& columns = (rowsAreIcons ? slots : positions);
+        const size_t n = rows.size();
+        const size_t m = columns.size();
+        const int64_t infinity = numeric_limits<int64_t>::max() / 4;
+
+        auto cost = [&](size_t i, size_t j) { return roundedDistance(rows[i - 1], columns[j - 1]); };
+
+        vector<int64_t> u(n + 1, 0), v(m + 1, 0);
+        vector<size_t> rowOf(m + 1, 0), way(m + 1, 0);
+        for (size_t i = 1; i <= n; ++i)
+        {
+            rowOf[0] = i;
+            size_t j0 = 0;
+            vector<int64_t> minValue(m + 1, infinity);
+            vector<bool> used(m + 1, false);
+            do
+            {
+                used[j0] = true;
+                size_t i0 = rowOf[j0];
+                size_t j1 = 0;
+                int64_t delta = infinity;
+                for (size_t j = 1; j <= m; ++j)
+                {
+                    if (used[j])
+                        continue;
+                    int64_t reduced = cost(i0, j) - u[i0] - v[j];
+                    if (reduced < minValue[j])
+                    {
+                        minValue[j] = reduced;
+                        way[j] = j0;
+                    }
+                    if (minValue[j] < delta)
+                    {
+                        delta = minValue[j];
+                        j1 = j;
+                    }
+                }
+                for (size_t j = 0; j <= m; ++j)
+                {
+                    if (used[j])
+                    {
+                        u[rowOf[j]] += delta;
+                        v[j] -= delta;
+                    }
+                    else
+                    {
+                        minValue[j] -= delta;
+                    }
+                }
+                j0 = j1;
+            } while (rowOf[j0] != 0);
+
+            do
+            {
+                size_t j1 = way[j0];
+                rowOf[j0] = rowOf[j1];
+                j0 = j1;
+            } while (j0 != 0);
+        }
+
+        int64_t total = 0;
+        for (size_t j = 1; j <= m; ++j)
+        {
+            if (rowOf[j] != 0)
+                total += cost(rowOf[j], j);
+        }
+        return total;
+    }
+
+    vector<Vec2<int>> grid(size_t count)
+    {
+        vector<Vec2<int>> slots;
+        for (size_t i = 0; i < count; ++i)
+            slots.push_back(Vec2<int>(static_cast<int>(i / 10) * 75, static_cast<int>(i % 10) * 100));
+        return slots;
+    }
+
+    vector<Vec2<int>> scattered(size_t count, int width, int height, unsigned seed)
+    {
+        mt19937 random(seed);
+        uniform_int_distribution<int> x(0, width - 1);
+        uniform_int_distribution<int> y(0, height - 1);
+
+        vector<Vec2<int>> positions;
+        for (size_t i = 0; i < count; ++i)
+            positions.push_back(Vec2<int>(x(random), y(random)));
+        return positions;
+    }
+
+    // Checks that no slot is given to two icons, that the smaller side is fully assigned, and that the
+    // total distance is minimal.
+    void checkOptimal(const vector<Vec2<int>>& positions, const vector<Vec2<int>>& slots)
+    {
+        SlotAssignment result = assignSlots(positions, slots);
+
+        vector<bool> taken(slots.size(), false);
+        size_t assigned = 0;
+        int64_t total = 0;
+        for (size_t i = 0; i < positions.size(); ++i)
+        {
+            size_t slot = result.slotOf[i];
+            if (slot == SlotAssignment::unassigned)
+                continue;
+
+            CHECK(slot < slots.size() && !taken[slot]);
+            if (slot >= slots.size())
+                continue;
+            taken[slot] = true;
+            ++assigned;
+            total += roundedDistance(positions[i], slots[slot]);
+        }
+
+        CHECK(assigned == min(positions.size(), slots.size()));
+        CHECK(total == result.totalDistance);
+        CHECK(result.totalDistance == minimumTotalDistance(positions, slots));
+    }
+}
+
+// Icons crowded in to one corner compete for the same nearest slots, so most have to look beyond them.
+TEST(assignSlotsCrowdedIconsAreOptimal)
+{
+    checkOptimal(scattered(60, 150, 150, 1), grid(120));
+    checkOptimal(scattered(100, 40, 40, 2), grid(100));
+}
+
+TEST(assignSlotsScatteredIconsAreOptimal)
+{
+    checkOptimal(scattered(80, 1500, 1000, 3), grid(80));
+    checkOptimal(scattered(40, 1500, 1000, 4), grid(200));
+    checkOptimal(scattered(150, 1500, 1000, 5), grid(50));
+    checkOptimal(scattered(5, 1500, 1000, 6), grid(3));
+}
+
+// Icons stacked on one point, and slots in a single row, which leave the grid assignSlots() searches for
+// candidates with a single cell or a single row of cells.
+TEST(assignSlotsDegenerateLayoutsAreOptimal)
+{
+    checkOptimal(vector<Vec2<int>>(30, Vec2<int>(400, 300)), grid(60));
+
+    vector<Vec2<int>> row;
+    for (int i = 0; i < 50; ++i)
+        row.push_back(Vec2<int>(i * 75, 0));
+    checkOptimal(scattered(40, 3000, 500, 7), row);
+    checkOptimal(scattered(70, 3000, 500, 8), row);
+    checkOptimal(row, vector<Vec2<int>>(20, Vec2<int>(1000, 0)));
+}
@@ -0,0 +1,90 @@
+#include "Test.h"
+
+#include <cstring>
+
+using namespace std;
+using namespace DcUtil;
+
+namespace
+{
+    struct RegisteredTest
+    {
+        const char* name;
+        TestFunction function;
+    };
+
+    // Constructed on first use since registrations are static objects in other translation units.
+    vector<RegisteredTest>& registeredTests()
+    {
+        static vector<RegisteredTest> tests;
+        return tests;
+    }
+
+    size_t failedChecks = 0;
+}
+
+TestRegistration::TestRegistration(const char* name, TestFunction function)
+{
+    registeredTests().push_back({ name, function });
+}
+
+void checkCondition(bool condition, const char* text, const char* file, int line)
+{
+    if (condition)
+        return;
+
+    fmt::print("  {}({}): check failed: {}\n", file, line, text);
+    ++failedChecks;
+}
+
+shared_ptr<MemoryShellBackend> makeDesktop(const vector<wstring>& names)
+{
+    auto backend = make_shared<MemoryShellBackend>();
+    for (size_t i = 0; i < names.size(); ++i)
+        backend->addItem(names[i], Vec2<int>(0, static_cast<int>(i) * 100));
+    return backend;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t run = 0;
+    int failed = 0;
+
+    for (auto& test : registeredTests())
+    {
+        bool selected = (argc < 2);
+        for (int i = 1; i < argc && !selected; ++i)
+            selected = (strcmp(argv[i], test.name) == 0);
+
+        if (!selected)
+            continue;
+
+        const size_t failedBefore = failedChecks;
+        try
+        {
+            test.function();
+        }
+        catch (const std::exception& e)
+        {
+            fmt::print("  unexpected exception: {}\n", e.what());
+            ++failedChecks;
+        }
+
+        const bool passed = (failedChecks == failedBefore);
+        fmt::print("{} {}\n", passed ? "passed" : "FAILED", test.name);
+        if (!passed)
+            ++failed;
+        ++run;
+    }
+
+    if (run == 0)
+    {
+        fmt::print("No test matches. Available tests:\n");
+        for (auto& test : registeredTests())
+            fmt::print("\t{}\n", test.name);
+        return 1;
+    }
+
+    fmt::print("{} of {} tests passed\n", run - failed, run);
+    return failed;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "DesktopController.h"
+#include "MemoryShellBackend.h"
+
+#include <fmt/core.h>
+
+#include <string>
+#include <vector>
+#include <memory>
+
+// Tests of DesktopController and its helpers, run against a MemoryShellBackend so they don't need
+// Explorer. Each test sits in a file named after the code it tests and registers itself with TEST(name).
+// Run Tests (Tests.exe on Windows) to run all of them, or pass the names of the ones to run. The exit
+// code is the number of tests which failed.
+
+using TestFunction = void(*)();
+
+// Adds a test to the list run by main().
+struct TestRegistration
+{
+    TestRegistration(const char* name, TestFunction function);
+};
+
+#define TEST(name) \
+    static void name(); \
+    static TestRegistration name##Registration(#name, name); \
+    static void name()
+
+// Records a failure of the running test if condition is false. The test carries on.
+#define CHECK(condition) \
+    checkCondition((condition), #condition, __FILE__, __LINE__)
+
+// Records a failure of the running test if expression doesn't throw an exception of type E.
+#define CHECK_THROWS(E, expression) \
+    do { \
+        bool thrown = false; \
+        try { expression; } catch (const E&) { thrown = true; } \
+        checkCondition(thrown, #expression " throws " #E, __FILE__, __LINE__); \
+    } while (0)
+
+void checkCondition(bool condition, const char* text, const char* file, int line);
+
+// Returns a simulated desktop with an icon for each name, in a column from the top left 100 pixels apart.
+// The icons' IDs in the backend are 1 to names.size(), in the same order.
+std::shared_ptr<MemoryShellBackend> makeDesktop(const std::vector<std::wstring>& names);
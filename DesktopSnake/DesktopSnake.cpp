@@ -54,12 +54,12 @@ DesktopSnake::DesktopSnake(double iconUpdatesPerSecond, double gameStepsPerSecon
     if (flags.autoArrange)
         throw runtime_error("Auto arrange should be disabled.");
 
-    vector<unique_ptr<DesktopIcon>> icons = dc.allIcons();
+    vector<DesktopIcon> icons = dc.allIconsValue();
     if (icons.empty())
         throw runtime_error("No icons on desktop.");
 
     int snakeHeadIndex = randomInt(0, static_cast<int>(icons.size() - 1));
-    fmt::print("Snake head: {}\n", wstringToOem(icons[snakeHeadIndex]->displayName()));
+    fmt::print("Snake head: {}\n", wstringToOem(icons[snakeHeadIndex].displayName()));
 
     // snake[0] shall be the head.
     snake.push_back(make_unique<GameObject>(std::move(icons[snakeHeadIndex]), MoveDirection::Static));
@@ -70,7 +70,7 @@ DesktopSnake::DesktopSnake(double iconUpdatesPerSecond, double gameStepsPerSecon
         if (i == snakeHeadIndex)
             continue;
 
-        fmt::print("Food: {}\n", wstringToOem(icons[i]->displayName()));
+        fmt::print("Food: {}\n", wstringToOem(icons[i].displayName()));
         food.push_back(make_unique<GameObject>(std::move(icons[i])));
     }
 
@@ -411,20 +411,39 @@ void DesktopSnake::addDesktopFoodIcon()
     wstring foodFileName = findUniqueDesktopFilename();
     wstring foodFilePath = desktopDirPath + L'\\' + foodFileName;
 
+    // Subscribed before the file is created so its notification isn't missed. Processing a change which may
+    // show the file patches the name index, so the next lookup re-enumerates the desktop once.
+    bool maybeShown = false;
+    int subscription = dc.subscribeChanges([&](const DesktopChange& change)
+        {
+            if (change.type == DesktopChangeType::Updated || change.name == foodFileName || change.newName == foodFileName)
+                maybeShown = true;
+        });
+
     ofstream file(foodFilePath.c_str());
     if (!file.is_open())
+    {
+        dc.unsubscribeChanges(subscription);
         throw runtime_error("Failed to create file " + wstringToOem(foodFileName));
+    }
     file.close();
 
-    // Refresh the desktop while we keep attempting to get a pointer.
+    // Refresh the desktop once, then look the file up again each time a change which may show it arrives.
+    // The name index remembers misses, so lookups in between wouldn't find it anyway.
     // Some kind of timeout might be appropriate here. 
-    unique_ptr<DesktopIcon> icon;
-    do
+    dc.refresh();
+    unique_ptr<DesktopIcon> icon = dc.iconByName(foodFileName);
+    while (!icon)
     {
-        dc.refresh();
-        icon = dc.iconByName(foodFileName);
-        std::this_thread::sleep_for(microseconds(2));
-    } while (!icon);
+        std::this_thread::sleep_for(milliseconds(1));
+        dc.processChanges();
+        if (maybeShown)
+        {
+            maybeShown = false;
+            icon = dc.iconByName(foodFileName);
+        }
+    }
+    dc.unsubscribeChanges(subscription);
 
     icon->reposition(
         Vec2<int>(
@@ -432,7 +451,7 @@ void DesktopSnake::addDesktopFoodIcon()
             randomInt(0, deskRes.y - iconSpacing.y)
         ));
 
-    food.push_back(make_unique<GameObject>(std::move(icon)));
+    food.push_back(make_unique<GameObject>(std::move(*icon)));
     filesAdded.push_back(foodFileName);
 
     fmt::print("New food added: '{}'\n", wstringToOem(foodFileName));
@@ -463,7 +482,7 @@ void DesktopSnake::handleCollision()
     auto snakeBodyIt = testObjCollision(*snake[0].get(), snake, 3);
     if (snakeBodyIt != snake.end())
     {
-        fmt::print("Game over (collision with {})\n", wstringToOem((*snakeBodyIt)->icon->displayName()));
+        fmt::print("Game over (collision with {})\n", wstringToOem((*snakeBodyIt)->icon.displayName()));
         isGameOver = true;
     }
 }
@@ -577,9 +596,10 @@ void DesktopSnake::updateIconPositions()
 
     for (auto& snakeObj : snake)
     {
-        icons.push_back(snakeObj->icon.get());
+        icons.push_back(&snakeObj->icon);
         points.push_back(Vec2<int>(snakeObj->position));
     }
 
-    dc.repositionIcons(icons, points);
+    // Stationary icons are skipped by applyLayout, so only icons which moved are sent to the Shell.
+    dc.applyLayout(icons, points);
 }
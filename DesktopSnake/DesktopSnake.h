@@ -1,5 +1,11 @@
 #pragma once
 
+// Avoid std::min/std::max collision with min/max macros defined by Windows.h inclusion.
+#define NOMINMAX
+
+// Keyboard input is read with GetAsyncKeyState.
+#include <Windows.h>
+
 #include "DesktopController.h"
 #include "GameObject.h"
 
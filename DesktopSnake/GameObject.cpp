@@ -2,14 +2,14 @@
 
 using namespace std;
 
-GameObject::GameObject(unique_ptr<DesktopIcon> deskIcon, MoveDirection dir, int boundaryCrossCnt)
+GameObject::GameObject(DesktopIcon deskIcon, MoveDirection dir, int boundaryCrossCnt)
     : directionVector(Vec2<double>(0.0, 0.0))
     , icon(std::move(deskIcon))
     , boundaryCrossCount(boundaryCrossCnt)
     , distanceTravelled(0.0)
 {
     setDirection(dir);
-    position = Vec2<double>(icon->position());
+    position = Vec2<double>(icon.position());
     lastChangeDirPosition = position;
 }
 
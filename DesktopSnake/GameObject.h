@@ -48,7 +48,7 @@ struct GameObjectMoveEvent
 struct GameObject
 {
     // Note: This constructor takes ownership of deskIcon.
-    GameObject(std::unique_ptr<DesktopIcon> deskIcon, MoveDirection dir = MoveDirection::Static, int boundaryCrossCnt = 0);
+    GameObject(DesktopIcon deskIcon, MoveDirection dir = MoveDirection::Static, int boundaryCrossCnt = 0);
 
     void step();
     void setDirection(MoveDirection dir);
@@ -56,7 +56,7 @@ struct GameObject
     Vec2<double> position;
     Vec2<double> directionVector;
     MoveDirection direction;
-    std::unique_ptr<DesktopIcon> icon;
+    DesktopIcon icon;
 
     // Queue of events for changing direction.
     std::deque<GameObjectMoveEvent> changeDirEventsQueue;